@@ -13,17 +13,21 @@ class GBCEmulator(ConanFile):
                 "build_type": ["Debug", "Release"]}
     options = {"shared": [True, False],
                 "lib_only": [True, False],
-                "qt": [True, False]}
+                "qt": [True, False],
+                "headless": [True, False]}
     generators = "cmake", "cmake_find_package"
     requires = (
-        "sdl/2.0.20",
         "spdlog/1.9.2",
         "libpng/1.6.39",
         "libzip/1.8.0",
         )
     exports_sources = "src/*", "CMakeLists.txt", "test_package/*", "!*.gb",\
       "!*.gitignore", "!*.log", "!*.sav", "!*.s"
-    default_options = "shared=False", "lib_only=False", "qt=False"
+    default_options = "shared=False", "lib_only=False", "qt=False", "headless=False"
+
+    def requirements(self):
+        if not self.options.headless:
+            self.requires("sdl/2.0.20")
 
     def build_requirements(self):
         if self.settings.os == "Android":
@@ -93,6 +97,8 @@ class GBCEmulator(ConanFile):
         if self.options.qt:
             cmake.definitions["BUILD_QT_GUI"] = True
 
+        cmake.definitions["GBC_HEADLESS"] = bool(self.options.headless)
+
         cmake.configure()
         cmake.build()
         #cmake.test()
@@ -106,6 +112,9 @@ class GBCEmulator(ConanFile):
         else:
             libDest += os.sep + str(self.settings.arch)
         self.copy("GBCEmulator*", src="bin", dst="bin", keep_path=False, excludes="GBCEmulatorTest*")
+        self.copy("gbc-batch*", src="bin", dst="bin", keep_path=False)
+        self.copy("gbc-bench*", src="bin", dst="bin", keep_path=False)
+        self.copy("gbc-server*", src="bin", dst="bin", keep_path=False)
         self.copy("*.dll", src="bin", dst="bin", excludes="g*.dll")
         self.copy("*.h", src="src", dst="include")
         self.copy("*.h", src="include", dst="include")
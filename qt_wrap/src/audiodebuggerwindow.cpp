@@ -6,6 +6,7 @@
 #include <QMutex>
 #include <QThread>
 #include <QApplication>
+#include <algorithm>
 
 #define SAMPLE_PRECISION 500
 #define IMAGE_HEIGHT 50
@@ -34,7 +35,7 @@ void AudioDebuggerWindow::showEvent(QShowEvent * e)
 
     if (apu)
     {
-        apu->sendSamplesToDebugger(false);
+        apu->sendSamplesToDebugger(true);
     }
     QWidget::showEvent(e);
 }
@@ -57,7 +58,7 @@ void AudioDebuggerWindow::initEmulatorConnections(std::shared_ptr<GBCEmulator> _
     if (emu)
     {
         apu = emu->get_APU();
-        apu->setSampleUpdateMethod(std::bind(&AudioDebuggerWindow::pushSample, this, std::placeholders::_1, std::placeholders::_2));
+        apu->setSampleUpdateMethod(std::bind(&AudioDebuggerWindow::pushSamples, this, std::placeholders::_1));
         apu->sendSamplesToDebugger(true);
     }
 
@@ -87,10 +88,11 @@ void AudioDebuggerWindow::initEmulatorConnections(std::shared_ptr<GBCEmulator> _
 
 void AudioDebuggerWindow::initWaveforms(const size_t & num_samples)
 {
-    waveforms[Channel::SQUARE1] = std::deque<float>(num_samples, 0.0f);
-    waveforms[Channel::SQUARE2] = std::deque<float>(num_samples, 0.0f);
-    waveforms[Channel::WAVE]    = std::deque<float>(num_samples, 0.0f);
-    waveforms[Channel::NOISE]   = std::deque<float>(num_samples, 0.0f);
+    for (size_t channel = 0; channel < waveforms.size(); channel++)
+    {
+        waveforms[channel] = std::vector<float>(num_samples, 0.0f);
+        waveformPositions[channel] = 0;
+    }
 
     waveformLabels[Channel::SQUARE1]    = ui->image_Square1;
     waveformLabels[Channel::SQUARE2]    = ui->image_Square2;
@@ -104,32 +106,43 @@ void AudioDebuggerWindow::initWaveforms(const size_t & num_samples)
     }
 }
 
-void AudioDebuggerWindow::pushSample(float sample, int channel)
+// Called by the APU once per block of samples, on the emulator's thread
+void AudioDebuggerWindow::pushSamples(const std::array<AudioSampleSpan, 4> & spans)
 {
     if (imageMutex.try_lock())
     {
-        // Get waveform deque
-        auto & waveform = waveforms[static_cast<Channel>(channel)];
+        for (size_t channel = 0; channel < waveforms.size(); channel++)
+        {
+            auto & waveform = waveforms[channel];
+            auto & position = waveformPositions[channel];
 
-        if (waveform.size() >= SAMPLE_PRECISION)
-        {   // Pop front of waveform off
-            waveform.pop_front();
-        }
+            // Only the newest samples fit in the waveform
+            const size_t num_samples = std::min(spans[channel].size, waveform.size());
+            const float * samples = spans[channel].data + (spans[channel].size - num_samples);
 
-        waveform.push_back(sample);
+            for (size_t i = 0; i < num_samples; i++)
+            {   // Overwrite the oldest sample
+                waveform[position] = samples[i];
+                position = (position + 1) % waveform.size();
+            }
+        }
 
         imageMutex.unlock();
     }
 }
 
+// x == 0 is the oldest sample
+float AudioDebuggerWindow::getWaveformSample(const Channel & channel, const int & x) const
+{
+    const auto & waveform = waveforms[channel];
+    return waveform[(waveformPositions[channel] + x) % waveform.size()];
+}
+
 void AudioDebuggerWindow::updateWaveformImage(const Channel & channel)
 {
     std::unique_lock<std::timed_mutex> lock(imageMutex, std::defer_lock);
     if (lock.try_lock_for(std::chrono::milliseconds(1)))
     {
-        // Get waveform deque
-        const auto & waveform = waveforms[channel];
-
         // Get waveform's QImage
         auto & image = waveformImages[channel];
 
@@ -140,7 +153,7 @@ void AudioDebuggerWindow::updateWaveformImage(const Channel & channel)
         int y = 0;
         for (int x = 0; x < SAMPLE_PRECISION; x++)
         {   // Normalize sample (get y coordinate)
-            y = ((waveform[x] + 1.0f) * IMAGE_HEIGHT) / 2.0;
+            y = ((getWaveformSample(channel, x) + 1.0f) * IMAGE_HEIGHT) / 2.0;
 
             // Get the current scanline
             uchar * scanline = image.scanLine(y);
@@ -161,9 +174,6 @@ void AudioDebuggerWindow::updateWaveformImage2(const Channel & channel)
     std::unique_lock<std::timed_mutex> lock(imageMutex, std::defer_lock);
     if (lock.try_lock_for(std::chrono::milliseconds(1)))
     {
-        // Get waveform deque
-        const auto & waveform = waveforms[channel];
-
         // Get waveform's QImage
         auto & image = waveformImages[channel];
         const int imageWidth = image.width();
@@ -182,14 +192,15 @@ void AudioDebuggerWindow::updateWaveformImage2(const Channel & channel)
                 }
 
                 // Get which scanline (y) the latest waveform is
+                const float sample = getWaveformSample(channel, x / 3);
                 int waveformY;
-                if (waveform[x / 3] == 0)
+                if (sample == 0)
                 {
                     waveformY = IMAGE_HEIGHT >> 1;  // divided by 2
                 }
                 else
                 {
-                    waveformY = waveform[x / 3] * IMAGE_HEIGHT;
+                    waveformY = sample * IMAGE_HEIGHT;
                 }
                 //const int waveformY = ((waveform[x / 3] + 1.0f) * IMAGE_HEIGHT) / 2.0;
                 //const int waveformY = waveform[x / 3] * IMAGE_HEIGHT;
@@ -8,7 +8,6 @@
 #include <QMutex>
 #include <src/emuview.h>
 #include <array>
-#include <deque>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
@@ -26,6 +25,7 @@ namespace Ui {
 }
 
 class APU;
+struct AudioSampleSpan;
 
 class AudioDebuggerWindow : public QMainWindow
 {
@@ -41,7 +41,8 @@ public:
 
 private:
     void initWaveforms(const size_t & num_samples);
-    void pushSample(float sample, int channel);
+    void pushSamples(const std::array<AudioSampleSpan, 4> & spans);
+    float getWaveformSample(const Channel & channel, const int & x) const;
     void updateWaveformImage(const Channel & channel);
     void updateWaveformImage2(const Channel & channel);
 
@@ -49,7 +50,8 @@ private:
     std::shared_ptr<GBCEmulator> emu;
     std::shared_ptr<APU> apu;
     std::vector<QImage> waveformImages;
-    std::unordered_map<Channel, std::deque<float>> waveforms;
+    std::array<std::vector<float>, 4> waveforms;    // Ring of the latest samples for each channel
+    std::array<size_t, 4> waveformPositions;        // Oldest sample in each ring
     std::unordered_map<Channel, QLabel*> waveformLabels;
     QTimer updateGUITimer;
     std::timed_mutex imageMutex;
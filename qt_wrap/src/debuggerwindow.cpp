@@ -280,12 +280,9 @@ void DebuggerWindow::updateRegisterLabels()
 
 void DebuggerWindow::updateHexWidget(bool getFullMemoryMap)
 {
-    std::vector<uint8_t> memoryMap;
-
     if (getFullMemoryMap)
     {   // Get full memory map
-        memoryMap = emu->get_memory_map();
-        hexWidget->setData(memoryMap);
+        hexWidget->setData(emu->get_memory_map());
     }
     else
     {   // Get partial memory map to save on resources
@@ -303,9 +300,10 @@ void DebuggerWindow::updateHexWidget(bool getFullMemoryMap)
             end_pos = 0xFFFF;
         }
 
-        memoryMap = emu->get_partial_memory_map(start_pos, end_pos);
-
-        hexWidget->updateData(memoryMap, start_pos, end_pos);
+        hexWidget->updateData(start_pos, end_pos, [&](uint8_t * bytes, size_t size)
+        {
+            emu->peek(start_pos, size, bytes);
+        });
     }
 }
 
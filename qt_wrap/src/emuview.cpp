@@ -94,6 +94,10 @@ void EmuView::setupEmulator(std::string filename, bool debugMode)
 
     logger->info("Creating GBCEmulator, giving file: {0}", filename.c_str());
     emu = std::make_shared<GBCEmulator>(filename, filename + ".log", "", debugMode);
+    savestate.clear();
+    emu->setRewindEnabled(true);    // Hold backspace to rewind
+    // A spare core draws the lines while the emulator's thread runs the CPU
+    emu->get_GPU()->setPipelinedRendering(std::thread::hardware_concurrency() > 1);
 
     if (xinput)
     {
@@ -249,6 +253,7 @@ void EmuView::updateScene()
     this->setSceneRect(frame_pixmap.rect());
 }
 
+// Save state is kept in memory and written to "<ROM name>.state"
 void EmuView::takeSaveState()
 {
     if (!emu)
@@ -257,26 +262,33 @@ void EmuView::takeSaveState()
     }
 
     // Stop the emulator first so we don't save it while running
-    emu->setStopRunning(true);
-    if (emu_savestate)
+    emu->stop();
+    if (thread && thread->joinable())
     {
-        emu_savestate.reset();
+        thread->join();
     }
 
-    // Create emulator savestate
-    emu_savestate = std::make_shared<GBCEmulator>(emu->getROMName(), emu->getROMName() + ".log");
-
-    // Copy current emulator into emulator savestate
-    *emu_savestate.get() = *emu.get();
+    emu->snapshot(savestate);
+    if (!writeSaveStateFile(emu->getROMName() + ".state", savestate))
+    {
+        logger->error("Failed to write save state to {}.state", emu->getROMName());
+    }
 
     // Start emulator again
     runEmulator();
 }
 
+// Loads the last save state taken, or "<ROM name>.state" if none have been taken since starting
 void EmuView::loadSaveState()
 {
-    if (!emu_savestate || !emu)
-    {   // Need a save state and an emulator to load a savestate
+    if (!emu)
+    {   // Need an emulator to load a savestate
+        return;
+    }
+
+    if (savestate.empty() &&
+        !readSaveStateFile(emu->getROMName() + ".state", savestate))
+    {
         return;
     }
 
@@ -287,8 +299,7 @@ void EmuView::loadSaveState()
         thread->join();
     }
 
-    // Load emulator savestate into emulator
-    *emu.get() = *emu_savestate.get();
+    emu->restore(savestate);
 
     // Start emulator again
     runEmulator();
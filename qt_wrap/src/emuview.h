@@ -11,6 +11,7 @@
 #include <QTimer>
 #include <memory>
 #include <thread>
+#include <vector>
 
 #include <spdlog/spdlog.h>
 
@@ -40,7 +41,7 @@ public:
     uint8_t scaleFrameToFit();
 
     std::shared_ptr<GBCEmulator> emu;
-    std::shared_ptr<GBCEmulator> emu_savestate;
+    std::vector<uint8_t> savestate;
     QGraphicsView  *emuView;
     std::unique_ptr<QImage> frame;
     QPixmap frame_pixmap;
@@ -48,6 +48,21 @@ void HexWidget::updateData(const std::vector<uint8_t> & partial_bytes, uint16_t
     data_updated = true;
 }
 
+void HexWidget::updateData(uint16_t start_pos, uint16_t end_pos, const std::function<void(uint8_t * bytes, size_t size)> & write)
+{
+    if (end_pos > data.size())
+    {
+        end_pos = data.size();
+    }
+    if (start_pos >= end_pos)
+    {
+        return;
+    }
+
+    write(reinterpret_cast<uint8_t *>(data.data()) + start_pos, end_pos - start_pos);
+    data_updated = true;
+}
+
 void HexWidget::setCursor(size_t pos)
 {
     cursor_pos = pos;
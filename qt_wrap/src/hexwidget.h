@@ -2,6 +2,7 @@
 #define HEX_WIDGET_H
 
 #include <QAbstractScrollArea>
+#include <functional>
 
 #define BYTES_PER_LINE 16
 #define PIXEL_SPACE 4
@@ -15,6 +16,8 @@ public:
     void clear();
     void setData(const std::vector<uint8_t> & bytes);
     void updateData(const std::vector<uint8_t> & partial_bytes, uint16_t start_pos, uint16_t end_pos);
+    // 'write' fills bytes start_pos - end_pos in place, no copy of them is made
+    void updateData(uint16_t start_pos, uint16_t end_pos, const std::function<void(uint8_t * bytes, size_t size)> & write);
     QSize getFullWidgetSize();
     void paintEvent(QPaintEvent *);
     void setCursor(size_t pc_pos);
@@ -154,6 +154,9 @@ void MainWindow::keyPressEvent(QKeyEvent * e)
     case Qt::Key_M:
         button = Joypad::START;
         break;
+    case Qt::Key_Backspace:
+        emuView->emu->setRewinding(true);
+        return;
     default:
         return;
     }
@@ -200,6 +203,9 @@ void MainWindow::keyReleaseEvent(QKeyEvent * e)
     case Qt::Key_M:
         button = Joypad::START;
         break;
+    case Qt::Key_Backspace:
+        emuView->emu->setRewinding(false);
+        return;
     default:
         return;
     }
@@ -2,19 +2,48 @@
 #include <GBCEmulator.h>
 #include <CPU.h>
 #include <Joypad.h>
-#include <SDL2/SDL.h>
-#include <SDL2/SDL_audio.h>
+#include <algorithm>
 #include <chrono>
 
-APU::APU(std::shared_ptr<spdlog::sinks::rotating_file_sink_st> logger_sink, std::shared_ptr<spdlog::logger> _logger)
+#ifndef GBC_HEADLESS
+#include <SDLSinks.h>
+#endif // GBC_HEADLESS
+
+// Stops the synthesis thread while in scope, so settings can be changed without racing it
+class APU::SynthesisPause
+{
+public:
+    SynthesisPause(APU & apu)
+        : apu(apu)
+        , was_running(apu.stopSynthesisThread())
+    {
+
+    }
+
+    ~SynthesisPause()
+    {
+        if (was_running)
+        {
+            apu.startSynthesisThread();
+        }
+    }
+
+private:
+    APU & apu;
+    bool was_running;
+};
+
+APU::APU(std::shared_ptr<spdlog::sinks::rotating_file_sink_mt> _logger_sink, std::shared_ptr<spdlog::logger> _logger,
+    const bool & open_audio_device)
     : SAMPLE_BUFFER_SIZE(1470)//1470
     , SAMPLE_OUTPUT_CHANNEL_SIZE(2)
     , SAMPLE_BUFFER_MEM_SIZE(SAMPLE_BUFFER_SIZE * SAMPLE_OUTPUT_CHANNEL_SIZE)
     , SAMPLE_BUFFER_MEM_SIZE_FLOAT(SAMPLE_BUFFER_MEM_SIZE * sizeof(float))
-    , sample_timer_val(CLOCK_SPEED / SAMPLE_RATE)
     , frame_sequence_timer_val(CLOCK_SPEED / 512)
+    , time_stretcher(SAMPLE_RATE)
 {
     logger = _logger;
+    logger_sink = _logger_sink;
     sound_channel_1 = std::make_unique<AudioSquare>(0xFF10, std::make_shared<spdlog::logger>("APU.Channel.1", logger_sink));
     sound_channel_2 = std::make_unique<AudioSquare>(0xFF15, std::make_shared<spdlog::logger>("APU.Channel.2", logger_sink));
     sound_channel_3 = std::make_unique<AudioWave>(0xFF1A,   std::make_shared<spdlog::logger>("APU.Channel.3", logger_sink));
@@ -28,6 +57,7 @@ APU::APU(std::shared_ptr<spdlog::sinks::rotating_file_sink_st> logger_sink, std:
     left_volume_use         = 0;
     right_volume_use        = 0;
     sample_buffer_counter   = 0;
+    debugger_sample_counter = 0;
     samplesPerFrame         = 0;
     left_out_enabled        = false;
     right_out_enabled       = false;
@@ -35,40 +65,66 @@ APU::APU(std::shared_ptr<spdlog::sinks::rotating_file_sink_st> logger_sink, std:
     send_samples_to_debugger = false;
     initialized             = false;
     curr_sample_buffer      = 0;
+    output_format           = AUDIO_F32SYS;
+    sample_rate             = SAMPLE_RATE;
+    target_buffer_ms        = AUDIO_TARGET_BUFFER_MS;
+    rate_adjustment         = 1.0;
+    dynamic_rate_control    = true;
+    emulation_speed         = 1.0;
+    statistics_only         = false;
+    silent_mode             = false;
+    running_ahead           = false;
+    run_ahead_cycle_count   = 0;
+    stop_synthesis_thread   = false;
+    cycle_count             = 0;
+    synthesis_cycle         = 0;
 
-    sample_timer                = sample_timer_val;
     frame_sequence_timer        = frame_sequence_timer_val;
+    pending_cycles              = 0;
 
-#ifdef WRITE_AUDIO_OUT
-    audioFileOut = std::make_unique<std::ofstream>("audioOut.pcm", std::ios::binary);
-#endif // WRITE_AUDIO_OUT
+    // Initialize double sample buffer
+    double_sample_buffer[0].resize(SAMPLE_BUFFER_SIZE);
+    double_sample_buffer[1].resize(SAMPLE_BUFFER_SIZE);
 
-    if (SDL_Init(SDL_INIT_AUDIO) < 0)
+    // Initialize channel output buffers, the audio output can change the sample rate
+    channel_buffers.resize(AUDIO_MIXER_NUM_CHANNELS, BlipBuffer(SAMPLE_BUFFER_SIZE * 2));
+    for (uint8_t i = 0; i < AUDIO_MIXER_NUM_CHANNELS; i++)
     {
-        logger->error("SDL_Init(SDL_INIT_AUDIO) failed: {0:s}", SDL_GetError());
+        channel_samples[i].resize(SAMPLE_BUFFER_SIZE);
+        debugger_samples[i].resize(SAMPLE_BUFFER_SIZE);
     }
+    channel_recording_samples.resize(SAMPLE_BUFFER_SIZE);
+    updateResampleRate();
 
-    initSDLAudio();
+#ifndef GBC_HEADLESS
+    if (open_audio_device)
+    {
+        audio_sink = std::make_shared<SDLAudioSink>(logger);
+        openAudioSink();
+    }
+#endif // GBC_HEADLESS
 
-    // Initialize double sample buffer
-    double_sample_buffer[0].resize(SAMPLE_BUFFER_SIZE);
-    double_sample_buffer[1].resize(SAMPLE_BUFFER_SIZE);
+    updateCyclesUntilBufferFull();
 }
 
 APU::~APU()
 {
-#ifdef WRITE_AUDIO_OUT
-    audioFileOut->close();
-#endif // WRITE_AUDIO_OUT
+    setPipelinedSynthesis(false);
+    stopRecording();
 
     if (initialized)
     {
-        SDL_CloseAudioDevice(audio_device_id);
+        audio_sink->close();
     }
 }
 
-APU& APU::operator=(const APU& rhs)
+APU& APU::operator=(const APU& source)
 {   // Copy APU from rhs
+    SynthesisPause pause(*this);
+
+    // A pipelined APU's up to date registers are in its shadow
+    const APU & rhs = source.register_shadow ? *source.register_shadow : source;
+
     frame_sequence_step         = rhs.frame_sequence_step;
     channel_control             = rhs.channel_control;
     selection_of_sound_output   = rhs.selection_of_sound_output;
@@ -83,72 +139,163 @@ APU& APU::operator=(const APU& rhs)
     right_out_enabled           = rhs.right_out_enabled;
     double_speed_mode           = rhs.double_speed_mode;
     send_samples_to_debugger    = rhs.send_samples_to_debugger;
-    audio_device_id             = rhs.audio_device_id;
 
     *sound_channel_1.get() = *rhs.sound_channel_1.get();
     *sound_channel_2.get() = *rhs.sound_channel_2.get();
     *sound_channel_3.get() = *rhs.sound_channel_3.get();
     *sound_channel_4.get() = *rhs.sound_channel_4.get();
 
-    sample_timer            = rhs.sample_timer;
     frame_sequence_timer    = rhs.frame_sequence_timer;
-    
+    pending_cycles          = rhs.pending_cycles;
+    cycles_until_buffer_full = rhs.cycles_until_buffer_full;
+
     double_sample_buffer[0] = rhs.double_sample_buffer[0];
     double_sample_buffer[1] = rhs.double_sample_buffer[1];
     sample_buffer_counter   = rhs.sample_buffer_counter;
+    channel_buffers         = rhs.channel_buffers;
+
+    if (register_shadow)
+    {
+        *register_shadow = rhs;
+        synthesis_cycle = cycle_count;
+    }
 
     return *this;
 }
 
-void APU::initSDLAudio()
+void APU::saveState(StateWriter & state)
+{
+    if (register_shadow)
+    {   // Shadow is ahead of the synthesis thread
+        register_shadow->saveState(state);
+        return;
+    }
+
+    runPendingCycles();
+
+    state.write(frame_sequence_step);
+    state.write(frame_sequence_timer);
+    state.write(channel_control);
+    state.write(selection_of_sound_output);
+    state.write(left_volume);
+    state.write(right_volume);
+    state.write(left_volume_use);
+    state.write(right_volume_use);
+    state.write(sound_on);
+    state.write(left_out_enabled);
+    state.write(right_out_enabled);
+    state.write(double_speed_mode);
+
+    sound_channel_1->saveState(state);
+    sound_channel_2->saveState(state);
+    sound_channel_3->saveState(state);
+    sound_channel_4->saveState(state);
+}
+
+// Only the emulated hardware is loaded, output settings, recordings and buffered audio stay
+void APU::loadState(StateReader & state)
 {
-    // SDL Configuration
-    desired_spec.callback = NULL;
-#ifndef USE_FLOAT
-    desired_spec.format  = AUDIO_U8;
-#else
-    desired_spec.format  = AUDIO_F32SYS;
-#endif
-    desired_spec.freq = SAMPLE_RATE;
-    desired_spec.channels = 2;
-    //desired_spec.samples = SAMPLE_BUFFER_SIZE * 2;
-    desired_spec.samples = SAMPLE_BUFFER_SIZE;
-    desired_spec.userdata = this;
+    if (running_ahead && register_shadow)
+    {   // Synthesis thread never saw the frames run ahead
+        register_shadow->loadState(state);
+        cycle_count = run_ahead_cycle_count;
+        return;
+    }
 
-    // Open SDL Audio instance
-    audio_device_id = SDL_OpenAudioDevice(NULL,
-        0,
-        &desired_spec,
-        &obtained_spec,
-        SDL_AUDIO_ALLOW_ANY_CHANGE);
+    SynthesisPause pause(*this);
 
-    if (audio_device_id == 0)
-    {
-        logger->error("Failed to open audio: {0:s}", SDL_GetError());
+    if (register_shadow)
+    {   // Shadow reads the same state
+        StateReader shadow_state = state;
+        register_shadow->loadState(shadow_state);
+        synthesis_cycle = cycle_count;
+    }
+
+    state.read(frame_sequence_step);
+    state.read(frame_sequence_timer);
+    state.read(channel_control);
+    state.read(selection_of_sound_output);
+    state.read(left_volume);
+    state.read(right_volume);
+    state.read(left_volume_use);
+    state.read(right_volume_use);
+    state.read(sound_on);
+    state.read(left_out_enabled);
+    state.read(right_out_enabled);
+    state.read(double_speed_mode);
+
+    sound_channel_1->loadState(state);
+    sound_channel_2->loadState(state);
+    sound_channel_3->loadState(state);
+    sound_channel_4->loadState(state);
+    pending_cycles = 0;
+
+    if (running_ahead)
+    {   // Output carries on from before running ahead
         return;
     }
-    
-    if (obtained_spec.format != desired_spec.format)
+
+    // Samples not written out yet are dropped, the channels restart from silence
+    for (BlipBuffer & channel_buffer : channel_buffers)
     {
-        logger->error("Failed to get audio format requested, from: {} to: {}",
-            desired_spec.samples,
-            obtained_spec.samples);
+        channel_buffer.clear();
     }
+    sound_channel_1->clearOutput();
+    sound_channel_2->clearOutput();
+    sound_channel_3->clearOutput();
+    sound_channel_4->clearOutput();
+    clearCurrentAudioBuffer();
+    debugger_sample_counter = 0;
+    updateCyclesUntilBufferFull();
+}
 
-    // Get 'silence' value/byte
-    sdl_silence_val = obtained_spec.silence;
+// Opens the audio output at the current rate, format and buffering
+void APU::openAudioSink()
+{
+    initialized = false;
+    if (!audio_sink)
+    {
+        return;
+    }
 
-    // Start playing audio
-    SDL_PauseAudioDevice(audio_device_id, 0);
+    const int output_rate = audio_sink->open(sample_rate, output_format, target_buffer_ms);
+    if (output_rate == 0)
+    {
+        return;
+    }
 
-    // Clear current audio queue
-    SDL_ClearQueuedAudio(audio_device_id);
+    // Resample to the output's own rate, starting from it
+    sample_rate = output_rate;
+    rate_adjustment = 1.0;
+    updateResampleRate();
+    time_stretcher.setSampleRate(sample_rate);
 
     initialized = true;
+
+    // Nothing to play in silent mode
+    audio_sink->setPaused(silent_mode);
 }
 
 void APU::setByte(const uint16_t & addr, const uint8_t & val)
 {
+    if (register_shadow)
+    {   // Synthesis thread replays the write at the same cycle
+        register_shadow->setByte(addr, val);
+        if (!running_ahead)
+        {
+            pushSynthesisEvent(addr, val);
+        }
+        return;
+    }
+
+    writeRegister(addr, val);
+}
+
+void APU::writeRegister(const uint16_t & addr, const uint8_t & val)
+{
+    // Registers are about to change, run the APU up to now with the old values
+    runPendingCycles();
+
     if (sound_on == false &&
         addr < 0xFF26 &&
         addr != 0xFF20) // NR41 can still be written to when off
@@ -206,7 +353,7 @@ void APU::setByte(const uint16_t & addr, const uint8_t & val)
             // Write 0s to APU registers NR10-NR51 (0xFF10-0xFF25)
             for (uint16_t i = 0xFF10; i < 0xFF26; i++)
             {
-                setByte(i, 0);
+                writeRegister(i, 0);
             }
             sound_channel_1->is_enabled = false;
             sound_channel_2->is_enabled = false;
@@ -224,8 +371,33 @@ void APU::setByte(const uint16_t & addr, const uint8_t & val)
     }
 }
 
-uint8_t APU::readByte(const uint16_t & addr) const
+uint8_t APU::readByte(const uint16_t & addr)
+{
+    if (register_shadow)
+    {
+        return register_shadow->readByte(addr);
+    }
+
+    // Length counters and wave position must be up to date
+    runPendingCycles();
+
+    const uint8_t ret = peekByte(addr);
+
+    logger->debug("Reading addr: 0x{0:x}, val: 0x{1:x}",
+        addr,
+        ret);
+
+    return ret;
+}
+
+// Registers as of the last catch up, without running any pending cycles
+uint8_t APU::peekByte(const uint16_t & addr) const
 {
+    if (register_shadow)
+    {
+        return register_shadow->peekByte(addr);
+    }
+
     uint8_t ret = 0xFF;
 
     if (addr >= 0xFF10 && addr <= 0xFF14)
@@ -267,10 +439,6 @@ uint8_t APU::readByte(const uint16_t & addr) const
          break;
     }
 
-    logger->debug("Reading addr: 0x{0:x}, val: 0x{1:x}",
-        addr,
-        ret);
-
     return ret;
 }
 
@@ -278,12 +446,9 @@ void APU::reset()
 {
     frame_sequence_timer    = frame_sequence_timer_val;
     frame_sequence_step     = 0;
-    sample_timer            = sample_timer_val;
-    sample_buffer_counter   = 0;
-    samplesPerFrame         = 0;
 
     // Reset Wave RAM
-    for (uint16_t i = 0xFF30; i < 0xFF3F; i++)
+    for (uint16_t i = 0xFF30; i <= 0xFF3F; i++)
     {
         sound_channel_3->setByte(i, 0);
     }
@@ -293,134 +458,243 @@ void APU::reset()
     sound_channel_3->reset();
     sound_channel_4->reset();
 
-    SDL_ClearQueuedAudio(audio_device_id);
+    if (running_ahead)
+    {   // Audio made before running ahead still gets played
+        return;
+    }
+
+    sample_buffer_counter   = 0;
+    samplesPerFrame         = 0;
+
+    if (initialized)
+    {   // Drop buffered audio
+        audio_sink->clear();
+    }
 }
 
+// Only counts the cycles, the APU is run lazily by catchUp() when
+// registers are accessed or the sample buffer would fill up
 void APU::run(const uint8_t & cpuTickDiff)
 {
-    uint8_t diff = cpuTickDiff;
+    if (register_shadow)
+    {
+        register_shadow->run(cpuTickDiff);
+        cycle_count += cpuTickDiff;
+        return;
+    }
+
+    pending_cycles += cpuTickDiff;
+
+    if (pending_cycles >= cycles_until_buffer_full)
+    {
+        runPendingCycles();
+    }
+}
+
+void APU::catchUp()
+{
+    if (register_shadow)
+    {   // Synthesis thread catches up on its own
+        register_shadow->catchUp();
+        return;
+    }
+
+    runPendingCycles();
+}
+
+// Runs the APU for all pending cycles.
+// Cycles are run in blocks between frame sequencer events, nothing else can
+// change the channels within a block. The channels' output is then resampled
+// and mixed into the sample buffer
+void APU::runPendingCycles()
+{
+    uint32_t cycles = pending_cycles;
+    pending_cycles = 0;
+
+    uint32_t time = 0;
+    while (cycles > 0)
+    {
+        const uint32_t cycles_to_frame_sequencer = std::max<uint32_t>(frame_sequence_timer, 1);
+        const uint32_t block = std::min(cycles, cycles_to_frame_sequencer);
+
+        if (block == cycles_to_frame_sequencer)
+        {   // Frame sequencer ticks before the channels on its last cycle
+            advanceChannels(block - 1, time);
+            tickFrameSequencer();
+            advanceChannels(1, time + block - 1);
+        }
+        else
+        {
+            advanceChannels(block, time);
+            frame_sequence_timer = cycles_to_frame_sequencer - block;
+        }
+
+        time += block;
+        cycles -= block;
+    }
+
+    if (!silent_mode && !running_ahead)
+    {
+        mixOutput(time);
+    }
+    updateCyclesUntilBufferFull();
+}
+
+void APU::tickFrameSequencer()
+{
+    logger->trace("frame_sequnce_timer == 0, frame_sequence_step: 0x{0:x}",
+        frame_sequence_step);
+    switch (frame_sequence_step)
+    {
+    case 0:
+    case 4:
+        sound_channel_1->tickLengthCounter();
+        sound_channel_2->tickLengthCounter();
+        sound_channel_3->tickLengthCounter();
+        sound_channel_4->tickLengthCounter();
+        break;
+    case 2:
+    case 6:
+        sound_channel_1->tickLengthCounter();
+        sound_channel_2->tickLengthCounter();
+        sound_channel_3->tickLengthCounter();
+        sound_channel_4->tickLengthCounter();
+        sound_channel_1->tickSweep();
+        break;
+    case 7:
+        sound_channel_1->tickVolumeEnvelope();
+        sound_channel_2->tickVolumeEnvelope();
+        sound_channel_4->tickVolumeEnvelope();
+        break;
+    }
+
+    frame_sequence_step++;
+    frame_sequence_step &= 7; // Sequence can only be 0..7
+
+    // Reset frame_sequence_timer
+    frame_sequence_timer = frame_sequence_timer_val;
+}
+
+void APU::advanceChannels(const uint32_t & cycles, const uint32_t & time)
+{
+    if (silent_mode || statistics_only || running_ahead)
+    {   // Nothing is played, only run what the CPU can see
+        sound_channel_1->advance(cycles, nullptr, time);
+        sound_channel_2->advance(cycles, nullptr, time);
+        sound_channel_3->advance(cycles, nullptr, time);
+        sound_channel_4->advance(cycles, nullptr, time);
+        return;
+    }
+
+    sound_channel_1->advance(cycles, &channel_buffers[0], time);
+    sound_channel_2->advance(cycles, &channel_buffers[1], time);
+    sound_channel_3->advance(cycles, &channel_buffers[2], time);
+    sound_channel_4->advance(cycles, &channel_buffers[3], time);
+}
+
+// Resamples the channels' output up to 'time' and mixes it into the sample buffer.
+// NR50/NR51 can't change during a catch up, so one set of gains covers every sample
+void APU::mixOutput(const uint32_t & time)
+{
+    for (BlipBuffer & channel_buffer : channel_buffers)
+    {
+        channel_buffer.endFrame(time);
+    }
+
+    // Every channel buffer has the same number of samples
+    const size_t num_samples = std::min(channel_buffers[0].samplesAvailable(),
+        static_cast<size_t>(SAMPLE_BUFFER_SIZE - sample_buffer_counter));
 
-    while (diff > 0)
+    if (num_samples == 0)
     {
-        diff--;
+        return;
+    }
 
-        // Tick frame sequencer
-        if (frame_sequence_timer > 0)
+    if (statistics_only)
+    {   // Only count the samples
+        for (BlipBuffer & channel_buffer : channel_buffers)
         {
-            frame_sequence_timer--;
-            //logger->debug("frame_sequence_timer--: 0x{0:x}", frame_sequence_timer);
+            channel_buffer.readSamples(channel_samples[0].data(), num_samples);
         }
+        samplesPerFrame += static_cast<uint16_t>(num_samples);
+        return;
+    }
+
+    std::array<const float *, AUDIO_MIXER_NUM_CHANNELS> channels;
+    std::array<float, AUDIO_MIXER_NUM_CHANNELS> left_gains;
+    std::array<float, AUDIO_MIXER_NUM_CHANNELS> right_gains;
+    const float left_gain = (static_cast<float>(left_volume_use) / SDL_MIX_MAXVOLUME) / CHANNEL_MAX_VOLUME_MIX;
+    const float right_gain = (static_cast<float>(right_volume_use) / SDL_MIX_MAXVOLUME) / CHANNEL_MAX_VOLUME_MIX;
 
-        if (frame_sequence_timer == 0)
+    for (uint8_t i = 0; i < AUDIO_MIXER_NUM_CHANNELS; i++)
+    {
+        channel_buffers[i].readSamples(channel_samples[i].data(), num_samples);
+        channels[i] = channel_samples[i].data();
+
+        if (channel_recordings[i])
         {
-            logger->trace("frame_sequnce_timer == 0, frame_sequence_step: 0x{0:x}",
-                frame_sequence_step);
-            switch (frame_sequence_step)
+            for (size_t s = 0; s < num_samples; s++)
             {
-            case 0:
-            case 4:
-                sound_channel_1->tickLengthCounter();
-                sound_channel_2->tickLengthCounter();
-                sound_channel_3->tickLengthCounter();
-                sound_channel_4->tickLengthCounter();
-                break;
-            case 2:
-            case 6:
-                sound_channel_1->tickLengthCounter();
-                sound_channel_2->tickLengthCounter();
-                sound_channel_3->tickLengthCounter();
-                sound_channel_4->tickLengthCounter();
-                sound_channel_1->tickSweep();
-                break;
-            case 7:
-                sound_channel_1->tickVolumeEnvelope();
-                sound_channel_2->tickVolumeEnvelope();
-                sound_channel_4->tickVolumeEnvelope();
-                break;
+                channel_recording_samples[s] = channel_samples[i][s] / CHANNEL_MAX_VOLUME;
             }
-
-            frame_sequence_step++;
-            frame_sequence_step &= 7; // Sequence can only be 0..7
-
-            // Reset frame_sequence_timer
-            frame_sequence_timer = frame_sequence_timer_val;
+            channel_recordings[i]->write(channel_recording_samples.data(), num_samples);
         }
 
-        // Tick sound channels
-        sound_channel_1->tick();
-        sound_channel_2->tick();
-        sound_channel_3->tick();
-        sound_channel_4->tick();
+        // Audio is disabled, samples are silent
+        left_gains[i] = (sound_on && isSoundOutLeft(i + 1)) ? left_gain : 0.0f;
+        right_gains[i] = (sound_on && isSoundOutRight(i + 1)) ? right_gain : 0.0f;
+    }
+
+    // Add samples to sample buffer
+    std::vector<Sample>& sample_buffer = double_sample_buffer[curr_sample_buffer];
+    AudioMixer::mix(channels, left_gains, right_gains,
+        reinterpret_cast<float *>(&sample_buffer[sample_buffer_counter]),
+        num_samples);
 
-        // Tick sample_timer
-        if (sample_timer > 0)
+    if (send_samples_to_debugger && sound_on)
+    {   // Collect the channels' samples, they're sent a block at a time by sendDebuggerSamples()
+        if (debugger_sample_counter + num_samples > debugger_samples[0].size())
         {
-            sample_timer--;
+            sendDebuggerSamples();
         }
 
-        if (sample_timer == 0)
-        {   // Get samples, send sample to audio out buffer
-            Sample sample;
-
-            if (sound_on)
-            {   // Audio is enabled
-                // Get samples
-#ifndef USE_FLOAT
-                uint8_t channel_1_sample = sound_channel_1->output_volume;
-                uint8_t channel_2_sample = sound_channel_2->output_volume;
-                uint8_t channel_3_sample = sound_channel_3->output_volume;
-                uint8_t channel_4_sample = sound_channel_4->output_volume;
-#else
-                float channel_1_sample = (sound_channel_1->output_volume) ? ((float)sound_channel_1->output_volume) / 60.0f : 0.0f;   // 30.0f = 0x0F * 2.0f; 0x0F = MAX_CHANNEL_VOL 
-                float channel_2_sample = (sound_channel_2->output_volume) ? ((float)sound_channel_2->output_volume) / 60.0f : 0.0f;   // 30.0f = 0x0F * 2.0f; 0x0F = MAX_CHANNEL_VOL 
-                float channel_3_sample = (sound_channel_3->output_volume) ? ((float)sound_channel_3->output_volume) / 60.0f : 0.0f;   // 30.0f = 0x0F * 2.0f; 0x0F = MAX_CHANNEL_VOL 
-                float channel_4_sample = (sound_channel_4->output_volume) ? ((float)sound_channel_4->output_volume) / 60.0f : 0.0f;   // 30.0f = 0x0F * 2.0f; 0x0F = MAX_CHANNEL_VOL 
-#endif
-
-                // Apply samples to left and/or right out channels
-#ifndef USE_FLOAT
-                sendChannelOutputToSample(sample, channel_1_sample, 1);
-                sendChannelOutputToSample(sample, channel_2_sample, 2);
-                sendChannelOutputToSample(sample, channel_3_sample, 3);
-                sendChannelOutputToSample(sample, channel_4_sample, 4);
-#else
-                sendChannelOutputToSampleFloat(sample, channel_1_sample, 1);
-                sendChannelOutputToSampleFloat(sample, channel_2_sample, 2);
-                sendChannelOutputToSampleFloat(sample, channel_3_sample, 3);
-                sendChannelOutputToSampleFloat(sample, channel_4_sample, 4);
-
-                if (send_samples_to_debugger)
-                {
-                    sendSampleUpdate(channel_1_sample, 0);
-                    sendSampleUpdate(channel_2_sample, 1);
-                    sendSampleUpdate(channel_3_sample, 2);
-                    sendSampleUpdate(channel_4_sample, 3);
-                }
-#endif
-            } // end if(sound_on)
-
-            // Add current sample to sample buffer
-            std::vector<Sample>& sample_buffer = double_sample_buffer[curr_sample_buffer];
-            sample_buffer[sample_buffer_counter++] = sample;
-            samplesPerFrame++;
-
-            // Check if sample buffer is full
-            if (sample_buffer_counter >= SAMPLE_BUFFER_SIZE)
-            {   // Force write out audio samples
-                writeSamplesOutAsync(audio_device_id);
+        for (uint8_t i = 0; i < AUDIO_MIXER_NUM_CHANNELS; i++)
+        {
+            float * debugger_sample = &debugger_samples[i][debugger_sample_counter];
+            for (size_t s = 0; s < num_samples; s++)
+            {
+                debugger_sample[s] = channel_samples[i][s] / CHANNEL_MAX_VOLUME_MIX;
             }
+        }
+        debugger_sample_counter += static_cast<uint16_t>(num_samples);
+    }
 
-            //} // end if(sound_on)
+    sample_buffer_counter += static_cast<uint16_t>(num_samples);
+    samplesPerFrame += static_cast<uint16_t>(num_samples);
 
-            // Reset sample_timer
-            sample_timer = sample_timer_val;
+    // Check if sample buffer is full
+    if (sample_buffer_counter + SAMPLE_BUFFER_MARGIN >= SAMPLE_BUFFER_SIZE)
+    {   // Force write out audio samples
+        flushSampleBuffer();
+    }
+}
+
+void APU::updateCyclesUntilBufferFull()
+{
+    if (silent_mode || running_ahead)
+    {   // No samples are made, only catch up often enough that pending_cycles can't overflow
+        cycles_until_buffer_full = CLOCK_SPEED;
+        return;
+    }
 
-        } // end if(sample_timer)
+    const size_t free_samples = SAMPLE_BUFFER_SIZE - sample_buffer_counter;
 
-    } // end while(diff > 0)
+    cycles_until_buffer_full = (free_samples > SAMPLE_BUFFER_MARGIN) ?
+        channel_buffers[0].clocksNeeded(free_samples - SAMPLE_BUFFER_MARGIN) :
+        0;
 }
 
-void APU::writeSamplesOut(const uint32_t& audio_device, const std::vector<Sample>& samples, const uint16_t num_samples)
+void APU::writeSamplesOut(const std::vector<Sample>& samples, const uint16_t num_samples)
 {
     if (!initialized)
     {
@@ -429,42 +703,69 @@ void APU::writeSamplesOut(const uint32_t& audio_device, const std::vector<Sample
 
     logger->trace("Pushing sample of size: {}", samples.size());
 
-    // Push sample_buffer to SDL
-#ifndef USE_FLOAT
-    prev_sample_size = num_samples * 2 * sizeof(uint8_t);
-    const int ret = SDL_QueueAudio(audio_device_id, reinterpret_cast<const uint8_t*>(samples.data()), prev_sample_size);
-#else
-    prev_sample_size = num_samples * 2 * sizeof(float);
-    const int ret = SDL_QueueAudio(audio_device_id, reinterpret_cast<const float*>(samples.data()), prev_sample_size);
-#endif // USE_FLOAT
+    // Stretch audio back to real time length when not running at 1x
+    const float * float_data = reinterpret_cast<const float*>(samples.data());
+    size_t num_output_samples = num_samples;
+    if (emulation_speed != 1.0)
+    {
+        stretched_sample_buffer.clear();
+        time_stretcher.process(float_data, num_samples, stretched_sample_buffer);
+
+        float_data = stretched_sample_buffer.data();
+        num_output_samples = stretched_sample_buffer.size() / 2;
+    }
+
+    // Push sample_buffer to the audio output
+    const void * data = float_data;
+    if (output_format == AUDIO_S16SYS)
+    {
+        s16_sample_buffer.resize(num_output_samples * 2);
+        AudioMixer::convertToS16(float_data, s16_sample_buffer.data(), num_output_samples * 2);
 
-    rolling_avg_sample_size.Push(prev_sample_size);
+        data = s16_sample_buffer.data();
+    }
+    const size_t num_bytes = num_output_samples * getOutputSampleSize();
 
-    if (ret != 0)
+    if (audio_sink->write(reinterpret_cast<const uint8_t*>(data), num_bytes) != num_bytes)
     {
-        logger->error("SDL_QueueAudio returned {}", ret);
+        logger->debug("Audio output full, dropped samples");
     }
+}
 
-#ifdef WRITE_AUDIO_OUT
-    audioFileOut->write(reinterpret_cast<const char*>(samples.data()), prev_sample_size);
-#endif // WRITE_AUDIO_OUT
+void APU::writeSamplesOutAsync()
+{
+    if (register_shadow)
+    {   // Samples are written out by the synthesis thread when it gets here
+        pushSynthesisEvent(APU_EVENT_WRITE_SAMPLES_OUT, 0);
+        synthesis_cv.notify_one();
+        return;
+    }
+
+    flushSampleBuffer();
 }
 
-void APU::writeSamplesOutAsync(const uint32_t& audio_device)
+void APU::flushSampleBuffer()
 {
+    runPendingCycles();
+    sendDebuggerSamples();
+
     const std::vector<Sample>& sampleBuffer =
         double_sample_buffer[curr_sample_buffer];
 
     const uint16_t sampleBufferSize = sample_buffer_counter;
 
+    if (recording)
+    {   // Recorded before stretching, the recording follows emulated time
+        recording->write(reinterpret_cast<const float*>(sampleBuffer.data()), sampleBufferSize * SAMPLE_OUTPUT_CHANNEL_SIZE);
+    }
+
     // Change active sample buffer
     curr_sample_buffer = !curr_sample_buffer;
 
     // Clear active sample_buffer for immediate use
     clearCurrentAudioBuffer();
 
-    writeSamplesOut(audio_device, sampleBuffer,
-      sampleBufferSize);
+    writeSamplesOut(sampleBuffer, sampleBufferSize);
 }
 
 bool APU::isSoundOutLeft(uint8_t sound_number) const
@@ -491,64 +792,6 @@ bool APU::isSoundOutRight(uint8_t sound_number) const
     }
 }
 
-#ifndef USE_FLOAT
-void APU::sendChannelOutputToSample(Sample & sample, const uint8_t & audio, const uint8_t & channelNum) const
-{
-    if (isSoundOutLeft(channelNum))
-    {
-        //sample.left += audio;
-       SDL_MixAudioFormat(&sample.left, &audio, AUDIO_U8, 1, left_volume_use);
-        //sample.left = mixAudio(sample.left, audio);
-    }
-
-    if (isSoundOutRight(channelNum))
-    {
-        //sample.right += audio;
-        SDL_MixAudioFormat(&sample.right, &audio, AUDIO_U8, 1, right_volume_use);
-        //sample.right = mixAudio(sample.right, audio);
-    }
-}
-#else
-void APU::sendChannelOutputToSampleFloat(Sample & sample, const float & audio, const uint8_t & channelNum) const
-{
-    if (isSoundOutLeft(channelNum))
-    {
-        SDL_MixAudioFormat((uint8_t *)&sample.left, 
-            (uint8_t *)&audio,
-            AUDIO_F32SYS,
-            sizeof(float),
-            left_volume_use);
-    }
-
-    if (isSoundOutRight(channelNum))
-    {
-        SDL_MixAudioFormat((uint8_t *)&sample.right,
-            (uint8_t *)&audio,
-            AUDIO_F32SYS,
-            sizeof(float),
-            right_volume_use);
-    }
-}
-#endif
-
-// http://www.vttoth.com/CMS/index.php/technical-notes/68
-uint8_t APU::mixAudio(const uint8_t & audio1, const uint8_t & audio2)
-{
-    uint8_t ret = 0;
-
-    if (audio1 < 128 && audio2 < 128)
-    {
-        ret = (static_cast<uint16_t>(audio1) * static_cast<uint16_t>(audio2)) / 128;
-    }
-    else
-    {
-        ret = (2 * (static_cast<uint16_t>(audio1) + static_cast<uint16_t>(audio2))) -
-            ((static_cast<uint16_t>(audio1) * static_cast<uint16_t>(audio2)) / 128) -
-            256;
-    }
-    return ret;
-}
-
 void APU::logSamples()
 {
     std::string stringToLog = "";
@@ -563,9 +806,22 @@ void APU::logSamples()
 
 void APU::initCGB()
 {
+    if (register_shadow)
+    {
+        register_shadow->initCGB();
+        pushSynthesisEvent(APU_EVENT_INIT_CGB, 0);
+        return;
+    }
+
+    enableDoubleSpeed();
+}
+
+void APU::enableDoubleSpeed()
+{
+    runPendingCycles();
+
     double_speed_mode = true;
 
-    sample_timer                = sample_timer_val;
     frame_sequence_timer        = frame_sequence_timer_val;
 
     // Clear sample_buffer
@@ -596,65 +852,543 @@ void APU::clearCurrentAudioBuffer()
 
 void APU::setChannelLogLevel(spdlog::level::level_enum level)
 {
+    if (register_shadow)
+    {   // Only the shadow's channels log when synthesis is pipelined
+        register_shadow->setChannelLogLevel(level);
+        return;
+    }
+
     sound_channel_1->logger->set_level(level);
     sound_channel_2->logger->set_level(level);
     sound_channel_3->logger->set_level(level);
     sound_channel_4->logger->set_level(level);
 }
 
+// Waits until the audio output has played the buffer down to the target buffering.
+// Outputs that aren't played in real time are never waited on
 void APU::sleepUntilBufferIsEmpty(const std::chrono::duration<double>& frame_start_time)
 {
-    int microElapsedInt = 0;
-
-    // Drain audio buffer (?)
-    uint32_t queuedAudioSize = SDL_GetQueuedAudioSize(audio_device_id);
-    const uint32_t queuedAudioSizeOrig = queuedAudioSize;
-    const uint32_t singleFrameAudioBufferSize = samplesPerFrame * 2 * sizeof(float);
-    const size_t rollingAvgSampleSize = rolling_avg_sample_size.GetRollingAvg() * 2 * sizeof(float);
-
-#ifndef USE_FLOAT
-    while (queuedAudioSize > SAMPLE_BUFFER_MEM_SIZE)
-#else
-    //while (queuedAudioSize >= SAMPLE_BUFFER_MEM_SIZE_FLOAT)
-    //while (queuedAudioSize >= singleFrameAudioBufferSize)
-    //while (queuedAudioSize >= obtained_spec.size)
-    while (queuedAudioSize > rollingAvgSampleSize)
-#endif
-    {
-        logger->trace("queuedAudioSize: {}, rollingAvgSampleSize: {}",
-            queuedAudioSize,
-            rollingAvgSampleSize);
-
-        // Check if time spent sleeping is greater than 1 frame time (16.667 ms)
-        //const auto currTime = std::chrono::system_clock::now().time_since_epoch();
-        //const auto microsecondsElapsed = std::chrono::duration_cast<std::chrono::microseconds>(currTime - frame_start_time);
-        //microElapsedInt = microsecondsElapsed.count();
-        //if (microElapsedInt >= MICROSEC_PER_FRAME - 100)
-        //{
-        //    break;
-        //}
-
-        // Sleep for 1 millisecond
-        SDL_Delay(1);   // std::this_thread::sleep_for() causes audio delay on Linux
-        //std::this_thread::sleep_for(std::chrono::microseconds(200));
-        queuedAudioSize = SDL_GetQueuedAudioSize(audio_device_id);
-    }
-
-    logger->trace("Slept for {} milliseconds, buffer size diff: {}, buffer size start: {}, buffer size end: {}",
-        microElapsedInt / 1000.0,
-        queuedAudioSizeOrig - queuedAudioSize,
-        queuedAudioSizeOrig,
-        queuedAudioSize);
+    if (!initialized ||
+        !audio_sink->isRealTime())
+    {
+        samplesPerFrame = 0;
+        return;
+    }
+
+    const size_t target_bytes = ((static_cast<size_t>(sample_rate) * target_buffer_ms) / 1000) * getOutputSampleSize();
+    const size_t buffered_bytes_orig = audio_sink->getBufferedBytes();
+    const auto wait_start_time = std::chrono::steady_clock::now();
+
+    audio_sink->waitForBufferedBytes(target_bytes, std::chrono::milliseconds(AUDIO_MAX_WAIT_MS));
+
+    const auto micro_elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - wait_start_time);
+    logger->trace("Slept for {} milliseconds, buffer size start: {}, buffer size end: {}, target: {}",
+        micro_elapsed.count() / 1000.0,
+        buffered_bytes_orig,
+        audio_sink->getBufferedBytes(),
+        target_bytes);
 
     samplesPerFrame = 0;
 }
 
-void APU::setSampleUpdateMethod(std::function<void(float, int)> function)
+void APU::setSampleUpdateMethod(std::function<void(const AudioChannelSpans &)> function)
 {
+    SynthesisPause pause(*this);
     sendSampleUpdate = function;
 }
 
 void APU::sendSamplesToDebugger(bool b)
 {
+    SynthesisPause pause(*this);
     send_samples_to_debugger = b;
-}
\ No newline at end of file
+    debugger_sample_counter = 0;
+}
+
+// Hands the debugger every channel's samples since the last write out in one call
+void APU::sendDebuggerSamples()
+{
+    if (debugger_sample_counter == 0)
+    {
+        return;
+    }
+
+    if (send_samples_to_debugger && sendSampleUpdate)
+    {
+        AudioChannelSpans spans;
+        for (uint8_t i = 0; i < AUDIO_MIXER_NUM_CHANNELS; i++)
+        {
+            spans[i].data = debugger_samples[i].data();
+            spans[i].size = debugger_sample_counter;
+        }
+        sendSampleUpdate(spans);
+    }
+
+    debugger_sample_counter = 0;
+}
+
+void APU::setOutputSpec(const int & rate, const SDL_AudioFormat & format)
+{
+    if (format != AUDIO_F32SYS &&
+        format != AUDIO_S16SYS)
+    {
+        logger->error("Unsupported audio output format: 0x{0:x}", format);
+        return;
+    }
+
+    SynthesisPause pause(*this);
+
+    // Mix everything made at the old rate first
+    flushSampleBuffer();
+
+    sample_rate = rate;
+    output_format = format;
+    updateResampleRate();
+    time_stretcher.setSampleRate(sample_rate);
+
+    reopenAudioSink();
+
+    updateCyclesUntilBufferFull();
+}
+
+int APU::getSampleRate() const
+{
+    return sample_rate;
+}
+
+SDL_AudioFormat APU::getOutputFormat() const
+{
+    return output_format;
+}
+
+void APU::setTargetBufferMs(const uint32_t & ms)
+{
+    SynthesisPause pause(*this);
+    target_buffer_ms = std::min<uint32_t>(std::max<uint32_t>(ms, AUDIO_MIN_BUFFER_MS), AUDIO_RING_BUFFER_MS / 2);
+
+    // Device callback size follows the target
+    reopenAudioSink();
+}
+
+uint32_t APU::getTargetBufferMs() const
+{
+    return target_buffer_ms;
+}
+
+AudioRingBufferStats APU::getAudioBufferStats() const
+{
+    if (!audio_sink)
+    {
+        return {};
+    }
+
+    return audio_sink->getStats();
+}
+
+void APU::setAudioSink(std::shared_ptr<AudioSink> sink)
+{
+    SynthesisPause pause(*this);
+
+    // Samples made so far go to the old output
+    flushSampleBuffer();
+
+    if (initialized)
+    {
+        audio_sink->close();
+    }
+
+    audio_sink = sink;
+    openAudioSink();
+
+    updateCyclesUntilBufferFull();
+}
+
+std::shared_ptr<AudioSink> APU::getAudioSink() const
+{
+    return audio_sink;
+}
+
+void APU::reopenAudioSink()
+{
+    if (!initialized)
+    {
+        return;
+    }
+
+    audio_sink->close();
+    openAudioSink();
+}
+
+// Bytes in one stereo sample of the output format
+size_t APU::getOutputSampleSize() const
+{
+    return getAudioSampleSize(output_format);
+}
+
+// Nudges the resampling rate by up to AUDIO_MAX_RATE_DELTA so the audio buffer stays at its target.
+// Frames are paced by the clock, which never exactly matches the audio device, the GB's
+// ~59.73 Hz frame rate or the display's refresh rate. Small enough to not be heard as a pitch change
+void APU::updateDynamicRate()
+{
+    if (register_shadow)
+    {   // Synthesis thread updates the rate each time it writes out samples
+        return;
+    }
+
+    adjustRateToBuffer();
+}
+
+void APU::adjustRateToBuffer()
+{
+    if (!initialized ||
+        !dynamic_rate_control ||
+        !audio_sink->isRealTime())
+    {
+        return;
+    }
+
+    const double target_bytes = ((static_cast<double>(sample_rate) * target_buffer_ms) / 1000.0) * getOutputSampleSize();
+    const double fill = std::min(1.0, static_cast<double>(audio_sink->getBufferedBytes()) / (2.0 * target_bytes));
+
+    // Buffer at target == 1.0, empty == make more samples, double target == make fewer samples
+    rate_adjustment = 1.0 + (AUDIO_MAX_RATE_DELTA * (1.0 - (2.0 * fill)));
+    updateResampleRate();
+}
+
+void APU::setDynamicRateControl(const bool & enabled)
+{
+    SynthesisPause pause(*this);
+    dynamic_rate_control = enabled;
+
+    if (!dynamic_rate_control)
+    {
+        rate_adjustment = 1.0;
+        updateResampleRate();
+    }
+}
+
+double APU::getRateAdjustment() const
+{
+    return rate_adjustment;
+}
+
+void APU::updateResampleRate()
+{
+    for (BlipBuffer & channel_buffer : channel_buffers)
+    {
+        channel_buffer.setRates(CLOCK_SPEED, sample_rate * rate_adjustment);
+    }
+}
+
+// Above AUDIO_MAX_STRETCH_SPEED the audio would be mostly stretching artifacts,
+// so samples are only counted. Below it the time stretcher keeps the pitch
+void APU::setEmulationSpeed(const double & speed)
+{
+    SynthesisPause pause(*this);
+
+    // Samples made so far were made at the old speed
+    flushSampleBuffer();
+
+    emulation_speed = speed;
+    statistics_only = emulation_speed > AUDIO_MAX_STRETCH_SPEED;
+
+    time_stretcher.setSpeed(emulation_speed);
+    time_stretcher.clear();
+}
+
+bool APU::isStatisticsOnly() const
+{
+    return statistics_only;
+}
+
+// Silent mode skips synthesis and mixing. Channels still run their timers,
+// length counters, sweep and envelope so register reads, NR52 and wave RAM
+// access behave exactly as they do with sound
+void APU::setSilentMode(const bool & silent)
+{
+    if (silent == silent_mode)
+    {
+        return;
+    }
+
+    SynthesisPause pause(*this);
+
+    // Samples made so far still get played
+    flushSampleBuffer();
+
+    silent_mode = silent;
+    updateCyclesUntilBufferFull();
+
+    if (initialized)
+    {   // Stop the audio output while there's nothing to play
+        audio_sink->setPaused(silent_mode);
+    }
+}
+
+bool APU::isSilentMode() const
+{
+    return silent_mode;
+}
+
+void APU::setRunningAhead(const bool & enable)
+{
+    if (enable == running_ahead)
+    {
+        return;
+    }
+
+    if (enable)
+    {   // Cycles before running ahead are played
+        catchUp();
+        run_ahead_cycle_count = cycle_count;
+    }
+
+    running_ahead = enable;
+    updateCyclesUntilBufferFull();
+}
+
+bool APU::isRunningAhead() const
+{
+    return running_ahead;
+}
+
+// Files are written on their own threads, the emulator never waits on the disk.
+// Each channel is recorded to "<path without extension>.channel<n>.wav"
+bool APU::startRecording(const std::filesystem::path & path, const bool & record_channels)
+{
+    stopRecording();
+
+    SynthesisPause pause(*this);
+
+    // Samples already made aren't part of the recording
+    flushSampleBuffer();
+
+    recording = std::make_unique<WavWriter>();
+    if (!recording->open(path, sample_rate, SAMPLE_OUTPUT_CHANNEL_SIZE))
+    {
+        logger->error("Unable to open audio recording: {}", path.string());
+        recording.reset();
+        return false;
+    }
+
+    if (record_channels)
+    {
+        for (uint8_t i = 0; i < AUDIO_MIXER_NUM_CHANNELS; i++)
+        {
+            std::filesystem::path channel_path = path;
+            channel_path.replace_extension(".channel" + std::to_string(i + 1) + path.extension().string());
+
+            channel_recordings[i] = std::make_unique<WavWriter>();
+            if (!channel_recordings[i]->open(channel_path, sample_rate, 1))
+            {
+                logger->error("Unable to open audio recording: {}", channel_path.string());
+                channel_recordings[i].reset();
+            }
+        }
+    }
+
+    logger->info("Started audio recording: {}", path.string());
+    return true;
+}
+
+void APU::stopRecording()
+{
+    if (!recording)
+    {
+        return;
+    }
+
+    SynthesisPause pause(*this);
+
+    // Record what's been made so far
+    flushSampleBuffer();
+
+    auto closeRecording = [this](std::unique_ptr<WavWriter> & wav_writer)
+    {
+        if (!wav_writer)
+        {
+            return;
+        }
+
+        wav_writer->close();
+
+        const AudioRingBufferStats stats = wav_writer->getQueueStats();
+        if (wav_writer->hasFailed() || stats.overruns > 0)
+        {
+            logger->warn("Audio recording is incomplete, failed writing: {}, dropped blocks: {}",
+                wav_writer->hasFailed(), stats.overruns);
+        }
+        wav_writer.reset();
+    };
+
+    closeRecording(recording);
+    for (std::unique_ptr<WavWriter> & channel_recording : channel_recordings)
+    {
+        closeRecording(channel_recording);
+    }
+
+    logger->info("Stopped audio recording");
+}
+
+bool APU::isRecording() const
+{
+    return recording != nullptr;
+}
+
+// The APU's channels are run by the synthesis thread, the CPU's thread only runs
+// register_shadow. It's this APU in silent mode, so reads of NR52, length counters
+// and wave RAM are exact without waiting for the synthesis thread
+void APU::setPipelinedSynthesis(const bool & enable)
+{
+    if (enable == (register_shadow != nullptr))
+    {
+        return;
+    }
+
+    if (enable)
+    {
+        runPendingCycles();
+
+        auto shadow = std::make_unique<APU>(logger_sink, logger, false);
+        *shadow = *this;
+        shadow->setSilentMode(true);
+        shadow->setChannelLogLevel(sound_channel_1->logger->level());
+
+        // Only the CPU's thread logs, the synthesis thread would share the log file with it
+        logger = std::make_shared<spdlog::logger>("APU.Synthesis", logger_sink);
+        logger->set_level(spdlog::level::off);
+        setChannelLogLevel(spdlog::level::off);
+
+        register_shadow = std::move(shadow);
+        synthesis_queue = std::make_unique<AudioRingBuffer>(APU_SYNTHESIS_QUEUE_SIZE * sizeof(APUSynthesisEvent));
+        cycle_count = 0;
+        synthesis_cycle = 0;
+        startSynthesisThread();
+    }
+    else
+    {
+        // Everything queued is replayed before the thread exits
+        stopSynthesisThread();
+
+        // Channels and registers are now as up to date as the shadow's
+        logger = register_shadow->logger;
+        const spdlog::level::level_enum channel_log_level = register_shadow->sound_channel_1->logger->level();
+        register_shadow.reset();
+        setChannelLogLevel(channel_log_level);
+        synthesis_queue.reset();
+    }
+}
+
+bool APU::isPipelinedSynthesis() const
+{
+    return register_shadow != nullptr;
+}
+
+void APU::pushSynthesisEvent(const uint16_t & addr, const uint8_t & value)
+{
+    const APUSynthesisEvent event = { cycle_count, addr, value };
+
+    // Events can't be dropped, wait for the synthesis thread to make room
+    while (synthesis_queue->getCapacity() - synthesis_queue->getBufferedBytes() < sizeof(event))
+    {
+        synthesis_cv.notify_one();
+        std::this_thread::yield();
+    }
+
+    synthesis_queue->write(reinterpret_cast<const uint8_t *>(&event), sizeof(event));
+}
+
+void APU::startSynthesisThread()
+{
+    if (!register_shadow ||
+        synthesis_thread.joinable())
+    {
+        return;
+    }
+
+    stop_synthesis_thread = false;
+    synthesis_thread = std::thread(&APU::synthesisThreadLoop, this);
+}
+
+// Returns true if the thread was running
+bool APU::stopSynthesisThread()
+{
+    if (!synthesis_thread.joinable())
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lg(synthesis_mutex);
+        stop_synthesis_thread = true;
+    }
+    synthesis_cv.notify_all();
+    synthesis_thread.join();
+    return true;
+}
+
+// Replays events as they're queued, and everything left when stopped
+void APU::synthesisThreadLoop()
+{
+    std::unique_lock<std::mutex> lk(synthesis_mutex);
+
+    while (!stop_synthesis_thread)
+    {
+        // The CPU's thread only wakes this thread once a frame, the timeout keeps
+        // it from falling too far behind on register writes
+        synthesis_cv.wait_for(lk, std::chrono::milliseconds(APU_SYNTHESIS_POLL_MS));
+
+        lk.unlock();
+        replaySynthesisEvents();
+        lk.lock();
+    }
+
+    replaySynthesisEvents();
+}
+
+void APU::replaySynthesisEvents()
+{
+    APUSynthesisEvent event;
+
+    while (synthesis_queue->getBufferedBytes() >= sizeof(event))
+    {
+        synthesis_queue->read(reinterpret_cast<uint8_t *>(&event), sizeof(event), 0);
+
+        runCycles(event.cycle - synthesis_cycle);
+        synthesis_cycle = event.cycle;
+
+        switch (event.addr)
+        {
+        case APU_EVENT_WRITE_SAMPLES_OUT:
+            flushSampleBuffer();
+            adjustRateToBuffer();
+            break;
+        case APU_EVENT_INIT_CGB:
+            enableDoubleSpeed();
+            break;
+        default:
+            writeRegister(event.addr, event.value);
+            break;
+        }
+    }
+}
+
+// Same as calling run() for 'cycles', without going past the point the sample buffer is full
+void APU::runCycles(uint64_t cycles)
+{
+    while (cycles > 0)
+    {
+        const uint32_t cycles_to_full = (cycles_until_buffer_full > pending_cycles) ?
+            cycles_until_buffer_full - pending_cycles :
+            1;
+        const uint32_t block = static_cast<uint32_t>(std::min<uint64_t>(cycles, cycles_to_full));
+
+        pending_cycles += block;
+        cycles -= block;
+
+        if (pending_cycles >= cycles_until_buffer_full)
+        {
+            runPendingCycles();
+        }
+    }
+}
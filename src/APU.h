@@ -3,33 +3,44 @@
 
 #include <atomic>
 #include <array>
-#include <fstream>
+#include <condition_variable>
+#include <filesystem>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 #include <AudioSquare.h>
 #include <AudioWave.h>
 #include <AudioNoise.h>
+#include <AudioMixer.h>
+#include <AudioRingBuffer.h>
+#include <AudioSink.h>
+#include <AudioTimeStretcher.h>
+#include <BlipBuffer.h>
+#include <SaveState.h>
+#include <WavWriter.h>
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/rotating_file_sink.h>
-#include <SDL_audio.h>
-#include <RollingAvg.h>
 
 #define SAMPLE_RATE 44100
 #define MICROSEC_PER_FRAME (1.0 / 60.0) * 1000.0 * 1000.0
-
-
-#define USE_FLOAT
-//#define WRITE_AUDIO_OUT
+#define SAMPLE_BUFFER_MARGIN 8      // Samples a catch up can run past the point the buffer is full
+#define CHANNEL_MAX_VOLUME 15.0f    // 0x0F
+#define CHANNEL_MAX_VOLUME_MIX 60.0f // 0x0F * 4 channels
+#define AUDIO_TARGET_BUFFER_MS 40   // Default audio buffered before the emulator waits
+#define AUDIO_MIN_BUFFER_MS 10
+#define AUDIO_MAX_WAIT_MS 100       // Longest the emulator waits for the audio device
+#define AUDIO_MAX_RATE_DELTA 0.005  // Dynamic rate control can change the sample rate by +-0.5%
+#define AUDIO_MAX_STRETCH_SPEED 4.0 // Faster emulation than this only counts samples
+#define APU_SYNTHESIS_QUEUE_SIZE 8192   // Events the CPU's thread can be ahead of the synthesis thread
+#define APU_SYNTHESIS_POLL_MS 2         // Synthesis thread checks for events at least this often
+#define APU_EVENT_WRITE_SAMPLES_OUT 0x0000
+#define APU_EVENT_INIT_CGB 0x0001
 
 struct Sample {
-#ifndef USE_FLOAT
-    uint8_t left   = 0;
-    uint8_t right  = 0;
-#else
     float left = 0;
     float right = 0;
-#endif
 
     std::string getSampleStr()
     {
@@ -42,51 +53,135 @@ struct Sample {
     }
 };
 
+// One channel's block of samples, only valid during the call it's passed to
+struct AudioSampleSpan
+{
+    const float * data = nullptr;
+    size_t size = 0;
+};
+
+typedef std::array<AudioSampleSpan, AUDIO_MIXER_NUM_CHANNELS> AudioChannelSpans;
+
+// Register write, or an APU_EVENT_*, replayed by the synthesis thread at the CPU cycle it happened
+struct APUSynthesisEvent
+{
+    uint64_t cycle;
+    uint16_t addr;
+    uint8_t value;
+};
+
 class APU
 {
 public:
-    APU(std::shared_ptr<spdlog::sinks::rotating_file_sink_st> logger_sink, std::shared_ptr<spdlog::logger> logger);
+    // 'open_audio_device' plays the audio on an SDL device, headless builds have no audio output by default
+    APU(std::shared_ptr<spdlog::sinks::rotating_file_sink_mt> logger_sink, std::shared_ptr<spdlog::logger> logger,
+        const bool & open_audio_device = true);
     virtual ~APU();
     APU& operator=(const APU& rhs);
+    // Catches up first, so the channels are saved as of the last CPU cycle
+    void saveState(StateWriter & state);
+    void loadState(StateReader & state);
 
     void setByte(const uint16_t & addr, const uint8_t & val);
-    uint8_t readByte(const uint16_t & addr) const;
+    uint8_t readByte(const uint16_t & addr);
+    uint8_t peekByte(const uint16_t & addr) const;
     void run(const uint8_t & cpuTicks);
+    void catchUp();
     void initCGB();
     void setChannelLogLevel(spdlog::level::level_enum level);
-    void setSampleUpdateMethod(std::function<void(float, int)> function);
+    // Called once per block of samples written out, with every channel's samples in -1..1
+    void setSampleUpdateMethod(std::function<void(const AudioChannelSpans &)> function);
     void sendSamplesToDebugger(bool b);
-    void writeSamplesOutAsync(const uint32_t& audio_device);
+    void writeSamplesOutAsync();
     void sleepUntilBufferIsEmpty(const std::chrono::duration<double>& frame_start_time);
+    // Replaces the audio output, nullptr for none
+    void setAudioSink(std::shared_ptr<AudioSink> sink);
+    std::shared_ptr<AudioSink> getAudioSink() const;
+    void setOutputSpec(const int & sample_rate, const SDL_AudioFormat & format);
+    int getSampleRate() const;
+    SDL_AudioFormat getOutputFormat() const;
+    void setTargetBufferMs(const uint32_t & ms);
+    uint32_t getTargetBufferMs() const;
+    AudioRingBufferStats getAudioBufferStats() const;
+    void updateDynamicRate();
+    void setDynamicRateControl(const bool & enabled);
+    double getRateAdjustment() const;
+    void setEmulationSpeed(const double & speed);
+    bool isStatisticsOnly() const;
+    void setSilentMode(const bool & silent);
+    bool isSilentMode() const;
+    // Frames run ahead are undone by a restore, so they make no samples and leave
+    // the audio output and synthesis thread alone
+    void setRunningAhead(const bool & running_ahead);
+    bool isRunningAhead() const;
+    // Records the mixed output to a .wav file, and each channel to its own file when 'record_channels'
+    bool startRecording(const std::filesystem::path & path, const bool & record_channels);
+    void stopRecording();
+    bool isRecording() const;
+    // Synthesizes audio on its own thread from timestamped register writes.
+    // The CPU's thread runs a silent copy of the APU so register reads stay exact
+    void setPipelinedSynthesis(const bool & enable);
+    bool isPipelinedSynthesis() const;
 
     std::shared_ptr<spdlog::logger> logger;
     uint16_t samplesPerFrame;
-    uint8_t sdl_silence_val;
-    uint32_t audio_device_id;
     const int SAMPLE_BUFFER_SIZE;             // 1470
     const int SAMPLE_OUTPUT_CHANNEL_SIZE;     // 2
     const int SAMPLE_BUFFER_MEM_SIZE;         // SAMPLE_BUFFER_SIZE * SAMPLE_OUTPUT_CHANNEL_SIZE
     const int SAMPLE_BUFFER_MEM_SIZE_FLOAT;   // SAMPLE_BUFFER_MEM_SIZE * sizeof(float)
 
 private:
-    void initSDLAudio();
+    class SynthesisPause;
+
+    void openAudioSink();
+    void reopenAudioSink();
+    size_t getOutputSampleSize() const;
+    void updateResampleRate();
     void reset();
+    void writeRegister(const uint16_t & addr, const uint8_t & val);
+    void runPendingCycles();
+    void runCycles(uint64_t cycles);
+    void enableDoubleSpeed();
+    void flushSampleBuffer();
+    void adjustRateToBuffer();
+    void pushSynthesisEvent(const uint16_t & addr, const uint8_t & value);
+    void startSynthesisThread();
+    bool stopSynthesisThread();
+    void synthesisThreadLoop();
+    void replaySynthesisEvents();
+    void tickFrameSequencer();
+    void advanceChannels(const uint32_t & cycles, const uint32_t & time);
+    void mixOutput(const uint32_t & time);
+    void updateCyclesUntilBufferFull();
     bool isSoundOutLeft(uint8_t sound_number) const;
     bool isSoundOutRight(uint8_t sound_number) const;
-    void sendChannelOutputToSample(Sample & sample, const uint8_t & audio, const uint8_t & channelNum) const;
-    void sendChannelOutputToSampleFloat(Sample & sample, const float & audio, const uint8_t & channelNum) const;
-    void writeSamplesOut(const uint32_t & audio_device, const std::vector<Sample>& samples, const uint16_t num_samples);
-    uint8_t mixAudio(const uint8_t & audio1, const uint8_t & audio2);
+    void writeSamplesOut(const std::vector<Sample>& samples, const uint16_t num_samples);
+    void sendDebuggerSamples();
     void logSamples();
     void clearCurrentAudioBuffer();
 
-    std::function<void(float, int)> sendSampleUpdate;
-    std::unique_ptr<std::ofstream> audioFileOut;
+    std::function<void(const AudioChannelSpans &)> sendSampleUpdate;
+    std::shared_ptr<spdlog::sinks::rotating_file_sink_mt> logger_sink;
+    std::unique_ptr<APU> register_shadow;                   // Silent copy run by the CPU's thread when synthesis is pipelined
+    std::unique_ptr<AudioRingBuffer> synthesis_queue;       // APUSynthesisEvents for the synthesis thread
+    std::thread synthesis_thread;
+    std::mutex synthesis_mutex;
+    std::condition_variable synthesis_cv;
+    std::unique_ptr<WavWriter> recording;                                           // Mixed output
+    std::array<std::unique_ptr<WavWriter>, AUDIO_MIXER_NUM_CHANNELS> channel_recordings;
+    std::vector<float> channel_recording_samples;
     std::unique_ptr<AudioSquare> sound_channel_1;
     std::unique_ptr<AudioSquare> sound_channel_2;
     std::unique_ptr<AudioWave>   sound_channel_3;
     std::unique_ptr<AudioNoise>  sound_channel_4;
     std::array<std::vector<Sample>, 2> double_sample_buffer;
+    std::vector<BlipBuffer> channel_buffers;                                // Band-limited output of each channel
+    std::array<std::vector<float>, AUDIO_MIXER_NUM_CHANNELS> channel_samples;
+    std::array<std::vector<float>, AUDIO_MIXER_NUM_CHANNELS> debugger_samples;   // Collected until the next write out
+    std::vector<int16_t> s16_sample_buffer;
+    std::vector<float> stretched_sample_buffer;
+    AudioTimeStretcher time_stretcher;                      // Keeps pitch when not running at 1x
+    std::shared_ptr<AudioSink> audio_sink;
     uint8_t frame_sequence_step;
     uint8_t left_volume;
     uint8_t right_volume;
@@ -95,20 +190,30 @@ private:
     uint8_t channel_control;
     uint8_t selection_of_sound_output;
     uint16_t sample_buffer_counter;
+    uint16_t debugger_sample_counter;
     const uint16_t frame_sequence_timer_val;
     uint16_t frame_sequence_timer;
-    uint32_t sample_timer;
-    uint32_t prev_sample_size;
-    RollingAvg rolling_avg_sample_size;
-    const uint32_t sample_timer_val;
-    SDL_AudioSpec desired_spec;
-    SDL_AudioSpec obtained_spec;
+    uint32_t pending_cycles;            // CPU cycles not yet run by the APU
+    uint32_t cycles_until_buffer_full;  // Pending cycles that will fill the sample buffer
+    uint32_t target_buffer_ms;
+    uint64_t cycle_count;               // CPU cycles run, counted on the CPU's thread
+    uint64_t synthesis_cycle;           // CPU cycle the synthesis thread has run up to
+    double rate_adjustment;             // Multiplier on sample_rate from dynamic rate control
+    double emulation_speed;
+    SDL_AudioFormat output_format;
+    int sample_rate;
     bool sound_on;
     bool left_out_enabled;
     bool right_out_enabled;
     bool double_speed_mode;
     bool send_samples_to_debugger;
-    bool initialized;
+    bool initialized;                   // audio_sink is open
+    bool dynamic_rate_control;
+    bool statistics_only;               // Samples are counted but not mixed or played
+    bool silent_mode;                   // No samples are made, only register state is emulated
+    bool running_ahead;
+    uint64_t run_ahead_cycle_count;     // cycle_count when running ahead started
+    bool stop_synthesis_thread;
     std::atomic_bool curr_sample_buffer;
 };
 
@@ -0,0 +1,95 @@
+#ifdef _WIN32
+#include "stdafx.h"
+#endif // _WIN32
+
+#include "AudioMixer.h"
+#include <algorithm>
+#include <cmath>
+
+#ifdef AUDIO_MIXER_USE_SSE2
+#include <emmintrin.h>
+#endif // AUDIO_MIXER_USE_SSE2
+
+void AudioMixer::mix(const std::array<const float *, AUDIO_MIXER_NUM_CHANNELS> & channels,
+    const std::array<float, AUDIO_MIXER_NUM_CHANNELS> & left_gains,
+    const std::array<float, AUDIO_MIXER_NUM_CHANNELS> & right_gains,
+    float * out, const size_t & num_samples)
+{
+    size_t i = 0;
+
+#ifdef AUDIO_MIXER_USE_SSE2
+    std::array<__m128, AUDIO_MIXER_NUM_CHANNELS> left_gain_4;
+    std::array<__m128, AUDIO_MIXER_NUM_CHANNELS> right_gain_4;
+    for (size_t c = 0; c < AUDIO_MIXER_NUM_CHANNELS; c++)
+    {
+        left_gain_4[c]  = _mm_set1_ps(left_gains[c]);
+        right_gain_4[c] = _mm_set1_ps(right_gains[c]);
+    }
+    const __m128 max_4 = _mm_set1_ps(1.0f);
+    const __m128 min_4 = _mm_set1_ps(-1.0f);
+
+    for (; i + 4 <= num_samples; i += 4)
+    {
+        __m128 left  = _mm_setzero_ps();
+        __m128 right = _mm_setzero_ps();
+
+        for (size_t c = 0; c < AUDIO_MIXER_NUM_CHANNELS; c++)
+        {
+            const __m128 in = _mm_loadu_ps(channels[c] + i);
+            left  = _mm_add_ps(left,  _mm_mul_ps(in, left_gain_4[c]));
+            right = _mm_add_ps(right, _mm_mul_ps(in, right_gain_4[c]));
+        }
+
+        left  = _mm_max_ps(_mm_min_ps(left,  max_4), min_4);
+        right = _mm_max_ps(_mm_min_ps(right, max_4), min_4);
+
+        // Interleave into L R L R
+        _mm_storeu_ps(out + (i * 2),     _mm_unpacklo_ps(left, right));
+        _mm_storeu_ps(out + (i * 2) + 4, _mm_unpackhi_ps(left, right));
+    }
+#endif // AUDIO_MIXER_USE_SSE2
+
+    // Remaining samples, or all of them without SSE2
+    for (; i < num_samples; i++)
+    {
+        float left  = 0.0f;
+        float right = 0.0f;
+
+        for (size_t c = 0; c < AUDIO_MIXER_NUM_CHANNELS; c++)
+        {
+            left  += channels[c][i] * left_gains[c];
+            right += channels[c][i] * right_gains[c];
+        }
+
+        out[(i * 2)]     = std::max(std::min(left,  1.0f), -1.0f);
+        out[(i * 2) + 1] = std::max(std::min(right, 1.0f), -1.0f);
+    }
+}
+
+void AudioMixer::convertToS16(const float * in, int16_t * out, const size_t & num_values)
+{
+    size_t i = 0;
+
+#ifdef AUDIO_MIXER_USE_SSE2
+    const __m128 scale_4 = _mm_set1_ps(32767.0f);
+    const __m128 max_4 = _mm_set1_ps(1.0f);
+    const __m128 min_4 = _mm_set1_ps(-1.0f);
+
+    for (; i + 8 <= num_values; i += 8)
+    {
+        const __m128 low_f  = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(in + i),     max_4), min_4);
+        const __m128 high_f = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(in + i + 4), max_4), min_4);
+
+        const __m128i low  = _mm_cvtps_epi32(_mm_mul_ps(low_f,  scale_4));
+        const __m128i high = _mm_cvtps_epi32(_mm_mul_ps(high_f, scale_4));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packs_epi32(low, high));
+    }
+#endif // AUDIO_MIXER_USE_SSE2
+
+    for (; i < num_values; i++)
+    {
+        // Rounds halves to even like the SSE2 conversion, so it doesn't matter which path a value takes
+        const float value = std::max(std::min(in[i], 1.0f), -1.0f) * 32767.0f;
+        out[i] = static_cast<int16_t>(std::lrint(value));
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+#define AUDIO_MIXER_NUM_CHANNELS 4
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIO_MIXER_USE_SSE2
+#endif
+
+// Mixes whole buffers of channel output into interleaved stereo samples.
+// Uses SSE2 when available, 4 output samples at a time
+class AudioMixer
+{
+public:
+    // Interleaved left/right output, clamped to [-1.0, 1.0]
+    static void mix(const std::array<const float *, AUDIO_MIXER_NUM_CHANNELS> & channels,
+        const std::array<float, AUDIO_MIXER_NUM_CHANNELS> & left_gains,
+        const std::array<float, AUDIO_MIXER_NUM_CHANNELS> & right_gains,
+        float * out, const size_t & num_samples);
+
+    // Converts float samples in [-1.0, 1.0] to signed 16 bit
+    static void convertToS16(const float * in, int16_t * out, const size_t & num_values);
+};
+
+#endif // AUDIO_MIXER_H
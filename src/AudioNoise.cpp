@@ -1,6 +1,44 @@
 #include <AudioNoise.h>
 #include "Joypad.h"
 
+#define LFSR_15_BIT_PERIOD 32767
+#define LFSR_7_BIT_PERIOD 127
+
+// Every state of the 15-bit and 7-bit LFSRs in shift order,
+// so any number of shifts can be done with one table lookup
+struct LFSRSequences
+{
+    LFSRSequences()
+    {
+        uint16_t lfsr = 0x7FFF;
+        for (uint16_t i = 0; i < LFSR_15_BIT_PERIOD; i++)
+        {
+            sequence_15[i] = lfsr;
+            position_15[lfsr] = i;
+            lfsr = (lfsr >> 1) | (((lfsr ^ (lfsr >> 1)) & 0x01) << 14);
+        }
+
+        uint8_t lfsr_7 = 0x7F;
+        for (uint8_t i = 0; i < LFSR_7_BIT_PERIOD; i++)
+        {
+            sequence_7[i] = lfsr_7;
+            position_7[lfsr_7] = i;
+            lfsr_7 = (lfsr_7 >> 1) | (((lfsr_7 ^ (lfsr_7 >> 1)) & 0x01) << 6);
+        }
+    }
+
+    std::array<uint16_t, LFSR_15_BIT_PERIOD> sequence_15;
+    std::array<uint16_t, LFSR_15_BIT_PERIOD + 1> position_15;
+    std::array<uint8_t, LFSR_7_BIT_PERIOD> sequence_7;
+    std::array<uint8_t, LFSR_7_BIT_PERIOD + 1> position_7;
+};
+
+static const LFSRSequences& getLFSRSequences()
+{
+    static const LFSRSequences sequences;
+    return sequences;
+}
+
 AudioNoise::AudioNoise(const uint16_t & register_offset, std::shared_ptr<spdlog::logger> _logger)
     :   reg_offset(register_offset),
         logger(_logger)
@@ -15,6 +53,7 @@ AudioNoise::AudioNoise(const uint16_t & register_offset, std::shared_ptr<spdlog:
     dividing_ratio_of_frequencies       = 0;
     volume                              = 0;
     output_volume                       = 0;
+    last_output_volume                  = 0;
     lfsr                                = 0;
     restart_sound                       = false;
     envelope_increase                   = false;
@@ -53,6 +92,7 @@ AudioNoise& AudioNoise::operator=(const AudioNoise& rhs)
     dividing_ratio_of_frequencies = rhs.dividing_ratio_of_frequencies;
     volume                  = rhs.volume;
     output_volume           = rhs.output_volume;
+    last_output_volume      = rhs.last_output_volume;
     lfsr                    = rhs.lfsr;
     restart_sound           = rhs.restart_sound;
     envelope_increase       = rhs.envelope_increase;
@@ -65,6 +105,53 @@ AudioNoise& AudioNoise::operator=(const AudioNoise& rhs)
     return *this;
 }
 
+void AudioNoise::saveState(StateWriter & state) const
+{
+    state.write(output_volume);
+    state.write(sound_length_data);
+    state.write(is_enabled);
+    state.write(restart_sound);
+    state.write(timer);
+    state.write(initial_volume_of_envelope);
+    state.write(envelope_period);
+    state.write(envelope_period_load);
+    state.write(shift_clock_frequency);
+    state.write(dividing_ratio_of_frequencies);
+    state.write(volume);
+    state.write(lfsr);
+    state.write(half_counter_step);
+    state.write(dac_enabled);
+    state.write(envelope_increase);
+    state.write(envelope_running);
+    state.write(stop_output_when_sound_length_ends);
+}
+
+void AudioNoise::loadState(StateReader & state)
+{
+    state.read(output_volume);
+    state.read(sound_length_data);
+    state.read(is_enabled);
+    state.read(restart_sound);
+    state.read(timer);
+    state.read(initial_volume_of_envelope);
+    state.read(envelope_period);
+    state.read(envelope_period_load);
+    state.read(shift_clock_frequency);
+    state.read(dividing_ratio_of_frequencies);
+    state.read(volume);
+    state.read(lfsr);
+    state.read(half_counter_step);
+    state.read(dac_enabled);
+    state.read(envelope_increase);
+    state.read(envelope_running);
+    state.read(stop_output_when_sound_length_ends);
+}
+
+void AudioNoise::clearOutput()
+{
+    last_output_volume = 0;
+}
+
 void AudioNoise::setByte(const uint16_t & addr, const uint8_t & val)
 {
     uint16_t useAddr = addr - reg_offset;
@@ -170,37 +257,63 @@ void AudioNoise::reset()
     lfsr = 0x7FFF;
 }
 
-void AudioNoise::tick()
+// Runs the channel's frequency timer for a block of CPU cycles starting at 'time',
+// adding every change in output to 'output' at the cycle it happens.
+// Registers can't change during the block, so every reload uses the same period
+void AudioNoise::advance(const uint32_t & cycles, BlipBuffer * output, const uint32_t & time)
 {
     if (timer == 0)
+    {   // Timer isn't running until the channel is restarted
+        return;
+    }
+
+    // Pick up changes from register writes and the frame sequencer
+    updateOutput(output, time);
+
+    if (cycles == 0)
     {
         return;
     }
 
-    if (timer > 0)
+    if (timer > cycles)
     {
-        timer--;
+        timer -= cycles;
+        return;
     }
 
-    if (timer == 0)
-    {   // Reload timer
-        timer = divisors[dividing_ratio_of_frequencies] << shift_clock_frequency;
-
-        // "the low two bits (0 and 1) are XORed"
-        const uint16_t xor_result = (lfsr & 0x01) ^ ((lfsr >> 1) & 0x01);
-        // "all bits are shifted right by one"
-        lfsr >>= 1;
-        // "and the result of the XOR is put into the now-empty high bit."
-        lfsr &= 0x3FFF;
-        lfsr |= (xor_result << 14);
-
-        if (half_counter_step)
+    const uint32_t cycles_after_reload = cycles - timer;
+    const uint16_t timer_load = divisors[dividing_ratio_of_frequencies] << shift_clock_frequency;
+
+    if (timer_load == 0)
+    {   // Timer stops after the first reload
+        shiftLFSR();
+        updateOutput(output, time + timer - 1);
+        timer = 0;
+    }
+    else if (output == nullptr ||
+             !is_enabled ||
+             !dac_enabled ||
+             volume == 0)
+    {   // Output stays 0 or isn't wanted for the whole block, skip straight to the last reload
+        timer = timer_load - (cycles_after_reload % timer_load);
+        stepLFSR(1 + (cycles_after_reload / timer_load));
+    }
+    else
+    {   // Reload timer, shifting the LFSR once per reload
+        uint32_t reload_cycle = timer;
+        while (reload_cycle <= cycles)
         {
-            lfsr &= 0xFF3F;             // Treat lfsr as 1 byte, mask off bit 7-6
-            lfsr |= (xor_result << 6);  // Put XOR result into bit 6
+            shiftLFSR();
+            updateOutput(output, time + reload_cycle - 1);
+
+            reload_cycle += timer_load;
         }
+        timer = reload_cycle - cycles;
     }
+}
 
+void AudioNoise::updateOutput(BlipBuffer * output, const uint32_t & time)
+{
     if (is_enabled &&
         dac_enabled &&
         (lfsr & 0x01) == 0)
@@ -211,6 +324,72 @@ void AudioNoise::tick()
     {
         output_volume = 0;
     }
+
+    if (output != nullptr &&
+        output_volume != last_output_volume)
+    {
+        output->addDelta(time, static_cast<int32_t>(output_volume) - static_cast<int32_t>(last_output_volume));
+        last_output_volume = output_volume;
+    }
+}
+
+void AudioNoise::stepLFSR(const uint32_t & steps)
+{
+    const LFSRSequences & sequences = getLFSRSequences();
+
+    if (half_counter_step && steps >= 8)
+    {   // Bits 0-6 form their own 7-bit LFSR, after 7 or more shifts
+        // bits 8-14 hold the same values and bit 7 is cleared
+        const uint8_t lfsr_7 = lfsr & 0x7F;
+        if (lfsr_7 != 0)
+        {
+            const uint8_t pos = (sequences.position_7[lfsr_7] + steps) % LFSR_7_BIT_PERIOD;
+            lfsr = (static_cast<uint16_t>(sequences.sequence_7[pos]) << 8) | sequences.sequence_7[pos];
+        }
+        else
+        {
+            lfsr = 0;
+        }
+        return;
+    }
+
+    if (half_counter_step)
+    {
+        for (uint32_t i = 0; i < steps; i++)
+        {
+            shiftLFSR();
+        }
+        return;
+    }
+
+    // 15-bit LFSR, bit 15 is shifted out on the first step and 0 never changes
+    const uint16_t lfsr_15 = lfsr & 0x7FFF;
+    if (lfsr_15 != 0)
+    {
+        const uint16_t pos = (sequences.position_15[lfsr_15] + steps) % LFSR_15_BIT_PERIOD;
+        lfsr = sequences.sequence_15[pos];
+    }
+    else
+    {
+        lfsr = 0;
+    }
+}
+
+void AudioNoise::shiftLFSR()
+{
+    // "the low two bits (0 and 1) are XORed"
+    const uint16_t xor_result = (lfsr & 0x01) ^ ((lfsr >> 1) & 0x01);
+    // "all bits are shifted right by one"
+    lfsr >>= 1;
+    // "and the result of the XOR is put into the now-empty high bit."
+    lfsr &= 0x3FFF;
+    lfsr |= (xor_result << 14);
+
+    if (half_counter_step)
+    {
+        lfsr &= 0xFF3F;             // Treat lfsr as 1 byte, mask off bit 7-6
+        lfsr |= (xor_result << 6);  // Put XOR result into bit 6
+    }
 }
 
 void AudioNoise::tickLengthCounter()
@@ -5,6 +5,8 @@
 #include <array>
 #include <memory>
 #include <spdlog/spdlog.h>
+#include "BlipBuffer.h"
+#include "SaveState.h"
 
 class AudioNoise
 {
@@ -12,10 +14,15 @@ public:
     AudioNoise(const uint16_t & register_offset, std::shared_ptr<spdlog::logger> logger);
     virtual ~AudioNoise();
     AudioNoise& operator=(const AudioNoise& rhs);
+    void saveState(StateWriter & state) const;
+    void loadState(StateReader & state);
 
     void setByte(const uint16_t & addr, const uint8_t & val);
     uint8_t readByte(const uint16_t & addr) const;
-    void tick();
+    // Without an output buffer only the channel's state is advanced
+    void advance(const uint32_t & cycles, BlipBuffer * output, const uint32_t & time);
+    // Next output starts from silence, for when the buffer it goes to was cleared
+    void clearOutput();
     void tickLengthCounter();
     void tickVolumeEnvelope();
     void reset();
@@ -23,6 +30,7 @@ public:
 
     std::shared_ptr<spdlog::logger> logger;
     uint8_t output_volume;
+    uint8_t last_output_volume;     // Amplitude last added to the output BlipBuffer
     uint8_t sound_length_data;
     bool is_enabled;
     bool restart_sound;
@@ -30,6 +38,9 @@ public:
 private:
     void parseRegister(const uint8_t & reg, const uint8_t & val);
     void reloadPeriod(uint8_t & period, const uint8_t & periodLoad);
+    void stepLFSR(const uint32_t & steps);
+    void shiftLFSR();
+    void updateOutput(BlipBuffer * output, const uint32_t & time);
 
     uint16_t reg_offset;
     std::array<uint8_t, 8> divisors;
@@ -0,0 +1,99 @@
+#ifdef _WIN32
+#include "stdafx.h"
+#endif // _WIN32
+
+#include "AudioRingBuffer.h"
+#include <algorithm>
+#include <cstring>
+
+AudioRingBuffer::AudioRingBuffer(const size_t & capacity_bytes)
+    : write_pos(0)
+    , overruns(0)
+    , read_pos(0)
+    , underruns(0)
+{
+    // Round up to a power of 2 so positions wrap with a mask
+    size_t capacity = 1;
+    while (capacity < capacity_bytes)
+    {
+        capacity <<= 1;
+    }
+
+    buffer.resize(capacity, 0);
+    mask = capacity - 1;
+}
+
+AudioRingBuffer::~AudioRingBuffer()
+{
+
+}
+
+size_t AudioRingBuffer::write(const uint8_t * data, const size_t & num_bytes)
+{
+    const size_t write = write_pos.load(std::memory_order_relaxed);
+    const size_t read = read_pos.load(std::memory_order_acquire);
+    const size_t free_bytes = buffer.size() - (write - read);
+    const size_t bytes_to_write = std::min(num_bytes, free_bytes);
+
+    if (bytes_to_write < num_bytes)
+    {
+        overruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Copy in up to 2 parts, around the end of the buffer
+    const size_t start = write & mask;
+    const size_t first_part = std::min(bytes_to_write, buffer.size() - start);
+    std::memcpy(&buffer[start], data, first_part);
+    std::memcpy(&buffer[0], data + first_part, bytes_to_write - first_part);
+
+    write_pos.store(write + bytes_to_write, std::memory_order_release);
+    return bytes_to_write;
+}
+
+size_t AudioRingBuffer::read(uint8_t * out, const size_t & num_bytes, const uint8_t & silence)
+{
+    const size_t read = read_pos.load(std::memory_order_relaxed);
+    const size_t write = write_pos.load(std::memory_order_acquire);
+    const size_t bytes_to_read = std::min(num_bytes, write - read);
+
+    if (bytes_to_read < num_bytes)
+    {
+        underruns.fetch_add(1, std::memory_order_relaxed);
+        std::memset(out + bytes_to_read, silence, num_bytes - bytes_to_read);
+    }
+
+    // Copy out up to 2 parts, around the end of the buffer
+    const size_t start = read & mask;
+    const size_t first_part = std::min(bytes_to_read, buffer.size() - start);
+    std::memcpy(out, &buffer[start], first_part);
+    std::memcpy(out + first_part, &buffer[0], bytes_to_read - first_part);
+
+    read_pos.store(read + bytes_to_read, std::memory_order_release);
+    return bytes_to_read;
+}
+
+void AudioRingBuffer::clear()
+{
+    read_pos.store(write_pos.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+size_t AudioRingBuffer::getBufferedBytes() const
+{
+    // Read first, it can only move up to where write already is
+    const size_t read = read_pos.load(std::memory_order_acquire);
+    return write_pos.load(std::memory_order_acquire) - read;
+}
+
+size_t AudioRingBuffer::getCapacity() const
+{
+    return buffer.size();
+}
+
+AudioRingBufferStats AudioRingBuffer::getStats() const
+{
+    AudioRingBufferStats stats;
+    stats.underruns = underruns.load(std::memory_order_relaxed);
+    stats.overruns = overruns.load(std::memory_order_relaxed);
+    stats.buffered_bytes = getBufferedBytes();
+    return stats;
+}
@@ -0,0 +1,51 @@
+#ifndef AUDIO_RING_BUFFER_H
+#define AUDIO_RING_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#define AUDIO_RING_BUFFER_CACHE_LINE 64
+
+struct AudioRingBufferStats
+{
+    uint64_t underruns;     // Reads that ran out of samples
+    uint64_t overruns;      // Writes that didn't fit, extra samples are dropped
+    size_t buffered_bytes;
+};
+
+// Fixed size single producer, single consumer ring buffer of audio bytes.
+// The emulator thread writes and the audio device's callback reads, without locking.
+// Read and write positions live on their own cache lines so the two threads don't share one
+class AudioRingBuffer
+{
+public:
+    AudioRingBuffer(const size_t & capacity_bytes);
+    virtual ~AudioRingBuffer();
+
+    // Producer
+    size_t write(const uint8_t * data, const size_t & num_bytes);
+
+    // Consumer, 'silence' fills whatever couldn't be read
+    size_t read(uint8_t * out, const size_t & num_bytes, const uint8_t & silence);
+
+    // Only safe while the consumer isn't running
+    void clear();
+
+    size_t getBufferedBytes() const;
+    size_t getCapacity() const;
+    AudioRingBufferStats getStats() const;
+
+private:
+    std::vector<uint8_t> buffer;
+    size_t mask;
+
+    alignas(AUDIO_RING_BUFFER_CACHE_LINE) std::atomic<size_t> write_pos;
+    std::atomic<uint64_t> overruns;
+
+    alignas(AUDIO_RING_BUFFER_CACHE_LINE) std::atomic<size_t> read_pos;
+    std::atomic<uint64_t> underruns;
+};
+
+#endif // AUDIO_RING_BUFFER_H
@@ -0,0 +1,156 @@
+#ifdef _WIN32
+#include "stdafx.h"
+#endif // _WIN32
+
+#include "AudioSink.h"
+#include <algorithm>
+
+size_t getAudioSampleSize(const SDL_AudioFormat & format)
+{
+    return (format == AUDIO_S16SYS) ?
+        2 * sizeof(int16_t) :
+        2 * sizeof(float);
+}
+
+int NullAudioSink::open(const int & sample_rate, const SDL_AudioFormat &, const uint32_t &)
+{
+    return sample_rate;
+}
+
+void NullAudioSink::close()
+{
+
+}
+
+void NullAudioSink::setPaused(const bool &)
+{
+
+}
+
+size_t NullAudioSink::write(const uint8_t *, const size_t & num_bytes)
+{
+    return num_bytes;
+}
+
+void NullAudioSink::clear()
+{
+
+}
+
+bool NullAudioSink::isRealTime() const
+{
+    return false;
+}
+
+size_t NullAudioSink::getBufferedBytes() const
+{
+    return 0;
+}
+
+void NullAudioSink::waitForBufferedBytes(const size_t &, const std::chrono::milliseconds &)
+{
+
+}
+
+AudioRingBufferStats NullAudioSink::getStats() const
+{
+    return {};
+}
+
+MemoryAudioSink::MemoryAudioSink(const uint32_t & max_ms)
+    : max_bytes(0)
+    , overruns(0)
+    , max_ms(max_ms)
+    , sample_rate(0)
+    , format(AUDIO_F32SYS)
+{
+
+}
+
+int MemoryAudioSink::open(const int & rate, const SDL_AudioFormat & fmt, const uint32_t &)
+{
+    std::lock_guard<std::mutex> lg(mutex);
+    sample_rate = rate;
+    format = fmt;
+    max_bytes = (static_cast<size_t>(sample_rate) * max_ms / 1000) * getAudioSampleSize(format);
+    bytes.clear();
+    bytes.reserve(max_bytes);
+    return sample_rate;
+}
+
+void MemoryAudioSink::close()
+{
+
+}
+
+void MemoryAudioSink::setPaused(const bool &)
+{
+
+}
+
+size_t MemoryAudioSink::write(const uint8_t * data, const size_t & num_bytes)
+{
+    std::lock_guard<std::mutex> lg(mutex);
+
+    const size_t num_written = std::min(num_bytes, max_bytes - bytes.size());
+    if (num_written != num_bytes)
+    {
+        overruns++;
+    }
+
+    bytes.insert(bytes.end(), data, data + num_written);
+    return num_written;
+}
+
+void MemoryAudioSink::clear()
+{
+    std::lock_guard<std::mutex> lg(mutex);
+    bytes.clear();
+}
+
+bool MemoryAudioSink::isRealTime() const
+{
+    return false;
+}
+
+size_t MemoryAudioSink::getBufferedBytes() const
+{
+    std::lock_guard<std::mutex> lg(mutex);
+    return bytes.size();
+}
+
+void MemoryAudioSink::waitForBufferedBytes(const size_t &, const std::chrono::milliseconds &)
+{   // Nothing drains it but takeBytes()
+
+}
+
+AudioRingBufferStats MemoryAudioSink::getStats() const
+{
+    std::lock_guard<std::mutex> lg(mutex);
+
+    AudioRingBufferStats stats = {};
+    stats.overruns = overruns;
+    stats.buffered_bytes = bytes.size();
+    return stats;
+}
+
+void MemoryAudioSink::takeBytes(std::vector<uint8_t> & out)
+{
+    out.clear();
+
+    // Memory 'out' had is reused for the next writes
+    std::lock_guard<std::mutex> lg(mutex);
+    std::swap(bytes, out);
+}
+
+int MemoryAudioSink::getSampleRate() const
+{
+    std::lock_guard<std::mutex> lg(mutex);
+    return sample_rate;
+}
+
+SDL_AudioFormat MemoryAudioSink::getFormat() const
+{
+    std::lock_guard<std::mutex> lg(mutex);
+    return format;
+}
@@ -0,0 +1,91 @@
+#ifndef AUDIO_SINK_H
+#define AUDIO_SINK_H
+
+#include <AudioRingBuffer.h>
+#include <SDLTypes.h>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#define AUDIO_RING_BUFFER_MS 250    // Ring buffer size of real time sinks, the most audio that can be buffered
+#define AUDIO_MEMORY_SINK_DEFAULT_MS 1000   // Audio a MemoryAudioSink holds before dropping samples
+
+// Bytes in one stereo sample of 'format'
+size_t getAudioSampleSize(const SDL_AudioFormat & format);
+
+// Where the APU writes its mixed stereo output.
+// Called from the APU's synthesis thread when synthesis is pipelined, otherwise the emulator's
+class AudioSink
+{
+public:
+    virtual ~AudioSink() {}
+
+    // Returns the sample rate the output runs at, which can differ from 'sample_rate',
+    // or 0 if the output couldn't be opened
+    virtual int open(const int & sample_rate, const SDL_AudioFormat & format, const uint32_t & target_buffer_ms) = 0;
+    virtual void close() = 0;
+    virtual void setPaused(const bool & paused) = 0;
+    // Returns the number of bytes taken, the rest are dropped
+    virtual size_t write(const uint8_t * data, const size_t & num_bytes) = 0;
+    // Drops anything not played yet
+    virtual void clear() = 0;
+
+    // Played at the rate it's written, so the APU paces itself and adjusts its rate to the buffer
+    virtual bool isRealTime() const = 0;
+    virtual size_t getBufferedBytes() const = 0;
+    // Blocks until no more than 'target_bytes' are buffered or 'timeout' passes
+    virtual void waitForBufferedBytes(const size_t & target_bytes, const std::chrono::milliseconds & timeout) = 0;
+    virtual AudioRingBufferStats getStats() const = 0;
+};
+
+// Throws the audio away
+class NullAudioSink : public AudioSink
+{
+public:
+    int open(const int & sample_rate, const SDL_AudioFormat & format, const uint32_t & target_buffer_ms);
+    void close();
+    void setPaused(const bool & paused);
+    size_t write(const uint8_t * data, const size_t & num_bytes);
+    void clear();
+
+    bool isRealTime() const;
+    size_t getBufferedBytes() const;
+    void waitForBufferedBytes(const size_t & target_bytes, const std::chrono::milliseconds & timeout);
+    AudioRingBufferStats getStats() const;
+};
+
+// Collects the audio for the caller to take, up to 'max_ms' of it
+class MemoryAudioSink : public AudioSink
+{
+public:
+    MemoryAudioSink(const uint32_t & max_ms = AUDIO_MEMORY_SINK_DEFAULT_MS);
+
+    int open(const int & sample_rate, const SDL_AudioFormat & format, const uint32_t & target_buffer_ms);
+    void close();
+    void setPaused(const bool & paused);
+    size_t write(const uint8_t * data, const size_t & num_bytes);
+    void clear();
+
+    bool isRealTime() const;
+    size_t getBufferedBytes() const;
+    void waitForBufferedBytes(const size_t & target_bytes, const std::chrono::milliseconds & timeout);
+    AudioRingBufferStats getStats() const;
+
+    // Swaps everything written since the last call into 'out'
+    void takeBytes(std::vector<uint8_t> & out);
+    int getSampleRate() const;
+    SDL_AudioFormat getFormat() const;
+
+private:
+    mutable std::mutex mutex;
+    std::vector<uint8_t> bytes;
+    size_t max_bytes;
+    uint64_t overruns;
+    uint32_t max_ms;
+    int sample_rate;
+    SDL_AudioFormat format;
+};
+
+#endif // AUDIO_SINK_H
@@ -20,9 +20,11 @@ AudioSquare::AudioSquare(const uint16_t & register_offset, std::shared_ptr<spdlo
     frequency_16                = 0;
     sweep_frequency_16          = 0;
     timer                       = 64;
+    period                      = 0;
     curr_sample                 = 0;
     volume                      = 0;
     output_volume               = 0;
+    last_output_volume          = 0;
     sweep_decrease              = false;
     sweep_running               = false;
     envelope_increase           = false;
@@ -58,6 +60,7 @@ AudioSquare& AudioSquare::operator=(const AudioSquare& rhs)
     curr_sample         = rhs.curr_sample;
     volume              = rhs.volume;
     output_volume       = rhs.output_volume;
+    last_output_volume  = rhs.last_output_volume;
     sweep_decrease      = rhs.sweep_decrease;
     sweep_running       = rhs.sweep_running;
     envelope_increase   = rhs.envelope_increase;
@@ -70,6 +73,69 @@ AudioSquare& AudioSquare::operator=(const AudioSquare& rhs)
     return *this;
 }
 
+void AudioSquare::saveState(StateWriter & state) const
+{
+    state.write(duty_pos);
+    state.write(output_volume);
+    state.write(is_enabled);
+    state.write(restart_sound);
+    state.write(volume);
+    state.write(curr_sample);
+    state.write(sweep_period);
+    state.write(sweep_period_load);
+    state.write(sweep_shift);
+    state.write(wave_pattern_duty);
+    state.write(initial_volume_of_envelope);
+    state.write(envelope_period_load);
+    state.write(envelope_period);
+    state.write(frequency_16);
+    state.write(sweep_frequency_16);
+    state.write(timer);
+    state.write(period);
+    state.write(sound_length_data);
+    state.write(sound_length_load);
+    state.write(sweep_decrease);
+    state.write(sweep_running);
+    state.write(envelope_increase);
+    state.write(envelope_running);
+    state.write(dac_enabled);
+    state.write(stop_output_when_sound_length_ends);
+}
+
+void AudioSquare::loadState(StateReader & state)
+{
+    state.read(duty_pos);
+    state.read(output_volume);
+    state.read(is_enabled);
+    state.read(restart_sound);
+    state.read(volume);
+    state.read(curr_sample);
+    state.read(sweep_period);
+    state.read(sweep_period_load);
+    state.read(sweep_shift);
+    state.read(wave_pattern_duty);
+    state.read(initial_volume_of_envelope);
+    state.read(envelope_period_load);
+    state.read(envelope_period);
+    state.read(frequency_16);
+    state.read(sweep_frequency_16);
+    state.read(timer);
+    state.read(period);
+    state.read(sound_length_data);
+    state.read(sound_length_load);
+    state.read(sweep_decrease);
+    state.read(sweep_running);
+    state.read(envelope_increase);
+    state.read(envelope_running);
+    state.read(dac_enabled);
+    state.read(stop_output_when_sound_length_ends);
+}
+
+void AudioSquare::clearOutput()
+{
+    last_output_volume = 0;
+}
+
 void AudioSquare::setByte(const uint16_t & addr, const uint8_t & val)
 {
     uint16_t useAddr = addr - reg_offset;
@@ -232,26 +298,62 @@ void AudioSquare::initWaveDutyTable()
     wave_duty_table[3] = { 0, 0, 0, 0, 0, 0, 1, 1 };    // 75% duty
 }
 
-void AudioSquare::tick()
+// Runs the channel's frequency timer for a block of CPU cycles starting at 'time',
+// adding every change in output to 'output' at the cycle it happens.
+// Registers can't change during the block, so every reload uses the same period
+void AudioSquare::advance(const uint32_t & cycles, BlipBuffer * output, const uint32_t & time)
 {
-    if (timer > 0)
+    // Pick up changes from register writes and the frame sequencer
+    updateOutput(output, time);
+
+    if (cycles == 0)
     {
-        timer--;
+        return;
     }
 
     if (timer == 0)
+    {   // Timer reloads on the next cycle
+        timer = 1;
+    }
+
+    if (timer > cycles)
     {
-        // Calculate period
-        period = (2048 - frequency_16) * 4;
+        timer -= cycles;
+        return;
+    }
+
+    // Calculate period
+    period = (2048 - frequency_16) * 4;
+
+    if (output == nullptr ||
+        !is_enabled ||
+        !dac_enabled ||
+        volume == 0)
+    {   // Output stays 0 or isn't wanted for the whole block, skip straight to the last reload
+        const uint64_t cycles_after_reload = cycles - timer;
+        const uint64_t num_reloads = 1 + (cycles_after_reload / period);
+        timer = period - (cycles_after_reload % period);
+        duty_pos = (duty_pos + num_reloads) & 0x07;
 
-        timer = period; // Reload frequency period
-        duty_pos++;
-        duty_pos &= 0x07;
-        
         curr_sample = wave_duty_table[wave_pattern_duty][duty_pos];
+        return;
     }
 
-    // Update output
+    // Reload frequency period, moving duty_pos once per reload
+    uint64_t reload_cycle = timer;
+    while (reload_cycle <= cycles)
+    {
+        duty_pos = (duty_pos + 1) & 0x07;
+        curr_sample = wave_duty_table[wave_pattern_duty][duty_pos];
+        updateOutput(output, time + static_cast<uint32_t>(reload_cycle) - 1);
+
+        reload_cycle += period;
+    }
+    timer = reload_cycle - cycles;
+}
+
+void AudioSquare::updateOutput(BlipBuffer * output, const uint32_t & time)
+{
     if (is_enabled &&
         dac_enabled &&
         curr_sample > 0)
@@ -262,6 +364,13 @@ void AudioSquare::tick()
     {
         output_volume = 0;
     }
+
+    if (output != nullptr &&
+        output_volume != last_output_volume)
+    {
+        output->addDelta(time, static_cast<int32_t>(output_volume) - static_cast<int32_t>(last_output_volume));
+        last_output_volume = output_volume;
+    }
 }
 
 void AudioSquare::tickLengthCounter()
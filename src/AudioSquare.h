@@ -6,6 +6,8 @@
 #include <string>
 #include <vector>
 #include <spdlog/spdlog.h>
+#include "BlipBuffer.h"
+#include "SaveState.h"
 
 class AudioSquare
 {
@@ -13,10 +15,15 @@ public:
     AudioSquare(const uint16_t & register_offset, std::shared_ptr<spdlog::logger> logger);
     virtual ~AudioSquare();
     AudioSquare& operator=(const AudioSquare& rhs);
+    void saveState(StateWriter & state) const;
+    void loadState(StateReader & state);
 
     void setByte(const uint16_t & addr, const uint8_t & val);
     uint8_t readByte(const uint16_t & addr) const;
-    void tick();
+    // Without an output buffer only the channel's state is advanced
+    void advance(const uint32_t & cycles, BlipBuffer * output, const uint32_t & time);
+    // Next output starts from silence, for when the buffer it goes to was cleared
+    void clearOutput();
     void tickLengthCounter();
     void tickVolumeEnvelope();
     void tickSweep();
@@ -26,6 +33,7 @@ public:
     std::shared_ptr<spdlog::logger> logger;
     uint8_t duty_pos;
     uint8_t output_volume;
+    uint8_t last_output_volume;     // Amplitude last added to the output BlipBuffer
     bool is_enabled;
     bool restart_sound;
 
@@ -34,6 +42,7 @@ private:
     void initWaveDutyTable();
     void parseRegister(const uint8_t & reg, const uint8_t & val);
     void reloadPeriod(uint8_t & period, const uint8_t & periodLoad);
+    void updateOutput(BlipBuffer * output, const uint32_t & time);
 
     std::array<std::array<bool, 8>, 4> wave_duty_table;
     uint8_t volume;
@@ -0,0 +1,134 @@
+#ifdef _WIN32
+#include "stdafx.h"
+#endif // _WIN32
+
+#include "AudioTimeStretcher.h"
+#include <algorithm>
+#include <cmath>
+
+AudioTimeStretcher::AudioTimeStretcher(const int & rate)
+    : input_position(0.0)
+    , speed(1.0)
+    , sample_rate(0)
+    , sequence_length(0)
+    , overlap_length(0)
+    , seek_length(0)
+    , has_overlap(false)
+{
+    setSampleRate(rate);
+}
+
+AudioTimeStretcher::~AudioTimeStretcher()
+{
+
+}
+
+void AudioTimeStretcher::setSampleRate(const int & rate)
+{
+    if (rate == sample_rate)
+    {
+        return;
+    }
+
+    sample_rate = rate;
+    sequence_length = (static_cast<size_t>(sample_rate) * TIME_STRETCH_SEQUENCE_MS) / 1000;
+    overlap_length  = (static_cast<size_t>(sample_rate) * TIME_STRETCH_OVERLAP_MS) / 1000;
+    seek_length     = (static_cast<size_t>(sample_rate) * TIME_STRETCH_SEEK_MS) / 1000;
+    clear();
+}
+
+void AudioTimeStretcher::setSpeed(const double & s)
+{
+    speed = s;
+}
+
+void AudioTimeStretcher::clear()
+{
+    input.clear();
+    overlap.assign(overlap_length * 2, 0.0f);
+    input_position = 0.0;
+    has_overlap = false;
+}
+
+void AudioTimeStretcher::process(const float * in, const size_t & num_samples, std::vector<float> & out)
+{
+    input.insert(input.end(), in, in + (num_samples * 2));
+
+    // Each piece writes out everything but its overlap, which is faded into the next piece
+    const size_t output_per_sequence = sequence_length - overlap_length;
+
+    while ((static_cast<size_t>(input_position) + seek_length + sequence_length) * 2 <= input.size())
+    {
+        const float * search_start = &input[static_cast<size_t>(input_position) * 2];
+        const float * sequence = search_start + (has_overlap ? findBestOffset(search_start) * 2 : 0);
+
+        // Cross-fade from the end of the last piece
+        for (size_t i = 0; i < overlap_length; i++)
+        {
+            const float fade_in = has_overlap ? (static_cast<float>(i) + 0.5f) / overlap_length : 1.0f;
+            out.push_back((overlap[(i * 2)]     * (1.0f - fade_in)) + (sequence[(i * 2)]     * fade_in));
+            out.push_back((overlap[(i * 2) + 1] * (1.0f - fade_in)) + (sequence[(i * 2) + 1] * fade_in));
+        }
+
+        // Middle of the piece goes out as is
+        out.insert(out.end(), sequence + (overlap_length * 2), sequence + (output_per_sequence * 2));
+
+        // End of the piece is faded into the next one
+        std::copy(sequence + (output_per_sequence * 2), sequence + (sequence_length * 2), overlap.begin());
+        has_overlap = true;
+
+        input_position += output_per_sequence * speed;
+    }
+
+    // Drop input that's been passed
+    const size_t used_samples = std::min(static_cast<size_t>(input_position), input.size() / 2);
+    input.erase(input.begin(), input.begin() + (used_samples * 2));
+    input_position -= used_samples;
+}
+
+size_t AudioTimeStretcher::findBestOffset(const float * search_start) const
+{
+    size_t best_offset = 0;
+    float best_correlation = -INFINITY;
+
+    for (size_t offset = 0; offset < seek_length; offset += TIME_STRETCH_COARSE_STEP)
+    {
+        const float correlation = getCorrelation(search_start + (offset * 2));
+        if (correlation > best_correlation)
+        {
+            best_correlation = correlation;
+            best_offset = offset;
+        }
+    }
+
+    // Refine around the best coarse offset
+    const size_t coarse_offset = best_offset;
+    const size_t refine_start = (coarse_offset >= TIME_STRETCH_COARSE_STEP) ? coarse_offset - TIME_STRETCH_COARSE_STEP + 1 : 0;
+    const size_t refine_end = std::min(coarse_offset + TIME_STRETCH_COARSE_STEP, seek_length);
+    for (size_t offset = refine_start; offset < refine_end; offset++)
+    {
+        const float correlation = getCorrelation(search_start + (offset * 2));
+        if (correlation > best_correlation)
+        {
+            best_correlation = correlation;
+            best_offset = offset;
+        }
+    }
+
+    return best_offset;
+}
+
+// Normalized cross-correlation of 'candidate' with the end of the last piece
+float AudioTimeStretcher::getCorrelation(const float * candidate) const
+{
+    float correlation = 0.0f;
+    float energy = 0.0f;
+
+    for (size_t i = 0; i < overlap_length * 2; i++)
+    {
+        correlation += overlap[i] * candidate[i];
+        energy += candidate[i] * candidate[i];
+    }
+
+    return correlation / std::sqrt(energy + 1e-9f);
+}
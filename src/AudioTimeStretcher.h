@@ -0,0 +1,46 @@
+#ifndef AUDIO_TIME_STRETCHER_H
+#define AUDIO_TIME_STRETCHER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#define TIME_STRETCH_SEQUENCE_MS 40     // Length of each piece of input copied to the output
+#define TIME_STRETCH_OVERLAP_MS 8       // Cross-fade between pieces
+#define TIME_STRETCH_SEEK_MS 12         // How far ahead to look for the best matching piece
+#define TIME_STRETCH_COARSE_STEP 4      // Seek checks every 4th offset, then refines around the best
+
+// WSOLA (waveform similarity overlap-add) time stretcher for interleaved stereo float samples.
+// Changes the length of the audio without changing its pitch: pieces of input are taken
+// 'speed' times further apart than they are written out, each one shifted to where its
+// waveform best lines up with the end of the previous piece, then cross-faded together.
+class AudioTimeStretcher
+{
+public:
+    AudioTimeStretcher(const int & sample_rate);
+    virtual ~AudioTimeStretcher();
+
+    void setSampleRate(const int & sample_rate);
+    // 2.0 == output is half as long as the input
+    void setSpeed(const double & speed);
+    void clear();
+
+    // Appends the stretched samples to 'out'
+    void process(const float * in, const size_t & num_samples, std::vector<float> & out);
+
+private:
+    size_t findBestOffset(const float * search_start) const;
+    float getCorrelation(const float * candidate) const;
+
+    std::vector<float> input;       // Input not used yet, interleaved
+    std::vector<float> overlap;     // End of the last piece written out, interleaved
+    double input_position;          // Where the next piece starts in 'input', in stereo samples
+    double speed;
+    int sample_rate;
+    size_t sequence_length;
+    size_t overlap_length;
+    size_t seek_length;
+    bool has_overlap;
+};
+
+#endif // AUDIO_TIME_STRETCHER_H
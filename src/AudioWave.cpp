@@ -8,12 +8,16 @@ AudioWave::AudioWave(const uint16_t & register_offset, std::shared_ptr<spdlog::l
 {
     volume          = 0;
     output_volume   = 0;
+    last_output_volume = 0;
     frequency_16    = 0;
     frequency       = 0;
     timer           = 64;
     period          = 0;
     nibble_pos      = 0;
+    curr_sample     = 0;
+    sound_length_load = 0;
     sound_length_data = 0.0f;
+    wave_pattern_RAM.fill(0);
     restart_sound       = false;
     is_enabled          = false;
     channel_is_enabled  = false;
@@ -29,6 +33,7 @@ AudioWave& AudioWave::operator=(const AudioWave& rhs)
 {   // Copy from rhs
     volume              = rhs.volume;
     output_volume       = rhs.output_volume;
+    last_output_volume  = rhs.last_output_volume;
     frequency_16        = rhs.frequency_16;
     frequency           = rhs.frequency;
     timer               = rhs.timer;
@@ -43,6 +48,49 @@ AudioWave& AudioWave::operator=(const AudioWave& rhs)
     return *this;
 }
 
+void AudioWave::saveState(StateWriter & state) const
+{
+    state.write(output_volume);
+    state.write(sound_length_load);
+    state.write(sound_length_data);
+    state.write(is_enabled);
+    state.write(restart_sound);
+    state.write(curr_sample);
+    state.write(volume);
+    state.write(nibble_pos);
+    state.write(frequency_16);
+    state.write(frequency);
+    state.write(timer);
+    state.write(period);
+    state.write(channel_is_enabled);
+    state.write(stop_output_when_sound_length_ends);
+    state.write(wave_pattern_RAM);
+}
+
+void AudioWave::loadState(StateReader & state)
+{
+    state.read(output_volume);
+    state.read(sound_length_load);
+    state.read(sound_length_data);
+    state.read(is_enabled);
+    state.read(restart_sound);
+    state.read(curr_sample);
+    state.read(volume);
+    state.read(nibble_pos);
+    state.read(frequency_16);
+    state.read(frequency);
+    state.read(timer);
+    state.read(period);
+    state.read(channel_is_enabled);
+    state.read(stop_output_when_sound_length_ends);
+    state.read(wave_pattern_RAM);
+}
+
+void AudioWave::clearOutput()
+{
+    last_output_volume = 0;
+}
+
 void AudioWave::setByte(const uint16_t & addr, const uint8_t & val)
 {
     switch (addr)
@@ -162,32 +210,66 @@ void AudioWave::reset()
     }
 }
 
-void AudioWave::tick()
+// Runs the channel's frequency timer for a block of CPU cycles starting at 'time',
+// adding every change in output to 'output' at the cycle it happens.
+// Registers can't change during the block, so every reload uses the same period
+void AudioWave::advance(const uint32_t & cycles, BlipBuffer * output, const uint32_t & time)
 {
-    if (timer > 0)
+    // Pick up changes from register writes and the frame sequencer
+    updateOutput(output, time);
+
+    if (cycles == 0)
     {
-        timer--;
+        return;
     }
 
     if (timer == 0)
+    {   // Timer reloads on the next cycle
+        timer = 1;
+    }
+
+    if (timer > cycles)
     {
-        // Calculate period
-        period = (2048 - frequency_16) * 2;
-        timer = period;
-
-        // Increment nibble position
-        nibble_pos++;
-        nibble_pos &= 0x1F;
-        
+        timer -= cycles;
+        return;
+    }
+
+    // Calculate period
+    period = (2048 - frequency_16) * 2;
+
+    if (output == nullptr ||
+        !is_enabled ||
+        !channel_is_enabled ||
+        volume == 0)
+    {   // Output stays 0 or isn't wanted for the whole block, skip straight to the last reload
+        const uint64_t cycles_after_reload = cycles - timer;
+        const uint64_t num_reloads = 1 + (cycles_after_reload / period);
+        timer = period - (cycles_after_reload % period);
+        nibble_pos = (nibble_pos + num_reloads) & 0x1F;
+
         if (is_enabled &&
             channel_is_enabled)
         {
             updateSample();
         }
+        return;
     }
-    
 
-    // Update output
+    // Reload frequency period, moving nibble_pos once per reload
+    uint64_t reload_cycle = timer;
+    while (reload_cycle <= cycles)
+    {
+        nibble_pos = (nibble_pos + 1) & 0x1F;
+        updateSample();
+        updateOutput(output, time + static_cast<uint32_t>(reload_cycle) - 1);
+
+        reload_cycle += period;
+    }
+    timer = reload_cycle - cycles;
+}
+
+void AudioWave::updateOutput(BlipBuffer * output, const uint32_t & time)
+{
     if (is_enabled &&
         channel_is_enabled &&
         curr_sample != 0)
@@ -198,6 +280,13 @@ void AudioWave::tick()
     {
         output_volume = 0;
     }
+
+    if (output != nullptr &&
+        output_volume != last_output_volume)
+    {
+        output->addDelta(time, static_cast<int32_t>(output_volume) - static_cast<int32_t>(last_output_volume));
+        last_output_volume = output_volume;
+    }
 }
 
 void AudioWave::tickLengthCounter()
@@ -5,6 +5,8 @@
 #include <vector>
 #include <memory>
 #include <spdlog/spdlog.h>
+#include "BlipBuffer.h"
+#include "SaveState.h"
 
 class AudioWave
 {
@@ -12,16 +14,22 @@ public:
     AudioWave(const uint16_t & register_offset, std::shared_ptr<spdlog::logger> logger);
     virtual ~AudioWave();
     AudioWave& operator=(const AudioWave& rhs);
+    void saveState(StateWriter & state) const;
+    void loadState(StateReader & state);
 
     void setByte(const uint16_t & addr, const uint8_t & val);
     uint8_t readByte(const uint16_t & addr) const;
-    void tick();
+    // Without an output buffer only the channel's state is advanced
+    void advance(const uint32_t & cycles, BlipBuffer * output, const uint32_t & time);
+    // Next output starts from silence, for when the buffer it goes to was cleared
+    void clearOutput();
     void tickLengthCounter();
     void reset();
     bool isRunning();
 
     std::shared_ptr<spdlog::logger> logger;
     uint8_t output_volume;
+    uint8_t last_output_volume;     // Amplitude last added to the output BlipBuffer
     uint8_t sound_length_load;
     uint16_t sound_length_data;
     bool is_enabled;
@@ -29,6 +37,7 @@ public:
 
 private:
     void updateSample();
+    void updateOutput(BlipBuffer * output, const uint32_t & time);
 
     uint16_t reg_offset;
     uint8_t curr_sample;
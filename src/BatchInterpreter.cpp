@@ -0,0 +1,309 @@
+#ifdef _WIN32
+#include "stdafx.h"
+#endif // _WIN32
+
+#include "BatchInterpreter.h"
+
+namespace
+{
+    enum LaneRegister { LANE_B, LANE_C, LANE_D, LANE_E, LANE_H, LANE_L, LANE_A, LANE_F };
+
+    // Register in bits 0-2 or 3-5 of an opcode, 6 is (HL) and never grouped
+    const LaneRegister OPCODE_REGISTERS[8] = { LANE_B, LANE_C, LANE_D, LANE_E, LANE_H, LANE_L, LANE_F, LANE_A };
+
+    bool isGroupable(const uint8_t & opcode)
+    {
+        const uint8_t reg1 = (opcode >> 3) & 0x07;
+        const uint8_t reg2 = opcode & 0x07;
+
+        if (opcode == 0x00)
+        {   // NOP
+            return true;
+        }
+        else if (opcode < 0x40)
+        {   // INC X, DEC X
+            return (reg2 == 4 || reg2 == 5) && reg1 != 6;
+        }
+        else if (opcode < 0x80)
+        {   // LD X, Y
+            return reg1 != 6 && reg2 != 6;
+        }
+        else if (opcode < 0xC0)
+        {   // ADD, SUB, AND, XOR, OR, CP A, X. ADC and SBC stay scalar
+            return reg2 != 6 && reg1 != 1 && reg1 != 3;
+        }
+        return false;
+    }
+
+    uint8_t zeroFlag(const uint8_t & result)
+    {
+        return (result == 0) ? 0x80 : 0x00;
+    }
+}
+
+BatchInterpreter::BatchInterpreter(const std::string & rom_path, const size_t & num_lanes)
+    : frame_instructions(num_lanes, 0)
+    , ticks_ran(num_lanes, 0)
+    , num_grouped(0)
+    , num_scalar(0)
+{
+    for (size_t i = 0; i < num_lanes; i++)
+    {
+        std::shared_ptr<GBCEmulator> lane = std::make_shared<GBCEmulator>(rom_path,
+            rom_path + ".lane" + std::to_string(i) + ".log", "", false, false, false, false);
+        lane->runWithoutSleep = true;
+        lane->get_APU()->setSilentMode(true);
+
+        lanes.push_back(lane);
+    }
+
+    for (std::vector<uint8_t> & reg : registers)
+    {
+        reg.resize(num_lanes);
+    }
+    active_lanes.reserve(num_lanes);
+    group_opcodes.reserve(0x100);
+}
+
+void BatchInterpreter::runFrames(const uint32_t & frames)
+{
+    for (uint32_t frame = 0; frame < frames; frame++)
+    {
+        active_lanes.clear();
+        for (size_t i = 0; i < lanes.size(); i++)
+        {
+            lanes[i]->startFrame(true);
+            frame_instructions[i] = 0;
+            active_lanes.push_back(i);
+        }
+
+        while (!active_lanes.empty())
+        {
+            step();
+
+            // Lanes drop out where runFrame() would have stopped
+            size_t still_active = 0;
+            for (const size_t & i : active_lanes)
+            {
+                frame_instructions[i]++;
+                if (frame_instructions[i] < lanes[i]->ticksPerFrame && !lanes[i]->gpu->frame_is_ready)
+                {
+                    active_lanes[still_active++] = i;
+                }
+            }
+            active_lanes.resize(still_active);
+        }
+
+        for (std::shared_ptr<GBCEmulator> & lane : lanes)
+        {
+            lane->finishFrame();
+        }
+    }
+}
+
+size_t BatchInterpreter::getNumLanes() const
+{
+    return lanes.size();
+}
+
+std::shared_ptr<GBCEmulator> BatchInterpreter::getLane(const size_t & index) const
+{
+    return lanes.at(index);
+}
+
+uint64_t BatchInterpreter::getNumGrouped() const
+{
+    return num_grouped;
+}
+
+uint64_t BatchInterpreter::getNumScalar() const
+{
+    return num_scalar;
+}
+
+// One instruction on every active lane, the same as each one's runNextInstruction()
+void BatchInterpreter::step()
+{
+    for (const size_t & i : active_lanes)
+    {
+        CPU & cpu = *lanes[i]->cpu;
+
+        ticks_ran[i] = 0;
+        const uint8_t opcode = cpu.getInstruction(ticks_ran[i]);
+
+        if (isGroupable(opcode) && canGroup(i))
+        {
+            if (groups[opcode].empty())
+            {
+                group_opcodes.push_back(opcode);
+            }
+            groups[opcode].push_back(i);
+        }
+        else
+        {
+            ticks_ran[i] += cpu.runInstruction(opcode);
+            num_scalar++;
+        }
+    }
+
+    for (const uint8_t & opcode : group_opcodes)
+    {
+        runGroup(opcode, groups[opcode]);
+        groups[opcode].clear();
+    }
+    group_opcodes.clear();
+
+    for (const size_t & i : active_lanes)
+    {
+        lanes[i]->runComponents(ticks_ran[i]);
+    }
+}
+
+void BatchInterpreter::runGroup(const uint8_t & opcode, const std::vector<size_t> & group)
+{
+    const size_t n = group.size();
+
+    if (n < BATCH_MIN_GROUP_SIZE)
+    {
+        for (const size_t & i : group)
+        {
+            ticks_ran[i] += lanes[i]->cpu->runInstruction(opcode);
+            num_scalar++;
+        }
+        return;
+    }
+
+    // Registers are kept as CPU::set_register() stores them, the first register of each pair in the low byte
+    for (size_t k = 0; k < n; k++)
+    {
+        const std::vector<std::uint16_t> & regs = lanes[group[k]]->cpu->registers;
+        registers[LANE_B][k] = regs[CPU::BC] & 0xFF;
+        registers[LANE_C][k] = regs[CPU::BC] >> 8;
+        registers[LANE_D][k] = regs[CPU::DE] & 0xFF;
+        registers[LANE_E][k] = regs[CPU::DE] >> 8;
+        registers[LANE_H][k] = regs[CPU::HL] & 0xFF;
+        registers[LANE_L][k] = regs[CPU::HL] >> 8;
+        registers[LANE_A][k] = regs[CPU::AF] & 0xFF;
+        registers[LANE_F][k] = regs[CPU::AF] >> 8;
+    }
+
+    uint8_t * a = registers[LANE_A].data();
+    uint8_t * f = registers[LANE_F].data();
+    uint8_t * reg1 = registers[OPCODE_REGISTERS[(opcode >> 3) & 0x07]].data();
+    const uint8_t * reg2 = registers[OPCODE_REGISTERS[opcode & 0x07]].data();
+
+    // Same results and ticks as the CPU's own opcode methods, including ADD A, X taking 8
+    uint8_t ticks = 4;
+    if (opcode == 0x00)
+    {   // NOP
+    }
+    else if (opcode < 0x40 && (opcode & 0x07) == 4)
+    {   // INC X
+        for (size_t k = 0; k < n; k++)
+        {
+            const uint8_t val = reg1[k];
+            const uint8_t result = val + 1;
+            f[k] = (f[k] & 0x1F) | zeroFlag(result) | (((val & 0x0F) == 0x0F) ? 0x20 : 0x00);
+            reg1[k] = result;
+        }
+    }
+    else if (opcode < 0x40)
+    {   // DEC X
+        for (size_t k = 0; k < n; k++)
+        {
+            const uint8_t val = reg1[k];
+            const uint8_t result = val - 1;
+            f[k] = (f[k] & 0x1F) | zeroFlag(result) | 0x40 | (((val & 0x0F) == 0x00) ? 0x20 : 0x00);
+            reg1[k] = result;
+        }
+    }
+    else if (opcode < 0x80)
+    {   // LD X, Y
+        for (size_t k = 0; k < n; k++)
+        {
+            reg1[k] = reg2[k];
+        }
+    }
+    else
+    {
+        switch ((opcode >> 3) & 0x07)
+        {
+        case 0: // ADD A, X
+            ticks = 8;
+            for (size_t k = 0; k < n; k++)
+            {
+                const uint8_t val_a = a[k], val = reg2[k];
+                const uint8_t result = val_a + val;
+                f[k] = (f[k] & 0x0F) | zeroFlag(result)
+                    | ((((val_a & 0x0F) + (val & 0x0F)) > 0x0F) ? 0x20 : 0x00)
+                    | (((val_a + val) > 0xFF) ? 0x10 : 0x00);
+                a[k] = result;
+            }
+            break;
+
+        case 2: // SUB X
+        case 7: // CP X
+            for (size_t k = 0; k < n; k++)
+            {
+                const uint8_t val_a = a[k], val = reg2[k];
+                const uint8_t result = val_a - val;
+                f[k] = (f[k] & 0x0F) | zeroFlag(result) | 0x40
+                    | (((val_a & 0x0F) < (val & 0x0F)) ? 0x20 : 0x00)
+                    | ((val_a < val) ? 0x10 : 0x00);
+                a[k] = (opcode < 0xB8) ? result : val_a;
+            }
+            break;
+
+        case 4: // AND X
+            for (size_t k = 0; k < n; k++)
+            {
+                const uint8_t result = a[k] & reg2[k];
+                f[k] = (f[k] & 0x0F) | zeroFlag(result) | 0x20;
+                a[k] = result;
+            }
+            break;
+
+        case 5: // XOR X
+            for (size_t k = 0; k < n; k++)
+            {
+                const uint8_t result = a[k] ^ reg2[k];
+                f[k] = (f[k] & 0x0F) | zeroFlag(result);
+                a[k] = result;
+            }
+            break;
+
+        case 6: // OR X
+            for (size_t k = 0; k < n; k++)
+            {
+                const uint8_t result = a[k] | reg2[k];
+                f[k] = (f[k] & 0x0F) | zeroFlag(result);
+                a[k] = result;
+            }
+            break;
+        }
+    }
+
+    for (size_t k = 0; k < n; k++)
+    {
+        std::vector<std::uint16_t> & regs = lanes[group[k]]->cpu->registers;
+        regs[CPU::BC] = registers[LANE_B][k] | (registers[LANE_C][k] << 8);
+        regs[CPU::DE] = registers[LANE_D][k] | (registers[LANE_E][k] << 8);
+        regs[CPU::HL] = registers[LANE_H][k] | (registers[LANE_L][k] << 8);
+        regs[CPU::AF] = registers[LANE_A][k] | (registers[LANE_F][k] << 8);
+        regs[CPU::PC]++;
+
+        ticks_ran[group[k]] += ticks;
+    }
+    num_grouped += n;
+}
+
+// Lanes coming out of a HALT bug, in the BIOS or logging every instruction need the CPU's own code
+bool BatchInterpreter::canGroup(const size_t & lane) const
+{
+    const CPU & cpu = *lanes[lane]->cpu;
+    const CartridgeReader & cartridge = *cpu.memory->cartridgeReader;
+
+    return !cpu.halt_do_not_increment_pc
+        && !(cartridge.has_bios && cartridge.is_in_bios)
+        && !cpu.logger->should_log(spdlog::level::trace);
+}
@@ -0,0 +1,62 @@
+#ifndef BATCH_INTERPRETER_H
+#define BATCH_INTERPRETER_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "GBCEmulator.h"
+
+#define BATCH_LANE_REGISTERS    8   // B, C, D, E, H, L, A, F
+#define BATCH_MIN_GROUP_SIZE    2   // Fewer lanes than this on an opcode run it one by one
+
+// Experimental core running many emulators ("lanes") of the same ROM one instruction at a time.
+// Every step fetches an opcode for each lane, groups the lanes by the opcode they fetched, and runs
+// register only opcodes (LD r,r', ALU A,r, INC r, DEC r, NOP) for a whole group at once on
+// structure of arrays copies of their registers, in loops the compiler can vectorize.
+// Anything else, lanes on their own and lanes in the BIOS or being traced run on their own CPU.
+// The APU, GPU and timer of each lane still run one lane at a time.
+// Lanes end up exactly where the same number of runFrame() calls on their own would leave them
+class BatchInterpreter
+{
+public:
+    // Lanes run headless, as fast as they can and without audio, each logging to
+    // '<rom_path>.lane<index>.log'. Throws if the ROM can't be read
+    BatchInterpreter(const std::string & rom_path, const size_t & num_lanes);
+    virtual ~BatchInterpreter() = default;
+
+    // Same as runFrame() on every lane
+    void runFrames(const uint32_t & frames);
+
+    size_t getNumLanes() const;
+    std::shared_ptr<GBCEmulator> getLane(const size_t & index) const;
+
+    // Instructions run by all lanes, in groups and one by one
+    uint64_t getNumGrouped() const;
+    uint64_t getNumScalar() const;
+
+private:
+    void step();
+    void runGroup(const uint8_t & opcode, const std::vector<size_t> & group);
+    bool canGroup(const size_t & lane) const;
+
+    std::vector<std::shared_ptr<GBCEmulator>> lanes;
+
+    // Lanes still running the current frame, and how many instructions they've run of it
+    std::vector<size_t> active_lanes;
+    std::vector<uint64_t> frame_instructions;
+
+    // Per step
+    std::vector<uint8_t> ticks_ran;
+    std::array<std::vector<size_t>, 0x100> groups;
+    std::vector<uint8_t> group_opcodes;
+
+    // Registers of the group being run, one array per register
+    std::array<std::vector<uint8_t>, BATCH_LANE_REGISTERS> registers;
+
+    uint64_t num_grouped;
+    uint64_t num_scalar;
+};
+
+#endif // BATCH_INTERPRETER_H
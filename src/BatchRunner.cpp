@@ -0,0 +1,386 @@
+#ifdef _WIN32
+#include "stdafx.h"
+#endif // _WIN32
+
+#include "BatchRunner.h"
+#include "GBCEmulator.h"
+#include "InputSource.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+namespace
+{
+    std::string escapeJSON(const std::string & text)
+    {
+        std::string escaped;
+        for (const char c : text)
+        {
+            switch (c)
+            {
+            case '"':  escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n";  break;
+            case '\r': escaped += "\\r";  break;
+            case '\t': escaped += "\\t";  break;
+            default:
+                if (static_cast<uint8_t>(c) < 0x20 || static_cast<uint8_t>(c) >= 0x7F)
+                {   // Serial output is raw bytes, keep the report plain ASCII
+                    char code[8];
+                    snprintf(code, sizeof(code), "\\u%04x", static_cast<uint8_t>(c));
+                    escaped += code;
+                }
+                else
+                {
+                    escaped += c;
+                }
+            }
+        }
+        return escaped;
+    }
+
+    std::string escapeCSV(const std::string & text)
+    {
+        std::string escaped = "\"";
+        for (const char c : text)
+        {
+            escaped += c;
+            if (c == '"')
+            {
+                escaped += '"';
+            }
+        }
+        return escaped + "\"";
+    }
+
+    bool parseButton(const std::string & name, Joypad::BUTTON & button)
+    {
+        if      (name == "RIGHT")   button = Joypad::BUTTON::RIGHT;
+        else if (name == "LEFT")    button = Joypad::BUTTON::LEFT;
+        else if (name == "UP")      button = Joypad::BUTTON::UP;
+        else if (name == "DOWN")    button = Joypad::BUTTON::DOWN;
+        else if (name == "A")       button = Joypad::BUTTON::A;
+        else if (name == "B")       button = Joypad::BUTTON::B;
+        else if (name == "SELECT")  button = Joypad::BUTTON::SELECT;
+        else if (name == "START")   button = Joypad::BUTTON::START;
+        else return false;
+
+        return true;
+    }
+
+    std::filesystem::path resolvePath(const std::filesystem::path & base_dir, const std::string & path)
+    {
+        const std::filesystem::path p(path);
+        return p.is_absolute() ? p : base_dir / p;
+    }
+}
+
+BatchRunner::BatchRunner(const BatchOutputs & _outputs, const std::filesystem::path & _output_dir, const size_t & num_threads)
+    : outputs(_outputs)
+    , output_dir(_output_dir)
+    , pool(num_threads)
+{
+
+}
+
+std::vector<BatchJob> BatchRunner::findJobs(const std::filesystem::path & dir, const uint32_t & frames)
+{
+    std::vector<BatchJob> jobs;
+
+    std::error_code ec;
+    for (auto it = std::filesystem::recursive_directory_iterator(dir, ec);
+        it != std::filesystem::recursive_directory_iterator();
+        it.increment(ec))
+    {
+        if (ec)
+        {
+            break;
+        }
+
+        std::string extension = it->path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        if (it->is_regular_file() && (extension == ".gb" || extension == ".gbc"))
+        {
+            jobs.push_back({ it->path(), frames, {} });
+        }
+    }
+
+    std::sort(jobs.begin(), jobs.end(), [](const BatchJob & a, const BatchJob & b)
+    {
+        return a.rom_path < b.rom_path;
+    });
+    return jobs;
+}
+
+bool BatchRunner::readManifest(const std::filesystem::path & path, const uint32_t & default_frames,
+    std::vector<BatchJob> & jobs, std::string & error)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        error = "Could not open manifest " + path.string();
+        return false;
+    }
+
+    const std::filesystem::path base_dir = path.parent_path();
+    std::string line;
+    for (size_t line_number = 1; std::getline(file, line); line_number++)
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        std::vector<std::string> fields;
+        std::istringstream fields_stream(line);
+        std::string field;
+        while (std::getline(fields_stream, field, '\t'))
+        {
+            fields.push_back(field);
+        }
+
+        if (fields[0].empty())
+        {
+            error = path.string() + ":" + std::to_string(line_number) + ": missing ROM path";
+            return false;
+        }
+
+        BatchJob job = { resolvePath(base_dir, fields[0]), default_frames, {} };
+        if (fields.size() > 1 && !fields[1].empty())
+        {
+            char * end = nullptr;
+            const unsigned long frames = std::strtoul(fields[1].c_str(), &end, 10);
+            if (*end != '\0' || frames == 0)
+            {
+                error = path.string() + ":" + std::to_string(line_number) + ": bad frame count '" + fields[1] + "'";
+                return false;
+            }
+            job.frames = static_cast<uint32_t>(frames);
+        }
+        if (fields.size() > 2 && !fields[2].empty())
+        {
+            job.movie_path = resolvePath(base_dir, fields[2]);
+        }
+
+        jobs.push_back(job);
+    }
+
+    return true;
+}
+
+bool BatchRunner::readMovie(const std::filesystem::path & path, std::vector<uint8_t> & joypad_states, std::string & error)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        error = "Could not open movie " + path.string();
+        return false;
+    }
+
+    joypad_states.clear();
+    std::string line;
+    for (size_t line_number = 1; std::getline(file, line); line_number++)
+    {
+        std::istringstream line_stream(line);
+        uint32_t frames = 0;
+        std::string buttons;
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        if (!(line_stream >> frames >> buttons))
+        {
+            error = path.string() + ":" + std::to_string(line_number) + ": expected '<frames> <buttons>'";
+            return false;
+        }
+
+        uint8_t state = INPUT_NO_BUTTONS;
+        if (buttons != "-")
+        {
+            std::istringstream buttons_stream(buttons);
+            std::string name;
+            while (std::getline(buttons_stream, name, '+'))
+            {
+                Joypad::BUTTON button;
+                if (!parseButton(name, button))
+                {
+                    error = path.string() + ":" + std::to_string(line_number) + ": unknown button '" + name + "'";
+                    return false;
+                }
+                state &= static_cast<uint8_t>(~Joypad::getButtonBit(button));
+            }
+        }
+
+        joypad_states.insert(joypad_states.end(), frames, state);
+    }
+
+    return true;
+}
+
+std::vector<BatchResult> BatchRunner::run(const std::vector<BatchJob> & jobs)
+{
+    std::vector<BatchResult> results(jobs.size());
+
+    // Longest first, so a long job isn't the last one started
+    std::vector<size_t> order(jobs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&jobs](const size_t & a, const size_t & b)
+    {
+        return jobs[a].frames > jobs[b].frames;
+    });
+
+    for (const size_t & index : order)
+    {   // Every job has its own result, nothing is shared between them
+        pool.submit([this, &jobs, &results, index]()
+        {
+            results[index] = runJob(jobs[index], index);
+        });
+    }
+    pool.wait();
+
+    return results;
+}
+
+BatchResult BatchRunner::runJob(const BatchJob & job, const size_t & index) const
+{
+    const auto start_time = std::chrono::steady_clock::now();
+
+    BatchResult result = {};
+    result.rom_path = job.rom_path;
+    result.ok = false;
+
+    std::vector<uint8_t> movie;
+    if (!job.movie_path.empty() && !readMovie(job.movie_path, movie, result.error))
+    {
+        return result;
+    }
+
+    const std::string name = job.rom_path.stem().string() + "_" + std::to_string(index);
+    try
+    {
+        GBCEmulator emu(job.rom_path.string(), (output_dir / (name + ".log")).string(), "", false, false, false, false);
+        emu.runWithoutSleep = true;
+        emu.get_APU()->setSilentMode(true);
+
+        std::shared_ptr<Joypad> joypad = emu.get_Joypad();
+        uint8_t joypad_state = INPUT_NO_BUTTONS;
+        for (uint32_t frame = 0; frame < job.frames; frame++)
+        {
+            const uint8_t next_state = (frame < movie.size()) ? movie[frame] : INPUT_NO_BUTTONS;
+            joypad->updateButtons(joypad_state, next_state);
+            joypad_state = next_state;
+
+            emu.runFrame();
+            result.frames_run++;
+        }
+
+        if (outputs.frame_hash)
+        {
+            result.frame_hash = GBCEmulator::calculateFrameHash(emu.getFrame());
+        }
+
+        if (outputs.png)
+        {
+            result.png_path = output_dir / (name + ".png");
+            emu.saveFrameToPNG(result.png_path);
+        }
+
+        if (outputs.serial)
+        {
+            result.serial_output = emu.getSerialOutput();
+        }
+
+        if (outputs.ram)
+        {
+            const std::vector<uint8_t> memory_map = emu.get_memory_map();
+            result.ram_path = output_dir / (name + ".ram");
+
+            std::ofstream ram_file(result.ram_path, std::ios::binary);
+            ram_file.write(reinterpret_cast<const char *>(memory_map.data()), memory_map.size());
+            if (!ram_file)
+            {
+                throw std::runtime_error("Could not write " + result.ram_path.string());
+            }
+        }
+
+        result.ok = true;
+    }
+    catch (const std::exception & e)
+    {
+        result.error = e.what();
+    }
+
+    result.run_time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+    return result;
+}
+
+bool BatchRunner::writeJSONReport(const std::filesystem::path & path, const std::vector<BatchResult> & results)
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+
+    file << "[\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BatchResult & result = results[i];
+        file << "  {\"rom\": \"" << escapeJSON(result.rom_path.string()) << "\""
+             << ", \"ok\": " << (result.ok ? "true" : "false")
+             << ", \"error\": \"" << escapeJSON(result.error) << "\""
+             << ", \"frames\": " << result.frames_run
+             << ", \"frame_hash\": \"" << result.frame_hash << "\""  // Doesn't fit in a double
+             << ", \"serial\": \"" << escapeJSON(result.serial_output) << "\""
+             << ", \"png\": \"" << escapeJSON(result.png_path.string()) << "\""
+             << ", \"ram\": \"" << escapeJSON(result.ram_path.string()) << "\""
+             << ", \"time_ms\": " << result.run_time_ms
+             << "}" << ((i + 1 < results.size()) ? "," : "") << "\n";
+    }
+    file << "]\n";
+
+    return static_cast<bool>(file);
+}
+
+bool BatchRunner::writeCSVReport(const std::filesystem::path & path, const std::vector<BatchResult> & results)
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+
+    file << "rom,ok,error,frames,frame_hash,serial,png,ram,time_ms\n";
+    for (const BatchResult & result : results)
+    {
+        file << escapeCSV(result.rom_path.string()) << ","
+             << (result.ok ? "true" : "false") << ","
+             << escapeCSV(result.error) << ","
+             << result.frames_run << ","
+             << result.frame_hash << ","
+             << escapeCSV(result.serial_output) << ","
+             << escapeCSV(result.png_path.string()) << ","
+             << escapeCSV(result.ram_path.string()) << ","
+             << result.run_time_ms << "\n";
+    }
+
+    return static_cast<bool>(file);
+}
+
+size_t BatchRunner::getNumThreads() const
+{
+    return pool.getNumThreads();
+}
+
+uint64_t BatchRunner::getNumSteals() const
+{
+    return pool.getNumSteals();
+}
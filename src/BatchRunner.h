@@ -0,0 +1,76 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "WorkStealingPool.h"
+
+#define BATCH_DEFAULT_FRAMES 600    // 10 seconds of emulated time
+
+// What's kept from each job once it has run all its frames
+struct BatchOutputs
+{
+    bool frame_hash;
+    bool png;
+    bool serial;    // Bytes the ROM sent out over the link cable
+    bool ram;       // Memory map, 0x0000 - 0xFFFE
+};
+
+struct BatchJob
+{
+    std::filesystem::path rom_path;
+    uint32_t frames;
+    std::filesystem::path movie_path;   // Empty for no buttons
+};
+
+struct BatchResult
+{
+    std::filesystem::path rom_path;
+    bool ok;
+    std::string error;
+    uint32_t frames_run;
+    uint64_t frame_hash;
+    std::string serial_output;
+    std::filesystem::path png_path;
+    std::filesystem::path ram_path;
+    double run_time_ms;
+};
+
+// Runs many ROMs headless at once, one emulator per job, across a work stealing pool.
+// Each job runs as fast as it can from power on, with no audio, for its number of frames
+class BatchRunner
+{
+public:
+    // Files are written to 'output_dir'. 0 threads is one per hardware thread
+    BatchRunner(const BatchOutputs & outputs, const std::filesystem::path & output_dir, const size_t & num_threads = 0);
+
+    // A job for every .gb and .gbc file under 'dir', sorted by path
+    static std::vector<BatchJob> findJobs(const std::filesystem::path & dir, const uint32_t & frames);
+    // One job per line, the ROM then optionally a frame count and an input movie, separated by tabs.
+    // Blank lines and lines starting with '#' are skipped, relative paths are from the manifest's directory
+    static bool readManifest(const std::filesystem::path & path, const uint32_t & default_frames,
+        std::vector<BatchJob> & jobs, std::string & error);
+    // One line per stretch of frames, '<frames> <buttons>', with the buttons held joined by '+'
+    // or '-' for none, e.g. '30 A+RIGHT'. Nothing is held once the movie runs out
+    static bool readMovie(const std::filesystem::path & path, std::vector<uint8_t> & joypad_states, std::string & error);
+
+    // Results are in the same order as 'jobs'
+    std::vector<BatchResult> run(const std::vector<BatchJob> & jobs);
+    // 'index' keeps the files of jobs for the same ROM apart
+    BatchResult runJob(const BatchJob & job, const size_t & index) const;
+
+    static bool writeJSONReport(const std::filesystem::path & path, const std::vector<BatchResult> & results);
+    static bool writeCSVReport(const std::filesystem::path & path, const std::vector<BatchResult> & results);
+
+    size_t getNumThreads() const;
+    uint64_t getNumSteals() const;
+
+private:
+    BatchOutputs outputs;
+    std::filesystem::path output_dir;
+    WorkStealingPool pool;
+};
+
+#endif // BATCH_RUNNER_H
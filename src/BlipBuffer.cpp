@@ -0,0 +1,143 @@
+#ifdef _WIN32
+#include "stdafx.h"
+#endif // _WIN32
+
+#include "BlipBuffer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#define BLIP_PI 3.14159265358979323846
+#define BLIP_CUTOFF 0.9     // Fraction of the output Nyquist frequency kept
+
+BlipBuffer::BlipBuffer(const size_t & max_samples)
+    : buffer(max_samples + BLIP_KERNEL_SIZE + 1, 0.0f)
+    , factor(0)
+    , offset(0)
+    , integrator(0.0f)
+{
+
+}
+
+BlipBuffer::~BlipBuffer()
+{
+
+}
+
+void BlipBuffer::setRates(const double & clock_rate, const double & sample_rate)
+{
+    factor = static_cast<uint64_t>(std::ceil((sample_rate / clock_rate) * static_cast<double>(1ull << BLIP_FRAC_BITS)));
+}
+
+void BlipBuffer::clear()
+{
+    std::fill(buffer.begin(), buffer.end(), 0.0f);
+    offset = 0;
+    integrator = 0.0f;
+}
+
+void BlipBuffer::addDelta(const uint32_t & time, const int32_t & delta)
+{
+    const uint64_t position = offset + (static_cast<uint64_t>(time) * factor);
+    const size_t index = static_cast<size_t>(position >> BLIP_FRAC_BITS);
+    const size_t phase = static_cast<size_t>(position >> (BLIP_FRAC_BITS - BLIP_PHASE_BITS)) & (BLIP_NUM_PHASES - 1);
+
+    if (index + BLIP_KERNEL_SIZE > buffer.size())
+    {   // Caller ran more clocks than the buffer can hold
+        return;
+    }
+
+    const std::array<float, BLIP_KERNEL_SIZE> & taps = getKernel()[phase];
+    float * out = &buffer[index];
+    const float delta_f = static_cast<float>(delta);
+    for (size_t i = 0; i < BLIP_KERNEL_SIZE; i++)
+    {
+        out[i] += taps[i] * delta_f;
+    }
+}
+
+void BlipBuffer::endFrame(const uint32_t & time)
+{
+    offset += static_cast<uint64_t>(time) * factor;
+}
+
+size_t BlipBuffer::samplesAvailable() const
+{
+    return std::min(static_cast<size_t>(offset >> BLIP_FRAC_BITS), buffer.size() - BLIP_KERNEL_SIZE - 1);
+}
+
+uint32_t BlipBuffer::clocksNeeded(const size_t & samples) const
+{
+    const uint64_t needed = static_cast<uint64_t>(samples) << BLIP_FRAC_BITS;
+    if (needed <= offset ||
+        factor == 0)
+    {
+        return 0;
+    }
+
+    return static_cast<uint32_t>((needed - offset + factor - 1) / factor);
+}
+
+size_t BlipBuffer::readSamples(float * out, const size_t & count)
+{
+    const size_t num_samples = std::min(count, samplesAvailable());
+
+    // Integrate the deltas back into amplitudes, slowly leaking towards 0
+    for (size_t i = 0; i < num_samples; i++)
+    {
+        integrator += buffer[i];
+        out[i] = integrator;
+        integrator -= integrator * BLIP_HIGH_PASS;
+    }
+
+    // Move samples still being built to the front of the buffer
+    const size_t remaining = buffer.size() - num_samples;
+    std::memmove(buffer.data(), buffer.data() + num_samples, remaining * sizeof(float));
+    std::fill(buffer.begin() + remaining, buffer.end(), 0.0f);
+
+    offset -= static_cast<uint64_t>(num_samples) << BLIP_FRAC_BITS;
+
+    return num_samples;
+}
+
+// Band-limited impulse, one set of taps per fractional sample position.
+// Each set sums to 1 so a step of 'delta' always integrates to exactly 'delta'
+const BlipBuffer::Kernel & BlipBuffer::getKernel()
+{
+    static const Kernel kernel = []()
+    {
+        Kernel k;
+        const double half_size = BLIP_KERNEL_SIZE / 2.0;
+
+        for (size_t phase = 0; phase < BLIP_NUM_PHASES; phase++)
+        {
+            const double fraction = static_cast<double>(phase) / BLIP_NUM_PHASES;
+            double sum = 0.0;
+
+            for (size_t i = 0; i < BLIP_KERNEL_SIZE; i++)
+            {
+                // Distance from the step, kernel is centered between taps 7 and 8
+                const double x = (static_cast<double>(i) + 0.5 - half_size) - (fraction - 0.5);
+                const double sinc_x = BLIP_CUTOFF * x * BLIP_PI;
+                const double sinc = (sinc_x == 0.0) ? 1.0 : std::sin(sinc_x) / sinc_x;
+
+                // Blackman window over the kernel
+                const double w = (x + half_size) / BLIP_KERNEL_SIZE;
+                const double window = (w <= 0.0 || w >= 1.0) ? 0.0 :
+                    0.42 - (0.5 * std::cos(2.0 * BLIP_PI * w)) + (0.08 * std::cos(4.0 * BLIP_PI * w));
+
+                k[phase][i] = static_cast<float>(sinc * window);
+                sum += sinc * window;
+            }
+
+            for (size_t i = 0; i < BLIP_KERNEL_SIZE; i++)
+            {
+                k[phase][i] = static_cast<float>(k[phase][i] / sum);
+            }
+        }
+
+        return k;
+    }();
+
+    return kernel;
+}
@@ -0,0 +1,48 @@
+#ifndef BLIP_BUFFER_H
+#define BLIP_BUFFER_H
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#define BLIP_PHASE_BITS 5
+#define BLIP_NUM_PHASES (1 << BLIP_PHASE_BITS)
+#define BLIP_KERNEL_SIZE 16
+#define BLIP_FRAC_BITS 32
+#define BLIP_HIGH_PASS (1.0f / 512.0f)     // ~14 Hz at 44.1 kHz, removes DC like the GB's output capacitor
+
+// Band-limited step buffer.
+// Amplitude changes are added as deltas at the clock they happen, each delta is spread
+// over BLIP_KERNEL_SIZE output samples by a windowed sinc so the output doesn't alias.
+// Clocks are converted to output samples with a fixed point ratio, so any clock
+// rate can be resampled to any output rate without drifting.
+class BlipBuffer
+{
+public:
+    BlipBuffer(const size_t & max_samples);
+    virtual ~BlipBuffer();
+
+    void setRates(const double & clock_rate, const double & sample_rate);
+    void clear();
+
+    // 'time' is in clocks since the last endFrame()
+    void addDelta(const uint32_t & time, const int32_t & delta);
+    // Makes all samples up to 'time' available for reading
+    void endFrame(const uint32_t & time);
+
+    size_t samplesAvailable() const;
+    uint32_t clocksNeeded(const size_t & samples) const;
+    size_t readSamples(float * out, const size_t & count);
+
+private:
+    typedef std::array<std::array<float, BLIP_KERNEL_SIZE>, BLIP_NUM_PHASES> Kernel;
+    static const Kernel & getKernel();
+
+    std::vector<float> buffer;
+    uint64_t factor;        // Output samples per clock, 32.32 fixed point
+    uint64_t offset;        // Output sample position of the frame start, 32.32 fixed point
+    float integrator;
+};
+
+#endif // BLIP_BUFFER_H
@@ -0,0 +1,139 @@
+#ifdef _WIN32
+#include "stdafx.h"
+#endif // _WIN32
+
+#include "BootStateCache.h"
+#include "SaveState.h"
+#include <cinttypes>
+#include <cstdio>
+
+namespace
+{
+    // FNV-1a
+    uint64_t hashBytes(uint64_t hash, const unsigned char * data, const size_t & size)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= data[i];
+            hash *= 0x100000001B3;
+        }
+        return hash;
+    }
+}
+
+BootStateCache::BootStateCache()
+    : enabled(true)
+{
+
+}
+
+BootStateCache::~BootStateCache()
+{
+
+}
+
+std::shared_ptr<BootStateCache> BootStateCache::getDefault()
+{
+    static std::shared_ptr<BootStateCache> cache = std::make_shared<BootStateCache>();
+    return cache;
+}
+
+uint64_t BootStateCache::makeKey(const std::vector<unsigned char> & bios, const std::vector<unsigned char> & rom_bank_0,
+    const bool & is_color_gb)
+{
+    uint64_t hash = hashBytes(0xCBF29CE484222325, bios.data(), bios.size());
+    if (rom_bank_0.size() >= BOOT_STATE_HEADER_END)
+    {
+        hash = hashBytes(hash, rom_bank_0.data() + BOOT_STATE_HEADER_START, BOOT_STATE_HEADER_END - BOOT_STATE_HEADER_START);
+    }
+
+    // A CGB boot ROM runs DMG cartridges differently when they're forced into CGB mode
+    const unsigned char mode = is_color_gb;
+    return hashBytes(hash, &mode, 1);
+}
+
+void BootStateCache::setDirectory(const std::filesystem::path & directory)
+{
+    std::lock_guard<std::mutex> lg(mutex);
+    this->directory = directory;
+}
+
+std::filesystem::path BootStateCache::getDirectory() const
+{
+    std::lock_guard<std::mutex> lg(mutex);
+    return directory;
+}
+
+void BootStateCache::setEnabled(const bool & enable)
+{
+    std::lock_guard<std::mutex> lg(mutex);
+    enabled = enable;
+}
+
+bool BootStateCache::isEnabled() const
+{
+    std::lock_guard<std::mutex> lg(mutex);
+    return enabled;
+}
+
+bool BootStateCache::find(const uint64_t & key, std::vector<uint8_t> & state)
+{
+    std::lock_guard<std::mutex> lg(mutex);
+    if (!enabled)
+    {
+        return false;
+    }
+
+    auto found = states.find(key);
+    if (found == states.end())
+    {   // Left by an earlier run
+        if (directory.empty() ||
+            !readSaveStateFile(getPath(key), state))
+        {
+            return false;
+        }
+        found = states.emplace(key, state).first;
+    }
+
+    state = found->second;
+    return true;
+}
+
+// Returns false if the state couldn't be written to the directory, it's still kept in memory
+bool BootStateCache::insert(const uint64_t & key, const std::vector<uint8_t> & state)
+{
+    std::lock_guard<std::mutex> lg(mutex);
+    if (!enabled)
+    {
+        return true;
+    }
+
+    states[key] = state;
+    if (directory.empty())
+    {
+        return true;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    return writeSaveStateFile(getPath(key), state);
+}
+
+void BootStateCache::clear()
+{
+    std::lock_guard<std::mutex> lg(mutex);
+    states.clear();
+}
+
+size_t BootStateCache::size() const
+{
+    std::lock_guard<std::mutex> lg(mutex);
+    return states.size();
+}
+
+std::filesystem::path BootStateCache::getPath(const uint64_t & key) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016" PRIx64, key);
+    return directory / (std::string(name) + BOOT_STATE_FILE_EXTENSION);
+}
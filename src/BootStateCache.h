@@ -0,0 +1,52 @@
+#ifndef BOOT_STATE_CACHE_H
+#define BOOT_STATE_CACHE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#define BOOT_STATE_HEADER_START 0x0104      // Logo, title, CGB flag and everything up to the
+#define BOOT_STATE_HEADER_END 0x0150        // global checksum, which save states are checked against
+#define BOOT_STATE_FILE_EXTENSION ".bootstate"
+
+// Machine state at the moment a boot ROM hands over to the cartridge, so later starts of a
+// cartridge with the same header through the same boot ROM skip straight to it.
+// Kept in memory, and in a directory as well if one is set. Safe to use from any thread
+class BootStateCache
+{
+public:
+    BootStateCache();
+    virtual ~BootStateCache();
+
+    // The one every emulator started with a boot ROM uses
+    static std::shared_ptr<BootStateCache> getDefault();
+    // Hash of the boot ROM and the header bytes of 'rom_bank_0' it reads
+    static uint64_t makeKey(const std::vector<unsigned char> & bios, const std::vector<unsigned char> & rom_bank_0,
+        const bool & is_color_gb);
+
+    // States are also read from and written to '<directory>/<key>.bootstate'. Empty for memory only
+    void setDirectory(const std::filesystem::path & directory);
+    std::filesystem::path getDirectory() const;
+    // While disabled the boot ROM always runs
+    void setEnabled(const bool & enable);
+    bool isEnabled() const;
+
+    bool find(const uint64_t & key, std::vector<uint8_t> & state);
+    bool insert(const uint64_t & key, const std::vector<uint8_t> & state);
+    // Only the states in memory, files are left
+    void clear();
+    size_t size() const;
+
+private:
+    std::filesystem::path getPath(const uint64_t & key) const;
+
+    mutable std::mutex mutex;
+    std::filesystem::path directory;
+    bool enabled;
+    std::unordered_map<uint64_t, std::vector<uint8_t>> states;
+};
+
+#endif // BOOT_STATE_CACHE_H
@@ -17,6 +17,7 @@ CPU::CPU(std::shared_ptr<spdlog::logger> _logger,
     memory(_memory)
 {
 	registers.resize(NUM_OF_REGISTERS);
+    instruction = 0;
 	interrupt_master_enable = false;
 	interrupts_enabled = false;
 	is_halted = false;
@@ -51,6 +52,28 @@ CPU& CPU::operator=(const CPU & rhs)
     return *this;
 }
 
+void CPU::saveState(StateWriter & state) const
+{
+    state.writeVector(registers);
+    state.write(instruction);
+    state.write(interrupt_master_enable);
+    state.write(interrupts_enabled);
+    state.write(is_halted);
+    state.write(halt_do_not_increment_pc);
+    state.write(is_stopped);
+}
+
+void CPU::loadState(StateReader & state)
+{
+    state.readVector(registers);
+    state.read(instruction);
+    state.read(interrupt_master_enable);
+    state.read(interrupts_enabled);
+    state.read(is_halted);
+    state.read(halt_do_not_increment_pc);
+    state.read(is_stopped);
+}
+
 uint8_t CPU::runNextInstruction()
 {
     uint8_t ticksRanInstr = 0;
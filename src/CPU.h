@@ -5,6 +5,7 @@
 #include <vector>
 #include <string>
 #include <spdlog/spdlog.h>
+#include "SaveState.h"
 
 #define CLOCK_SPEED         4 * 1024 * 1024 // 4 MHz/CPU cycles
 #define CLOCK_SPEED_GBC_MAX 8 * 1024 * 1024 // 8 MHz
@@ -12,9 +13,13 @@
 //#define ENABLE_DEBUG_PRINT
 
 class Memory;
+class BatchInterpreter;
 
 class CPU
 {
+    // Runs opcodes for groups of CPUs on copies of their registers
+    friend class BatchInterpreter;
+
 public:
     int NUM_OF_REGISTERS = 6;
 
@@ -50,6 +55,8 @@ public:
         bool provided_boot_rom = false);
     ~CPU();
     CPU& operator=(const CPU& rhs);
+    void saveState(StateWriter & state) const;
+    void loadState(StateReader & state);
 
     uint8_t runNextInstruction();
     uint8_t peekNextByte() const;
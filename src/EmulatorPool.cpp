@@ -0,0 +1,75 @@
+#ifdef _WIN32
+#include "stdafx.h"
+#endif // _WIN32
+
+#include "EmulatorPool.h"
+#include <algorithm>
+
+EmulatorPool::EmulatorPool(const std::string & bios_path)
+    : bios_path(bios_path)
+{
+
+}
+
+EmulatorPool::~EmulatorPool()
+{
+
+}
+
+std::shared_ptr<GBCEmulator> EmulatorPool::acquire(const std::string & rom_path)
+{
+    std::shared_ptr<ROM> rom = getROM(rom_path);
+
+    // clone() snapshots the source, so only one at a time
+    std::lock_guard<std::mutex> lg(rom->mutex);
+    if (!rom->source)
+    {
+        std::shared_ptr<GBCEmulator> source = std::make_shared<GBCEmulator>(rom_path,
+            rom_path + ".pool.log", bios_path, false, false, false, false);
+        source->runWithoutSleep = true;
+        source->get_APU()->setSilentMode(true);
+        rom->source = source;
+    }
+
+    return rom->source->clone();
+}
+
+void EmulatorPool::warm(const std::string & rom_path, const size_t & count)
+{
+    const size_t target = std::min<size_t>(count, CLONE_POOL_MAX_SIZE);
+
+    // All held at once so none of them are reused, then all discarded into the clone pool
+    std::vector<std::shared_ptr<GBCEmulator>> emulators;
+    while (getNumIdle(rom_path) + emulators.size() < target)
+    {
+        emulators.push_back(acquire(rom_path));
+    }
+}
+
+size_t EmulatorPool::getNumIdle(const std::string & rom_path) const
+{
+    std::shared_ptr<ROM> rom;
+    {
+        std::lock_guard<std::mutex> lg(mutex);
+        const auto found = roms.find(rom_path);
+        if (found == roms.end())
+        {
+            return 0;
+        }
+        rom = found->second;
+    }
+
+    std::lock_guard<std::mutex> lg(rom->mutex);
+    return rom->source ? rom->source->getNumIdleClones() : 0;
+}
+
+std::shared_ptr<EmulatorPool::ROM> EmulatorPool::getROM(const std::string & rom_path)
+{
+    std::lock_guard<std::mutex> lg(mutex);
+    std::shared_ptr<ROM> & rom = roms[rom_path];
+    if (!rom)
+    {
+        rom = std::make_shared<ROM>();
+    }
+    return rom;
+}
@@ -0,0 +1,41 @@
+#ifndef EMULATOR_POOL_H
+#define EMULATOR_POOL_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "GBCEmulator.h"
+
+// Hands out emulators at power on for any number of ROMs, headless, silent and running as fast as they can.
+// Each ROM is read once, into an emulator that never runs and is only cloned. Discarded emulators
+// go back to its clone pool, so once warmed up acquire() is a snapshot and restore.
+// Emulators handed out can outlive the pool, and each can run on its own thread
+class EmulatorPool
+{
+public:
+    // Every ROM is booted through 'bios_path' if it's given
+    EmulatorPool(const std::string & bios_path = "");
+    virtual ~EmulatorPool();
+
+    // Throws if the ROM can't be read. Safe to call from any thread
+    std::shared_ptr<GBCEmulator> acquire(const std::string & rom_path);
+    // Makes sure at least 'count' emulators for the ROM are waiting, no more than CLONE_POOL_MAX_SIZE
+    void warm(const std::string & rom_path, const size_t & count);
+    size_t getNumIdle(const std::string & rom_path) const;
+
+private:
+    struct ROM
+    {
+        std::mutex mutex;
+        std::shared_ptr<GBCEmulator> source;    // Loaded by the first acquire()
+    };
+
+    std::shared_ptr<ROM> getROM(const std::string & rom_path);
+
+    std::string bios_path;
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<ROM>> roms;
+};
+
+#endif // EMULATOR_POOL_H
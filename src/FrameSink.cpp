@@ -0,0 +1,50 @@
+#ifdef _WIN32
+#include "stdafx.h"
+#endif // _WIN32
+
+#include "FrameSink.h"
+#include <cstring>
+
+void NullFrameSink::frameReady(const SDL_Color *)
+{
+
+}
+
+MemoryFrameSink::MemoryFrameSink()
+    : frame()
+    , frame_count(0)
+{
+
+}
+
+void MemoryFrameSink::frameReady(const SDL_Color * new_frame)
+{
+    std::lock_guard<std::mutex> lg(mutex);
+    std::memcpy(frame.data(), new_frame, sizeof(SDL_Color) * SCREEN_PIXEL_TOTAL);
+    frame_count++;
+}
+
+uint64_t MemoryFrameSink::getFrame(std::array<SDL_Color, SCREEN_PIXEL_TOTAL> & out) const
+{
+    std::lock_guard<std::mutex> lg(mutex);
+    out = frame;
+    return frame_count;
+}
+
+uint64_t MemoryFrameSink::getFrameCount() const
+{
+    std::lock_guard<std::mutex> lg(mutex);
+    return frame_count;
+}
+
+CallbackFrameSink::CallbackFrameSink(std::function<void(std::array<SDL_Color, SCREEN_PIXEL_TOTAL> /* frame */)> function)
+    : function(function)
+{
+
+}
+
+void CallbackFrameSink::frameReady(const SDL_Color * new_frame)
+{
+    std::memcpy(frame.data(), new_frame, sizeof(SDL_Color) * SCREEN_PIXEL_TOTAL);
+    function(frame);
+}
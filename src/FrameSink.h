@@ -0,0 +1,59 @@
+#ifndef FRAME_SINK_H
+#define FRAME_SINK_H
+
+#include <GPU.h>
+#include <SDLTypes.h>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+// Where the emulator sends each finished frame, called on the emulator's thread.
+// 'frame' is SCREEN_PIXEL_TOTAL pixels and is only valid during the call
+class FrameSink
+{
+public:
+    virtual ~FrameSink() {}
+
+    virtual void frameReady(const SDL_Color * frame) = 0;
+};
+
+// Throws the frames away
+class NullFrameSink : public FrameSink
+{
+public:
+    void frameReady(const SDL_Color * frame);
+};
+
+// Keeps the newest frame for the caller to copy out
+class MemoryFrameSink : public FrameSink
+{
+public:
+    MemoryFrameSink();
+
+    void frameReady(const SDL_Color * frame);
+
+    // Copies the newest frame into 'out', returns the number of frames received
+    uint64_t getFrame(std::array<SDL_Color, SCREEN_PIXEL_TOTAL> & out) const;
+    uint64_t getFrameCount() const;
+
+private:
+    mutable std::mutex mutex;
+    std::array<SDL_Color, SCREEN_PIXEL_TOTAL> frame;
+    uint64_t frame_count;
+};
+
+// Hands a copy of each frame to a function, for GBCEmulator::setFrameUpdateMethod()
+class CallbackFrameSink : public FrameSink
+{
+public:
+    CallbackFrameSink(std::function<void(std::array<SDL_Color, SCREEN_PIXEL_TOTAL> /* frame */)> function);
+
+    void frameReady(const SDL_Color * frame);
+
+private:
+    std::function<void(std::array<SDL_Color, SCREEN_PIXEL_TOTAL> /* frame */)> function;
+    std::array<SDL_Color, SCREEN_PIXEL_TOTAL> frame;
+};
+
+#endif // FRAME_SINK_H
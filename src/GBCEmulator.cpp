@@ -1,20 +1,33 @@
 #include "GBCEmulator.h"
 #include <libpng16/png.h>
+#include <algorithm>
 #include <thread>
 
 GBCEmulator::GBCEmulator(const std::string romName, const std::string logName,
-    const std::string biosPath, bool debugMode, const bool force_cgb_mode)
+    const std::string biosPath, bool debugMode, const bool force_cgb_mode, const bool openAudioDevice,
+    const bool useSaveFiles)
     :   stopRunning(false),
         debugMode(false),
         ranInstruction(false),
         runWithoutSleep(false),
         logFileBaseName(logName),
-        frameIsUpdatedFunction(nullptr)
+        frameSink(nullptr),
+        inputSource(nullptr),
+        inputSourceState(INPUT_NO_BUTTONS),
+        rewinding(false),
+        rewindFramesPerSnapshot(REWIND_DEFAULT_FRAMES_PER_SNAPSHOT),
+        rewindFrameCounter(0),
+        runAheadTimeMicro(0),
+        runAheadFrames(0),
+        runningFrame(false),
+        bootStateKey(0),
+        isClone(false),
+        useSaveFiles(useSaveFiles)
 {
     init_logging(logName);
 
     cartridgeReader = std::make_shared<CartridgeReader>(std::make_shared<spdlog::logger>("CartridgeReader", loggerSink), force_cgb_mode);
-    apu     = std::make_shared<APU>(loggerSink, std::make_shared<spdlog::logger>("APU", loggerSink));
+    apu     = std::make_shared<APU>(loggerSink, std::make_shared<spdlog::logger>("APU", loggerSink), openAudioDevice);
     joypad  = std::make_shared<Joypad>(std::make_shared<spdlog::logger>("Joypad", loggerSink));
     serial_transfer = std::make_shared<SerialTransfer>(std::make_shared<spdlog::logger>("SerialTransfer", loggerSink));
 
@@ -37,13 +50,18 @@ GBCEmulator::GBCEmulator(const std::string romName, const std::string logName,
 
     // Read in game save (.sav) and RTC clock (.rtc) if available
     filenameNoExtension = romName.substr(0, romName.find_last_of("."));
-    mbc->loadSaveIntoRAM(filenameNoExtension + ".sav");
-    mbc->loadRTCIntoRAM(filenameNoExtension + ".rtc");
+    if (useSaveFiles)
+    {
+        mbc->loadSaveIntoRAM(filenameNoExtension + ".sav");
+        mbc->loadRTCIntoRAM(filenameNoExtension + ".rtc");
+    }
 
     // Calculate number of CPU cycles that can tick in one frame time
     ticksPerFrame = CLOCK_SPEED / SCREEN_FRAMERATE; // cycles per frame
     ticksAccumulated = 0;
+    emulationSpeed = 1.0;
     setTimePerFrame(1.0 / SCREEN_FRAMERATE);
+    frameTimeStart = getCurrentTime();
 
     // Set log levels
     set_logging_level(spdlog::level::err);
@@ -58,22 +76,107 @@ GBCEmulator::GBCEmulator(const std::string romName, const std::string logName,
     mbc->logger->set_level(spdlog::level::info);
     logger->set_level(spdlog::level::info);*/
     logCounter = 0;
+
+    if (cartridgeReader->has_bios)
+    {
+        loadBootState();
+    }
+
+    // For reset(), so it never has to read the ROM or save again
+    std::shared_ptr<std::vector<uint8_t>> state = std::make_shared<std::vector<uint8_t>>();
+    snapshot(*state);
+    powerOnState = state;
+}
+
+// Builds the components without reading anything from disk, restoring a
+// snapshot into it fills in the rest
+GBCEmulator::GBCEmulator(const GBCEmulator & source, const std::shared_ptr<GBCEmulatorPool> & pool)
+    :   stopRunning(false),
+        debugMode(source.debugMode),
+        ranInstruction(false),
+        runWithoutSleep(source.runWithoutSleep),
+        logFileBaseName(source.logFileBaseName),
+        frameSink(nullptr),
+        inputSource(nullptr),
+        inputSourceState(INPUT_NO_BUTTONS),
+        rewinding(false),
+        rewindFramesPerSnapshot(REWIND_DEFAULT_FRAMES_PER_SNAPSHOT),
+        rewindFrameCounter(0),
+        runAheadTimeMicro(0),
+        runAheadFrames(0),
+        runningFrame(false),
+        bootStateKey(0),
+        clonePool(pool),
+        isClone(true),
+        useSaveFiles(false)
+{
+    loggerSink = source.loggerSink;
+    logger = source.logger;
+    filenameNoExtension = source.filenameNoExtension;
+    powerOnState = source.powerOnState;
+
+    cartridgeReader = std::make_shared<CartridgeReader>(*source.cartridgeReader);
+    apu     = std::make_shared<APU>(loggerSink, source.apu->logger, false);
+    joypad  = std::make_shared<Joypad>(source.joypad->logger);
+    serial_transfer = std::make_shared<SerialTransfer>(std::make_shared<spdlog::logger>("SerialTransfer", loggerSink));
+
+    gpu = std::make_shared<GPU>(source.gpu->logger);
+    if (source.gpu->is_color_gb)
+    {
+        gpu->init_color_gb();
+    }
+    gpu->setPipelinedRendering(false);
+
+    // ROM banks are shared, Memory only makes its own if they're missing
+    mbc = std::make_shared<MBC>(cartridgeReader->getMBCNum(),
+        cartridgeReader->num_ROM_banks,
+        cartridgeReader->num_RAM_banks,
+        source.mbc->logger);
+    mbc->romBanks = source.mbc->romBanks;
+
+    memory = std::make_shared<Memory>(source.memory->logger,
+        cartridgeReader,
+        mbc,
+        gpu,
+        joypad,
+        apu,
+        serial_transfer,
+        source.gpu->is_color_gb);
+    gpu->memory = memory;
+
+    cpu = std::make_shared<CPU>(source.cpu->logger,
+        memory,
+        cartridgeReader->has_bios);
+
+    ticksPerFrame = source.ticksPerFrame;
+    ticksAccumulated = 0;
+    emulationSpeed = source.emulationSpeed;
+    timePerFrame = source.timePerFrame;
+    timePerFrameAt1x = source.timePerFrameAt1x;
+    frameTimeStart = getCurrentTime();
+    logCounter = 0;
 }
 
 GBCEmulator::~GBCEmulator()
 {
     logger->info("Destructing");
 
-    // Try to write out .sav file
-    mbc->saveRAMToFile(filenameNoExtension + ".sav");
+    if (useSaveFiles)
+    {   // Clones never do, they would overwrite the original's save
+        // Try to write out .sav file
+        mbc->saveRAMToFile(filenameNoExtension + ".sav");
 
-    // Try to write out .rtc file
-    mbc->latchCurrTimeToRTC();
-    mbc->saveRTCToFile(filenameNoExtension + ".rtc");
+        // Try to write out .rtc file
+        mbc->latchCurrTimeToRTC();
+        mbc->saveRTCToFile(filenameNoExtension + ".rtc");
+    }
 
-    // Write out last frame hash
-    uint64_t lastFrameHash = calculateFrameHash(gpu->curr_frame);
-    logger->info("Last frame hash: {}", lastFrameHash);
+    if (!isClone)
+    {
+        // Write out last frame hash
+        uint64_t lastFrameHash = calculateFrameHash(gpu->curr_frame);
+        logger->info("Last frame hash: {}", lastFrameHash);
+    }
 
     cpu->memory->reset();
     cpu.reset();
@@ -105,11 +208,409 @@ GBCEmulator& GBCEmulator::operator=(const GBCEmulator& rhs)
     ticksAccumulated = rhs.ticksAccumulated;
     frameTimeStart  = rhs.frameTimeStart;
     timePerFrame    = rhs.timePerFrame;
-    frameIsUpdatedFunction = rhs.frameIsUpdatedFunction;
+    timePerFrameAt1x = rhs.timePerFrameAt1x;
+    emulationSpeed  = rhs.emulationSpeed;
+    frameSink       = rhs.frameSink;
 
     return *this;
 }
 
+std::shared_ptr<GBCEmulator> GBCEmulator::clone()
+{
+    std::shared_ptr<GBCEmulatorPool> pool = clonePool.lock();
+    if (!pool)
+    {   // First clone of this emulator
+        pool = std::make_shared<GBCEmulatorPool>();
+        ownedClonePool = pool;
+        clonePool = pool;
+    }
+
+    std::unique_ptr<GBCEmulator> instance;
+    {
+        std::lock_guard<std::mutex> lg(pool->mutex);
+        if (!pool->instances.empty())
+        {
+            instance = std::move(pool->instances.back());
+            pool->instances.pop_back();
+        }
+    }
+
+    if (!instance)
+    {
+        instance.reset(new GBCEmulator(*this, pool));
+    }
+
+    snapshot(cloneState);
+    instance->restoreOwnState(cloneState);
+
+    // Settings from whoever used the instance last
+    instance->stopRunning = false;
+    instance->runWithoutSleep = runWithoutSleep;
+    instance->frameSink = nullptr;
+    instance->inputSource = nullptr;
+    instance->inputSourceState = INPUT_NO_BUTTONS;
+    instance->serial_transfer->clearSentBytes();
+    instance->setRewindEnabled(false);
+    instance->setRunAheadFrames(0);
+    instance->setEmulationSpeed(emulationSpeed);
+    instance->apu->setSilentMode(apu->isSilentMode());
+
+    // Discarded clones go back in the pool rather than being freed
+    return std::shared_ptr<GBCEmulator>(instance.release(), [pool](GBCEmulator * emulator)
+    {
+        std::unique_ptr<GBCEmulator> discarded(emulator);
+
+        std::lock_guard<std::mutex> lg(pool->mutex);
+        if (pool->instances.size() < CLONE_POOL_MAX_SIZE)
+        {
+            pool->instances.push_back(std::move(discarded));
+        }
+    });
+}
+
+size_t GBCEmulator::getNumIdleClones() const
+{
+    std::shared_ptr<GBCEmulatorPool> pool = clonePool.lock();
+    if (!pool)
+    {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lg(pool->mutex);
+    return pool->instances.size();
+}
+
+void GBCEmulator::reset()
+{
+    restoreOwnState(*powerOnState);
+    if (cartridgeReader->is_in_bios)
+    {   // Taken before the boot ROM first ran, lands where starting up again would
+        loadBootState();
+    }
+    clearRunState();
+}
+
+bool GBCEmulator::reset(const std::vector<uint8_t> & power_on_state)
+{
+    if (!restore(power_on_state))
+    {
+        return false;
+    }
+
+    clearRunState();
+    return true;
+}
+
+// Nothing the last run left outside the machine state carries over
+void GBCEmulator::clearRunState()
+{
+    serial_transfer->clearSentBytes();
+    if (rewindBuffer)
+    {
+        rewindBuffer->clear();
+    }
+    rewinding = false;
+    rewindFrameCounter = 0;
+    inputSourceState = INPUT_NO_BUTTONS;    // Buttons still held on the input source are pressed again
+    stopRunning = false;
+    frameTimeStart = getCurrentTime();
+}
+
+SaveStateHeader GBCEmulator::getSaveStateHeader() const
+{
+    SaveStateHeader header = {};
+    header.magic = SAVE_STATE_MAGIC;
+    header.version = SAVE_STATE_VERSION;
+    header.rom_checksum = ((*mbc->romBanks)[0][0x14E] << 8) | (*mbc->romBanks)[0][0x14F];
+    header.game_title_hash = cartridgeReader->game_title_hash_16;
+    header.is_color_gb = isColorGB();
+    return header;
+}
+
+void GBCEmulator::snapshot(std::vector<uint8_t> & state)
+{
+    StateWriter writer(state);
+
+    // Size is filled in last
+    SaveStateHeader header = getSaveStateHeader();
+    writer.write(header);
+
+    cpu->saveState(writer);
+    memory->saveState(writer);
+    gpu->saveState(writer);
+    apu->saveState(writer);
+    mbc->saveState(writer);
+    joypad->saveState(writer);
+    serial_transfer->saveState(writer);
+    writer.write(cartridgeReader->is_in_bios);
+    writer.write(ticksAccumulated);
+    writer.write(ranInstruction);
+
+    header.size = static_cast<uint32_t>(writer.getPosition());
+    writer.writeAt(0, header);
+    writer.finish();
+}
+
+bool GBCEmulator::restore(const std::vector<uint8_t> & state)
+{
+    if (!checkSaveStateHeader(state))
+    {
+        return false;
+    }
+
+    // Components are loaded one at a time, so a corrupt state would leave the machine half loaded
+    snapshot(restoreRollbackState);
+    if (!loadMachineState(state))
+    {
+        loadMachineState(restoreRollbackState);
+        return false;
+    }
+
+    return true;
+}
+
+// For states this emulator made itself, which can't be corrupt
+bool GBCEmulator::restoreOwnState(const std::vector<uint8_t> & state)
+{
+    return checkSaveStateHeader(state) && loadMachineState(state);
+}
+
+bool GBCEmulator::checkSaveStateHeader(const std::vector<uint8_t> & state) const
+{
+    StateReader reader(state.data(), state.size());
+
+    SaveStateHeader header;
+    reader.read(header);
+
+    const SaveStateHeader expected = getSaveStateHeader();
+    if (reader.hasFailed() ||
+        header.magic != expected.magic ||
+        header.version != expected.version ||
+        header.size != state.size() ||
+        header.rom_checksum != expected.rom_checksum ||
+        header.game_title_hash != expected.game_title_hash ||
+        header.is_color_gb != expected.is_color_gb)
+    {
+        logger->error("Save state is not for this ROM or version of the emulator");
+        return false;
+    }
+
+    return true;
+}
+
+bool GBCEmulator::loadMachineState(const std::vector<uint8_t> & state)
+{
+    StateReader reader(state.data(), state.size());
+
+    SaveStateHeader header;
+    reader.read(header);
+
+    cpu->loadState(reader);
+    memory->loadState(reader);
+    gpu->loadState(reader);
+    apu->loadState(reader);
+    mbc->loadState(reader);
+    joypad->loadState(reader);
+    serial_transfer->loadState(reader);
+    reader.read(cartridgeReader->is_in_bios);
+    reader.read(ticksAccumulated);
+    reader.read(ranInstruction);
+
+    if (reader.hasFailed() ||
+        reader.getPosition() != state.size())
+    {   // Header matched, so the state was made by this version and has been corrupted
+        logger->error("Save state is corrupt, read {} of {} bytes", reader.getPosition(), state.size());
+        return false;
+    }
+
+    return true;
+}
+
+bool GBCEmulator::saveStateToFile(const std::filesystem::path & path, const bool & compress)
+{
+    std::vector<uint8_t> state;
+    snapshot(state);
+
+    if (!writeSaveStateFile(path, state, compress))
+    {
+        logger->error("Failed to write save state to {}", path.string());
+        return false;
+    }
+
+    return true;
+}
+
+bool GBCEmulator::loadStateFromFile(const std::filesystem::path & path)
+{
+    std::vector<uint8_t> state;
+    if (!readSaveStateFile(path, state))
+    {
+        logger->error("Failed to read save state from {}", path.string());
+        return false;
+    }
+
+    return restore(state);
+}
+
+// Starts from where the boot ROM handed over to the cartridge the last time it ran,
+// or has runComponents() save that state once it does
+void GBCEmulator::loadBootState()
+{
+    std::shared_ptr<BootStateCache> cache = BootStateCache::getDefault();
+    if (!cache->isEnabled())
+    {
+        return;
+    }
+
+    bootStateKey = BootStateCache::makeKey(cartridgeReader->bios, (*mbc->romBanks)[0], isColorGB());
+
+    std::vector<uint8_t> bootState;
+    if (cache->find(bootStateKey, bootState))
+    {
+        // The boot ROM never touches the cartridge, its RAM and RTC stay as they were just loaded
+        std::vector<uint8_t> cartridgeState;
+        StateWriter writer(cartridgeState);
+        mbc->saveState(writer);
+        writer.finish();
+
+        if (restore(bootState))
+        {
+            StateReader reader(cartridgeState.data(), cartridgeState.size());
+            mbc->loadState(reader);
+            logger->info("Started from the cached boot state {0:x}", bootStateKey);
+            return;
+        }
+
+        // Left as it was, so it runs the boot ROM after all and caches over the bad state
+    }
+
+    bootStateCache = cache;
+}
+
+void GBCEmulator::saveBootState()
+{
+    std::vector<uint8_t> bootState;
+    snapshot(bootState);
+    if (!bootStateCache->insert(bootStateKey, bootState))
+    {
+        logger->warn("Could not write the boot state to {}", bootStateCache->getDirectory().string());
+    }
+    bootStateCache.reset();
+}
+
+void GBCEmulator::setRewindEnabled(const bool & enable, const size_t & memory_budget, const uint32_t & frames_per_snapshot)
+{
+    rewindFramesPerSnapshot = std::max<uint32_t>(frames_per_snapshot, 1);
+    rewindFrameCounter = 0;
+
+    if (!enable)
+    {
+        rewindBuffer.reset();
+        rewinding = false;
+    }
+    else if (rewindBuffer)
+    {
+        rewindBuffer->setMemoryBudget(memory_budget);
+    }
+    else
+    {
+        rewindBuffer = std::make_unique<RewindBuffer>(memory_budget);
+    }
+}
+
+bool GBCEmulator::isRewindEnabled() const
+{
+    return rewindBuffer != nullptr;
+}
+
+void GBCEmulator::setRewinding(const bool & rewind)
+{
+    rewinding = rewind;
+}
+
+bool GBCEmulator::isRewinding() const
+{
+    return rewinding;
+}
+
+RewindStats GBCEmulator::getRewindStats() const
+{
+    return rewindBuffer ? rewindBuffer->getStats() : RewindStats{ 0, 0, 0 };
+}
+
+// Called once a frame
+void GBCEmulator::updateRewind()
+{
+    if (!rewindBuffer)
+    {
+        return;
+    }
+
+    if (rewinding)
+    {   // Once out of history keep going back to the oldest state
+        if (rewindBuffer->stepBack(rewindState) || !rewindState.empty())
+        {   // Buttons held now stay held
+            const uint8_t joypadState = joypad->getJoypadState();
+            restoreOwnState(rewindState);
+            joypad->setJoypadState(joypadState);
+        }
+        rewindFrameCounter = 0;
+        return;
+    }
+    rewindState.clear();    // Keeps its memory for the next rewind
+
+    if (++rewindFrameCounter < rewindFramesPerSnapshot)
+    {
+        return;
+    }
+    rewindFrameCounter = 0;
+
+    std::vector<uint8_t> * state = rewindBuffer->getCaptureBuffer();
+    if (state)
+    {
+        snapshot(*state);
+        rewindBuffer->submitCapture();
+    }
+}
+
+void GBCEmulator::setRunAheadFrames(const uint32_t & frames)
+{
+    runAheadFrames = frames;
+}
+
+uint32_t GBCEmulator::getRunAheadFrames() const
+{
+    return runAheadFrames;
+}
+
+// Snapshots the real frame, runs ahead with the joypad as it is now, shows the
+// last frame run and goes back. Audio is only made by real frames
+void GBCEmulator::runAhead()
+{
+    const auto startTime = getCurrentTime();
+    const uint32_t frames = runAheadFrames;
+
+    snapshot(runAheadState);
+    apu->setRunningAhead(true);
+
+    for (uint32_t i = 0; i < frames; i++)
+    {   // Only the frame shown needs drawing
+        runFrame(i == frames - 1);
+    }
+    if (frameSink)
+    {
+        frameSink->frameReady(gpu->curr_frame);
+    }
+
+    // Buttons pressed while running ahead aren't lost
+    const uint8_t joypadState = joypad->getJoypadState();
+    restoreOwnState(runAheadState);
+    joypad->setJoypadState(joypadState);
+    apu->setRunningAhead(false);
+
+    runAheadTimeMicro = std::chrono::duration_cast<std::chrono::microseconds>(getCurrentTime() - startTime);
+}
+
 void GBCEmulator::read_rom(std::string filename)
 {
     cartridgeReader->setRomDestination(filename);
@@ -169,8 +670,11 @@ void GBCEmulator::run()
 
 void GBCEmulator::runNextInstruction()
 {
-    uint8_t ticksRan = cpu->runNextInstruction();
+    runComponents(cpu->runNextInstruction());
+}
 
+void GBCEmulator::runComponents(uint8_t ticksRan)
+{
     // Check if Gameboy is in double speed mode
     if (memory->cgb_speed_mode & BIT7)
     {   // In double speed mode, divide tickDiff by 2 to simulate
@@ -192,20 +696,26 @@ void GBCEmulator::runNextInstruction()
 	}
 
 #ifdef USE_AUDIO_TIMING
-    // Sync video to audio
-    if (gpu->frame_is_ready)
+    // Sync video to audio, runFrame() handles the end of its own frames
+    if (gpu->frame_is_ready && !runningFrame)
     {
+        pollInput();
+
         // Display current frame
-        if (frameIsUpdatedFunction)
+        if (frameSink && runAheadFrames > 0)
+        {
+            runAhead();
+        }
+        else if (frameSink)
         {
-            frameIsUpdatedFunction(gpu->getFrame());
+            frameSink->frameReady(gpu->curr_frame);
         }
         gpu->frame_is_ready = false;
 
         apu->logger->trace("Number of samples made during frame: {0:d}", apu->samplesPerFrame);
 
         // Write out accumulated audio samples to audio device
-        apu->writeSamplesOutAsync(apu->audio_device_id);
+        apu->writeSamplesOutAsync();
 
         // Calculate frame processing time for debug purposes
         auto currTime = getCurrentTime();
@@ -213,8 +723,10 @@ void GBCEmulator::runNextInstruction()
 
         if (runWithoutSleep == false)
         {
-            // Let the APU sleep the emulator
-            apu->sleepUntilBufferIsEmpty(frameTimeStart);
+            // Frames are paced by the clock, the APU adjusts its sample rate
+            // to keep the audio buffer from running dry or filling up
+            apu->updateDynamicRate();
+            waitToStartNextFrame();
         }
 
         // Calculate frame show time for debug purposes
@@ -224,36 +736,57 @@ void GBCEmulator::runNextInstruction()
             std::to_string(frameShowTimeMicro.count() / 1000.0),
             std::to_string(frameProcessingTimeMicro.count() / 1000.0));
 
-        // Update frameTimeStart to current time
-        frameTimeStart = currTime;
+        advanceFrameTimeStart(currTime);
+
+        updateRewind();
     }
 #else // use CPU tick timing
     // Note: video will not be in-sync with audio
     ticksAccumulated += ticksRan;
     if (ticksAccumulated >= ticksPerFrame
-        && gpu->frame_is_ready)
+        && gpu->frame_is_ready
+        && !runningFrame)
     {
         ticksAccumulated -= ticksPerFrame;
 
         //if (gpu->frame_is_ready)
         {
-            frameIsUpdatedFunction(gpu->getFrame());
+            pollInput();
+
+            if (runAheadFrames > 0)
+            {
+                runAhead();
+            }
+            else if (frameSink)
+            {
+                frameSink->frameReady(gpu->curr_frame);
+            }
             gpu->frame_is_ready = false;
         }
 
         apu->logger->info("Number of samples made during frame: {0:d}", apu->samplesPerFrame);
 
         // Write out accumulated audio samples to audio device
-        apu->writeSamplesOutAsync(apu->audio_device_id);
+        apu->writeSamplesOutAsync();
 
         // Sleep until next burst of ticks_accumulated is ready to be ran
-        waitToStartNextFrame();
+        if (runWithoutSleep == false)
+        {
+            waitToStartNextFrame();
+        }
 
-        // Update frameTimeStart to current time
-        frameTimeStart = getCurrentTime();
+        advanceFrameTimeStart(getCurrentTime());
+
+        updateRewind();
     }
 #endif // USE_AUDIO_TIMING
 
+    // Frames run ahead are thrown away, the real one saves it
+    if (bootStateCache && !cartridgeReader->is_in_bios && !apu->isRunningAhead())
+    {
+        saveBootState();
+    }
+
     if (memory->cgb_perform_speed_switch)
     {   // Perform CPU double speed mode
         memory->cgb_perform_speed_switch = false;
@@ -278,6 +811,34 @@ void GBCEmulator::runNextInstruction()
     ranInstruction = true;
 }
 
+void GBCEmulator::runFrame(const bool & render)
+{
+    startFrame(render);
+
+    // Every instruction is at least a tick, so a frame is done well within this unless the LCD is off
+    for (uint64_t i = 0; i < ticksPerFrame && !gpu->frame_is_ready; i++)
+    {
+        runNextInstruction();
+    }
+
+    finishFrame();
+}
+
+void GBCEmulator::startFrame(const bool & render)
+{
+    runningFrame = true;
+    gpu->setRenderingEnabled(render);
+    gpu->frame_is_ready = false;    // Last frame is done with
+}
+
+void GBCEmulator::finishFrame()
+{
+    gpu->frame_is_ready = false;
+
+    gpu->setRenderingEnabled(true);
+    runningFrame = false;
+}
+
 void GBCEmulator::runTo(uint16_t pc)
 {
     while (cpu->get_register_16(CPU::REGISTERS::PC) != pc && !stopRunning)
@@ -299,7 +860,7 @@ void GBCEmulator::setStopRunning(bool val)
 void GBCEmulator::init_logging(std::string logName)
 {
     // Create loggerSink
-    loggerSink = std::make_shared<spdlog::sinks::rotating_file_sink_st>(logName, 1024 * 1024 * 500, 2);
+    loggerSink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(logName, 1024 * 1024 * 500, 2);
 
     // Create logger for this class
     logger = std::make_shared<spdlog::logger>("GBCEmulator", loggerSink);
@@ -358,29 +919,76 @@ std::shared_ptr<Joypad> GBCEmulator::get_Joypad()
     return NULL;
 }
 
+std::string GBCEmulator::getSerialOutput() const
+{
+    return serial_transfer->getSentBytes();
+}
+
 std::vector<uint8_t> GBCEmulator::get_memory_map() const
 {
-    std::vector<uint8_t> memory_map;
-    memory_map.reserve(0xFFFF);
+    std::vector<uint8_t> memory_map(0xFFFF);
+    memory->peek(0x0000, memory_map.size(), memory_map.data());
+    return memory_map;
+}
+
+std::vector<uint8_t> GBCEmulator::get_partial_memory_map(uint16_t start_pos, uint16_t end_pos) const
+{
+    std::vector<uint8_t> partial_memory_map((end_pos > start_pos) ? end_pos - start_pos : 0);
+    memory->peek(start_pos, partial_memory_map.size(), partial_memory_map.data());
+    return partial_memory_map;
+}
+
+void GBCEmulator::peek(const uint16_t & start, const size_t & length, uint8_t * out) const
+{
+    memory->peek(start, length, out);
+}
 
-    for (uint16_t i = 0; i < 0xFFFF; i++)
+MemorySpan GBCEmulator::getWorkRAM(const int & bank) const
+{
+    if (bank < 0 || bank >= memory->num_working_ram_banks)
     {
-        memory_map.push_back(memory->readByte(i));
+        return {};
     }
+    return { memory->working_ram_banks[bank].data(), memory->working_ram_banks[bank].size() };
+}
 
-    return memory_map;
+MemorySpan GBCEmulator::getHighRAM() const
+{
+    return { memory->high_ram, sizeof(memory->high_ram) };
 }
 
-std::vector<uint8_t> GBCEmulator::get_partial_memory_map(uint16_t start_pos, uint16_t end_pos) const
+MemorySpan GBCEmulator::getVRAM(const int & bank) const
+{
+    return gpu->getVRAM(bank);
+}
+
+MemorySpan GBCEmulator::getOAM() const
 {
-    std::vector<uint8_t> partial_memory_map;
-    partial_memory_map.reserve(end_pos - start_pos);
+    return gpu->getOAM();
+}
 
-    for (uint16_t i = start_pos; i < end_pos; i++)
+MemorySpan GBCEmulator::getCartridgeRAM(const int & bank) const
+{
+    if (bank < 0 || bank >= getNumCartridgeRAMBanks())
     {
-        partial_memory_map.push_back(memory->readByte(i));
+        return {};
     }
-    return partial_memory_map;
+    return { mbc->ramBanks[bank].data(), mbc->ramBanks[bank].size() };
+}
+
+int GBCEmulator::getNumWorkRAMBanks() const
+{
+    return memory->num_working_ram_banks;
+}
+
+int GBCEmulator::getNumVRAMBanks() const
+{
+    return gpu->getNumVRAMBanks();
+}
+
+int GBCEmulator::getNumCartridgeRAMBanks() const
+{
+    return static_cast<int>(mbc->ramBanks.size());
 }
 
 void GBCEmulator::set_joypad_button(Joypad::BUTTON button)
@@ -409,25 +1017,93 @@ void GBCEmulator::waitToStartNextFrame() const
     auto timeToWaitMilli = timePerFrame - timeElapsedMilli;
     if (timeToWaitMilli.count() > 0)
     {   // Sleep until next frame needs to start rendering
-        std::this_thread::sleep_for(timeToWaitMilli);
+        std::this_thread::sleep_until(std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeToWaitMilli));
+    }
+}
+
+// Next frame starts when this one was due to end, so time overslept doesn't add up.
+// Falling more than a frame behind (or running without sleep) restarts from now
+void GBCEmulator::advanceFrameTimeStart(const std::chrono::duration<double> & currTime)
+{
+    frameTimeStart += timePerFrame;
+
+    if (runWithoutSleep ||
+        currTime - frameTimeStart > timePerFrame ||
+        frameTimeStart - currTime > timePerFrame)
+    {
+        frameTimeStart = currTime;
     }
 }
 
+// Monotonic, wall clock changes can't stall or rush frame pacing
 std::chrono::duration<double> GBCEmulator::getCurrentTime() const
 {
     return std::chrono::duration<double>(
-        std::chrono::system_clock::now()
+        std::chrono::steady_clock::now()
         .time_since_epoch());
 }
 
 void GBCEmulator::setTimePerFrame(double d)
 {
-    timePerFrame = std::chrono::duration<double>(d);
+    timePerFrameAt1x = std::chrono::duration<double>(d);
+    timePerFrame = timePerFrameAt1x / emulationSpeed;
+}
+
+// Frames are paced 'speed' times faster, the APU keeps the audio at its normal pitch
+void GBCEmulator::setEmulationSpeed(double speed)
+{
+    emulationSpeed = std::min(std::max(speed, EMULATION_SPEED_MIN), EMULATION_SPEED_MAX);
+    timePerFrame = timePerFrameAt1x / emulationSpeed;
+
+    apu->setEmulationSpeed(emulationSpeed);
+}
+
+double GBCEmulator::getEmulationSpeed() const
+{
+    return emulationSpeed;
 }
 
 void GBCEmulator::setFrameUpdateMethod(std::function<void(std::array<SDL_Color, SCREEN_PIXEL_TOTAL> /* frame */)> function)
 {
-    frameIsUpdatedFunction = function;
+    if (!function)
+    {
+        frameSink.reset();
+        return;
+    }
+
+    frameSink = std::make_shared<CallbackFrameSink>(function);
+}
+
+void GBCEmulator::setFrameSink(std::shared_ptr<FrameSink> sink)
+{
+    frameSink = sink;
+}
+
+void GBCEmulator::setAudioSink(std::shared_ptr<AudioSink> sink)
+{
+    apu->setAudioSink(sink);
+}
+
+void GBCEmulator::setInputSource(std::shared_ptr<InputSource> source)
+{   // Buttons the last source was holding are let go
+    joypad->updateButtons(inputSourceState, INPUT_NO_BUTTONS);
+    inputSourceState = INPUT_NO_BUTTONS;
+    inputSource = source;
+}
+
+// Only buttons that changed since the last poll are pressed or released,
+// so buttons pressed some other way aren't let go
+void GBCEmulator::pollInput()
+{
+    if (!inputSource)
+    {
+        return;
+    }
+
+    const uint8_t state = inputSource->pollJoypadState();
+    joypad->updateButtons(inputSourceState, state);
+    inputSourceState = state;
 }
 
 std::array<SDL_Color, SCREEN_PIXEL_TOTAL> GBCEmulator::getFrame() const
@@ -10,11 +10,14 @@
 #include "stdafx.h"
 #endif // _WIN32
 
+#include <atomic>
 #include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <functional>
 #include <iterator>
+#include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 
@@ -26,36 +29,101 @@
 #include "GPU.h"
 #include "CartridgeReader.h"
 #include "SerialTransfer.h"
+#include "SaveState.h"
+#include "RewindBuffer.h"
+#include "AudioSink.h"
+#include "BootStateCache.h"
+#include "FrameSink.h"
+#include "InputSource.h"
+#include "SDLTypes.h"
 #include "Debug.h"
 
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/rotating_file_sink.h>
 
-extern "C" {
-#include <SDL.h>
-}
-
 #define USE_AUDIO_TIMING
+#define EMULATION_SPEED_MIN 0.25
+#define EMULATION_SPEED_MAX 16.0
+#define CLONE_POOL_MAX_SIZE 64      // Discarded clones kept for reuse, any more are freed
+
+struct GBCEmulatorPool;
+class BatchInterpreter;
 
 class GBCEmulator
 {
+    // Steps the CPUs of many emulators together, then each one's components
+    friend class BatchInterpreter;
+
 public:
+    // Without 'openAudioDevice' there's no audio output until setAudioSink().
+    // Without 'useSaveFiles' the ROM's .sav and .rtc are neither read nor written
     GBCEmulator(const std::string romName, const std::string logName = "log.txt",
-        const std::string biosPath = "", bool debugMode = false, const bool force_cgb_mode = false);
+        const std::string biosPath = "", bool debugMode = false, const bool force_cgb_mode = false,
+        const bool openAudioDevice = true, const bool useSaveFiles = true);
     virtual ~GBCEmulator();
     GBCEmulator& operator=(const GBCEmulator& rhs);
 
+    // Writes all machine state into 'state', reusing its memory.
+    // The emulator can't be running on another thread
+    void snapshot(std::vector<uint8_t> & state);
+    // Checks the state is for this ROM and version before loading anything.
+    // If it turns out to be corrupt part way the machine is put back as it was
+    bool restore(const std::vector<uint8_t> & state);
+    bool saveStateToFile(const std::filesystem::path & path, const bool & compress = true);
+    bool loadStateFromFile(const std::filesystem::path & path);
+
+    // Back to the state the emulator was made in, cartridge RAM and all, without reading the
+    // ROM again or reallocating anything. Sinks and settings are kept. With a boot ROM it starts
+    // from the cached boot state when there is one, as a new emulator would.
+    // The emulator can't be running on another thread
+    void reset();
+    // Same, but to 'power_on_state', a snapshot() of this ROM. Returns false if it can't be restored
+    bool reset(const std::vector<uint8_t> & power_on_state);
+
+    // Independent copy of this emulator that shares its ROM and logs, and has no audio
+    // device or render thread. Discarded clones are reused by the next clone(), so once
+    // warmed up cloning is a snapshot and restore without allocating. Clones can run on
+    // their own threads, the log file takes writes from any of them.
+    // The emulator can't be running on another thread
+    std::shared_ptr<GBCEmulator> clone();
+    // Discarded clones waiting to be reused
+    size_t getNumIdleClones() const;
+
+    // Keeps a snapshot every 'frames_per_snapshot' frames, as many as fit in 'memory_budget' bytes
+    void setRewindEnabled(const bool & enable, const size_t & memory_budget = REWIND_DEFAULT_MEMORY_BUDGET,
+        const uint32_t & frames_per_snapshot = REWIND_DEFAULT_FRAMES_PER_SNAPSHOT);
+    bool isRewindEnabled() const;
+    // While set, every frame goes back a snapshot instead of taking one. Safe to call from any thread
+    void setRewinding(const bool & rewind);
+    bool isRewinding() const;
+    RewindStats getRewindStats() const;
+
+    // Shows the frame 'frames' ahead of the real one, then goes back to the real one.
+    // Hides that many frames of a game's own input lag, at the cost of running them every frame
+    void setRunAheadFrames(const uint32_t & frames);
+    uint32_t getRunAheadFrames() const;
+
     void set_logging_level(spdlog::level::level_enum l);
     void run();
     void runNextInstruction();
     void runTo(uint16_t pc);
+    // Runs until the GPU finishes a frame and leaves it in getFrame(), it isn't
+    // displayed, paced or written out as audio. Without 'render' no lines are drawn
+    void runFrame(const bool & render = true);
     void stop();
     void setStopRunning(bool val);
     bool frame_is_ready() const;
     void set_joypad_button(Joypad::BUTTON button);
     void release_joypad_button(Joypad::BUTTON button);
     void setTimePerFrame(double d);
+    void setEmulationSpeed(double speed);
+    double getEmulationSpeed() const;
     void setFrameUpdateMethod(std::function<void(std::array<SDL_Color, SCREEN_PIXEL_TOTAL> /* frame */)> function);
+    // Where finished frames, audio and buttons go to and come from, nullptr for none.
+    // Headless servers can use the null or memory sinks, which never wait on a device
+    void setFrameSink(std::shared_ptr<FrameSink> sink);
+    void setAudioSink(std::shared_ptr<AudioSink> sink);
+    void setInputSource(std::shared_ptr<InputSource> source);
     void saveFrameToPNG(std::filesystem::path filepath);
     SDL_Color* get_frame();
     SDL_Color* getFrameRaw() const;
@@ -65,8 +133,20 @@ public:
     std::shared_ptr<CPU> get_CPU();
     std::shared_ptr<GPU> get_GPU();
     std::shared_ptr<Joypad> get_Joypad();
+    std::string getSerialOutput() const;
     std::vector<uint8_t> get_memory_map() const;
     std::vector<uint8_t> get_partial_memory_map(uint16_t start_pos, uint16_t end_pos) const;
+    // Copies 'length' bytes of the memory map from 'start' on, see Memory::peek()
+    void peek(const uint16_t & start, const size_t & length, uint8_t * out) const;
+    // Every bank, not just the mapped ones. Out of range banks give empty spans
+    MemorySpan getWorkRAM(const int & bank) const;
+    MemorySpan getHighRAM() const;
+    MemorySpan getVRAM(const int & bank) const;
+    MemorySpan getOAM() const;
+    MemorySpan getCartridgeRAM(const int & bank) const;
+    int getNumWorkRAMBanks() const;
+    int getNumVRAMBanks() const;
+    int getNumCartridgeRAMBanks() const;
     std::array<SDL_Color, SCREEN_PIXEL_TOTAL> getFrame() const;
 
     static uint64_t calculateFrameHash(SDL_Color* frame);
@@ -79,17 +159,34 @@ public:
     bool ranInstruction;
     bool debugMode;
     bool runWithoutSleep;
-    std::chrono::microseconds frameProcessingTimeMicro;   // This is updated right before calling frameIsUpdatedFunction()
+    std::chrono::microseconds frameProcessingTimeMicro;   // This is updated right before the frame is sent to the frame sink
     std::chrono::microseconds frameShowTimeMicro;
+    std::chrono::microseconds runAheadTimeMicro;         // Extra time the last frame took running ahead
     std::shared_ptr<spdlog::logger> logger;
 
 private:
+    GBCEmulator(const GBCEmulator & source, const std::shared_ptr<GBCEmulatorPool> & pool);
     void read_rom(std::string filename);
     void init_memory(const bool force_cgb_mode);
     void init_gpu(const bool force_cgb_mode);
     void init_logging(std::string logName);
     void waitToStartNextFrame() const;
+    void advanceFrameTimeStart(const std::chrono::duration<double> & currTime);
     std::chrono::duration<double> getCurrentTime() const;
+    SaveStateHeader getSaveStateHeader() const;
+    bool checkSaveStateHeader(const std::vector<uint8_t> & state) const;
+    bool loadMachineState(const std::vector<uint8_t> & state);
+    bool restoreOwnState(const std::vector<uint8_t> & state);
+    void clearRunState();
+    void loadBootState();
+    void saveBootState();
+    void updateRewind();
+    void runAhead();
+    void pollInput();
+    // runNextInstruction() after the CPU, and runFrame() either side of its instructions
+    void runComponents(uint8_t ticksRan);
+    void startFrame(const bool & render);
+    void finishFrame();
  
     // Variables
     std::shared_ptr<APU> apu;
@@ -101,7 +198,7 @@ private:
     std::shared_ptr<Joypad> joypad;
     std::shared_ptr<SerialTransfer> serial_transfer;
 
-    std::shared_ptr<spdlog::sinks::rotating_file_sink_st> loggerSink;
+    std::shared_ptr<spdlog::sinks::rotating_file_sink_mt> loggerSink;
     std::uint16_t logCounter;
 
     bool stopRunning;
@@ -112,8 +209,41 @@ private:
     uint32_t ticksAccumulated;
     std::chrono::duration<double> frameTimeStart;
     std::chrono::duration<double> timePerFrame;
+    std::chrono::duration<double> timePerFrameAt1x;
+    double emulationSpeed;
+
+    std::shared_ptr<FrameSink> frameSink;
+    std::shared_ptr<InputSource> inputSource;
+    uint8_t inputSourceState;           // Last state polled, only buttons that change are pressed or released
+
+    std::unique_ptr<RewindBuffer> rewindBuffer;
+    std::vector<uint8_t> rewindState;
+    std::atomic_bool rewinding;
+    uint32_t rewindFramesPerSnapshot;
+    uint32_t rewindFrameCounter;
+
+    std::vector<uint8_t> restoreRollbackState;  // restore() goes back to it if a state is corrupt
+
+    std::vector<uint8_t> runAheadState;
+    std::atomic<uint32_t> runAheadFrames;
+    bool runningFrame;
+
+    std::shared_ptr<const std::vector<uint8_t>> powerOnState;  // Shared with clones
+    std::shared_ptr<BootStateCache> bootStateCache;     // Only set while a boot ROM runs that isn't cached yet
+    uint64_t bootStateKey;
+
+    std::shared_ptr<GBCEmulatorPool> ownedClonePool;    // Only set on the emulator the clones came from
+    std::weak_ptr<GBCEmulatorPool> clonePool;
+    std::vector<uint8_t> cloneState;
+    bool isClone;
+    bool useSaveFiles;
+};
 
-    std::function<void(std::array<SDL_Color, SCREEN_PIXEL_TOTAL> /* frame */)> frameIsUpdatedFunction;
+// Clones waiting to be reused
+struct GBCEmulatorPool
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<GBCEmulator>> instances;
 };
 
 #endif // GBCEMULATOR_H
\ No newline at end of file
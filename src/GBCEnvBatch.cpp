@@ -0,0 +1,92 @@
+#ifdef _WIN32
+#include "stdafx.h"
+#endif // _WIN32
+
+#include "GBCEnvBatch.h"
+#include "InputSource.h"
+#include <cstring>
+
+GBCEnvBatch::GBCEnvBatch(const std::string & rom_path, const size_t & num_envs, const size_t & num_threads)
+    : joypad_states(num_envs, INPUT_NO_BUTTONS)
+    , pool(num_threads)
+{
+    for (size_t i = 0; i < num_envs; i++)
+    {
+        std::shared_ptr<GBCEmulator> env = std::make_shared<GBCEmulator>(rom_path,
+            rom_path + "." + std::to_string(i) + ".log", "", false, false, false, false);
+        env->runWithoutSleep = true;
+        env->get_APU()->setSilentMode(true);
+
+        envs.push_back(env);
+    }
+}
+
+GBCEnvBatch::~GBCEnvBatch()
+{
+    // Nothing can still be running when the emulators go
+    pool.wait();
+}
+
+void GBCEnvBatch::step(const uint8_t * actions, const uint32_t & frames, uint8_t * screen_out, uint8_t * ram_out)
+{
+    for (size_t i = 0; i < envs.size(); i++)
+    {   // Each task only touches its own emulator, joypad state and part of the outputs
+        pool.submit([this, i, actions, frames, screen_out, ram_out]()
+        {
+            const uint8_t state = actions ? actions[i] : INPUT_NO_BUTTONS;
+            envs[i]->get_Joypad()->updateButtons(joypad_states[i], state);
+            joypad_states[i] = state;
+
+            for (uint32_t frame = 0; frame < frames; frame++)
+            {
+                envs[i]->runFrame();
+            }
+
+            writeObservation(i, screen_out, ram_out);
+        });
+    }
+    pool.wait();
+}
+
+void GBCEnvBatch::reset(uint8_t * screen_out, uint8_t * ram_out)
+{
+    for (size_t i = 0; i < envs.size(); i++)
+    {
+        pool.submit([this, i, screen_out, ram_out]()
+        {
+            envs[i]->reset();
+            joypad_states[i] = INPUT_NO_BUTTONS;
+
+            writeObservation(i, screen_out, ram_out);
+        });
+    }
+    pool.wait();
+}
+
+size_t GBCEnvBatch::getNumEnvs() const
+{
+    return envs.size();
+}
+
+size_t GBCEnvBatch::getNumThreads() const
+{
+    return pool.getNumThreads();
+}
+
+std::shared_ptr<GBCEmulator> GBCEnvBatch::getEnv(const size_t & index) const
+{
+    return envs.at(index);
+}
+
+void GBCEnvBatch::writeObservation(const size_t & index, uint8_t * screen_out, uint8_t * ram_out) const
+{
+    if (screen_out)
+    {
+        std::memcpy(screen_out + index * ENV_SCREEN_OBSERVATION_SIZE, envs[index]->getFrameRaw(), ENV_SCREEN_OBSERVATION_SIZE);
+    }
+
+    if (ram_out)
+    {
+        envs[index]->peek(0x0000, ENV_RAM_OBSERVATION_SIZE, ram_out + index * ENV_RAM_OBSERVATION_SIZE);
+    }
+}
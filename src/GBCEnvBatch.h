@@ -0,0 +1,45 @@
+#ifndef GBC_ENV_BATCH_H
+#define GBC_ENV_BATCH_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "GBCEmulator.h"
+#include "WorkStealingPool.h"
+
+#define ENV_SCREEN_OBSERVATION_SIZE (SCREEN_PIXEL_TOTAL * sizeof(SDL_Color))   // RGBA, row by row
+#define ENV_RAM_OBSERVATION_SIZE 0xFFFF                                         // Memory map, 0x0000 - 0xFFFE
+
+// Many emulators of the same ROM stepped in lockstep, for training agents.
+// Every step runs each emulator for some frames with its own buttons held, spread
+// over a pool of threads that lives as long as the batch, then writes each one's
+// observation straight into the caller's buffers at 'index * observation size'.
+// Emulators run headless, as fast as they can and without audio
+class GBCEnvBatch
+{
+public:
+    // Each emulator logs to '<rom_path>.<index>.log'. 0 threads is one per hardware thread.
+    // Throws if the ROM can't be read
+    GBCEnvBatch(const std::string & rom_path, const size_t & num_envs, const size_t & num_threads = 0);
+    virtual ~GBCEnvBatch();
+
+    // 'actions' has a joypad state for each emulator, as returned by Joypad::getJoypadState(),
+    // held for all 'frames'. nullptr holds nothing. Either output can be nullptr
+    void step(const uint8_t * actions, const uint32_t & frames, uint8_t * screen_out, uint8_t * ram_out);
+    // Every emulator goes back to how it was at power on, nothing held
+    void reset(uint8_t * screen_out, uint8_t * ram_out);
+
+    size_t getNumEnvs() const;
+    size_t getNumThreads() const;
+    std::shared_ptr<GBCEmulator> getEnv(const size_t & index) const;
+
+private:
+    void writeObservation(const size_t & index, uint8_t * screen_out, uint8_t * ram_out) const;
+
+    std::vector<std::shared_ptr<GBCEmulator>> envs;
+    std::vector<uint8_t> joypad_states;     // Buttons each emulator is holding
+    WorkStealingPool pool;
+};
+
+#endif // GBC_ENV_BATCH_H
@@ -0,0 +1,74 @@
+#ifdef _WIN32
+#include "stdafx.h"
+#endif // _WIN32
+
+#include "GBCEnvBatchC.h"
+#include "GBCEnvBatch.h"
+
+// Exceptions can't cross into C, a NULL or non-zero return stands in for them
+struct gbc_env_batch
+{
+    std::unique_ptr<GBCEnvBatch> envs;
+};
+
+gbc_env_batch * gbc_env_batch_create(const char * rom_path, uint32_t num_envs, uint32_t num_threads)
+{
+    if (!rom_path)
+    {
+        return nullptr;
+    }
+
+    try
+    {
+        std::unique_ptr<gbc_env_batch> batch = std::make_unique<gbc_env_batch>();
+        batch->envs = std::make_unique<GBCEnvBatch>(rom_path, num_envs, num_threads);
+        return batch.release();
+    }
+    catch (const std::exception &)
+    {
+        return nullptr;
+    }
+}
+
+void gbc_env_batch_destroy(gbc_env_batch * batch)
+{
+    delete batch;
+}
+
+uint32_t gbc_env_batch_num_envs(const gbc_env_batch * batch)
+{
+    return batch ? static_cast<uint32_t>(batch->envs->getNumEnvs()) : 0;
+}
+
+size_t gbc_env_screen_size(void)
+{
+    return ENV_SCREEN_OBSERVATION_SIZE;
+}
+
+size_t gbc_env_ram_size(void)
+{
+    return ENV_RAM_OBSERVATION_SIZE;
+}
+
+int gbc_env_batch_step(gbc_env_batch * batch, const uint8_t * actions, uint32_t frames,
+    uint8_t * screens, uint8_t * ram)
+{
+    if (!batch)
+    {
+        return -1;
+    }
+
+    batch->envs->step(actions, frames, screens, ram);
+    return 0;
+}
+
+int gbc_env_batch_reset(gbc_env_batch * batch, uint8_t * screens, uint8_t * ram)
+{
+    if (!batch)
+    {
+        return -1;
+    }
+
+    batch->envs->reset(screens, ram);
+    return 0;
+}
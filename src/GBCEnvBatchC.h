@@ -0,0 +1,44 @@
+#ifndef GBC_ENV_BATCH_C_H
+#define GBC_ENV_BATCH_C_H
+
+// C interface to GBCEnvBatch, for loading the shared library from other languages,
+// e.g. Python's ctypes with numpy arrays as the action and observation buffers.
+// Observations are written straight into the caller's buffers, env after env:
+// screens are gbc_env_screen_size() bytes of RGBA each, RAM is gbc_env_ram_size()
+// bytes of the memory map each. Functions returning int return 0 on success
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#define GBC_ENV_API __declspec(dllexport)
+#else
+#define GBC_ENV_API __attribute__((visibility("default")))
+#endif // _WIN32
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct gbc_env_batch gbc_env_batch;
+
+// NULL if the ROM can't be read. 0 threads is one per hardware thread
+GBC_ENV_API gbc_env_batch * gbc_env_batch_create(const char * rom_path, uint32_t num_envs, uint32_t num_threads);
+GBC_ENV_API void gbc_env_batch_destroy(gbc_env_batch * batch);
+
+GBC_ENV_API uint32_t gbc_env_batch_num_envs(const gbc_env_batch * batch);
+GBC_ENV_API size_t gbc_env_screen_size(void);
+GBC_ENV_API size_t gbc_env_ram_size(void);
+
+// 'actions' is one joypad state per env, a cleared bit is a held button:
+// bit 0 right, 1 left, 2 up, 3 down, 4 A, 5 B, 6 select, 7 start. NULL holds nothing.
+// 'screens' and 'ram' can be NULL
+GBC_ENV_API int gbc_env_batch_step(gbc_env_batch * batch, const uint8_t * actions, uint32_t frames,
+    uint8_t * screens, uint8_t * ram);
+GBC_ENV_API int gbc_env_batch_reset(gbc_env_batch * batch, uint8_t * screens, uint8_t * ram);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GBC_ENV_BATCH_C_H
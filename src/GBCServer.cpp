@@ -0,0 +1,298 @@
+#include "GBCServer.h"
+#include "InputSource.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    // Whole word has to be a number no bigger than 'max', decimal or 0x hex
+    bool parseNumber(const std::string & word, const uint32_t & max, uint32_t & out)
+    {
+        if (word.empty())
+        {
+            return false;
+        }
+
+        char * end = nullptr;
+        const unsigned long value = std::strtoul(word.c_str(), &end, 0);
+        if (*end != '\0' || value > max)
+        {
+            return false;
+        }
+
+        out = static_cast<uint32_t>(value);
+        return true;
+    }
+
+    bool sendAll(const int & fd, const std::string & data)
+    {
+        size_t sent = 0;
+        while (sent < data.size())
+        {
+            const ssize_t ret = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (ret < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (ret <= 0)
+            {
+                return false;
+            }
+            sent += ret;
+        }
+        return true;
+    }
+}
+
+GBCServer::GBCServer(const std::string & rom_path, const std::string & socket_path, const std::string & shm_name,
+    const std::string & bios_path)
+    : frame_ring(std::make_shared<SharedMemoryRing>(shm_name + "-frames", GBC_SERVER_FRAME_SLOTS, sizeof(SDL_Color) * SCREEN_PIXEL_TOTAL))
+    , audio_ring(std::make_shared<SharedMemoryRing>(shm_name + "-audio", GBC_SERVER_AUDIO_SLOTS, GBC_SERVER_AUDIO_SLOT_SIZE))
+    , ram_ring(std::make_shared<SharedMemoryRing>(shm_name + "-ram", GBC_SERVER_RAM_SLOTS, GBC_SERVER_RAM_SIZE))
+    , frame_sink(std::make_shared<SharedMemoryFrameSink>(frame_ring))
+    , socket_path(socket_path)
+    , listen_fd(-1)
+    , running(false)
+    , joypad_state(INPUT_NO_BUTTONS)
+    , frames_run(0)
+{
+    emu = std::make_shared<GBCEmulator>(rom_path, rom_path + ".server.log", bios_path, false, false, false, false);
+    emu->runWithoutSleep = true;
+    emu->setAudioSink(std::make_shared<SharedMemoryAudioSink>(audio_ring));
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path))
+    {
+        throw std::runtime_error("Socket path " + socket_path + " is too long");
+    }
+    std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0)
+    {
+        throw std::runtime_error(std::string("Could not make a socket: ") + std::strerror(errno));
+    }
+
+    // A socket file left behind by a server that didn't exit cleanly would stop bind()
+    unlink(socket_path.c_str());
+    if (bind(listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+        listen(listen_fd, SOMAXCONN) != 0)
+    {
+        const std::string error = std::strerror(errno);
+        close(listen_fd);
+        throw std::runtime_error("Could not listen on " + socket_path + ": " + error);
+    }
+
+    emu->logger->info("Serving on {}, shared memory {}-frames, -audio and -ram", socket_path, shm_name);
+}
+
+GBCServer::~GBCServer()
+{
+    for (Client & client : clients)
+    {
+        close(client.fd);
+    }
+    close(listen_fd);
+    unlink(socket_path.c_str());
+
+    emu->setAudioSink(nullptr);
+}
+
+void GBCServer::run()
+{
+    running = true;
+    std::vector<pollfd> poll_fds;
+
+    while (running)
+    {
+        poll_fds.clear();
+        poll_fds.push_back({ listen_fd, POLLIN, 0 });
+        for (const Client & client : clients)
+        {
+            poll_fds.push_back({ client.fd, POLLIN, 0 });
+        }
+
+        if (poll(poll_fds.data(), poll_fds.size(), GBC_SERVER_POLL_MS) <= 0)
+        {
+            continue;
+        }
+
+        // Clients in order, so requests from one are never reordered
+        size_t kept = 0;
+        for (size_t i = 0; i < clients.size(); i++)
+        {
+            const bool keep = !(poll_fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) || readRequests(clients[i]);
+            if (keep)
+            {
+                clients[kept++] = clients[i];
+            }
+            else
+            {
+                close(clients[i].fd);
+            }
+        }
+        clients.resize(kept);
+
+        if (poll_fds[0].revents & POLLIN)
+        {
+            const int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd >= 0)
+            {
+                clients.push_back({ fd, "" });
+            }
+        }
+    }
+}
+
+void GBCServer::stop()
+{
+    running = false;
+}
+
+std::shared_ptr<GBCEmulator> GBCServer::getEmulator() const
+{
+    return emu;
+}
+
+// Returns false once the client should be dropped
+bool GBCServer::readRequests(Client & client)
+{
+    char buffer[0x1000];
+    const ssize_t received = recv(client.fd, buffer, sizeof(buffer), 0);
+    if (received <= 0)
+    {
+        return received < 0 && errno == EINTR;
+    }
+    client.requests.append(buffer, received);
+
+    // Every complete request gets its reply, all of them sent back together
+    std::string replies;
+    size_t start = 0;
+    size_t end;
+    while ((end = client.requests.find('\n', start)) != std::string::npos)
+    {
+        replies += handleRequest(client.requests.substr(start, end - start)) + "\n";
+        start = end + 1;
+    }
+    client.requests.erase(0, start);
+
+    if (client.requests.size() > GBC_SERVER_MAX_REQUEST)
+    {
+        sendAll(client.fd, replies + "error request too long\n");
+        return false;
+    }
+
+    return replies.empty() || sendAll(client.fd, replies);
+}
+
+std::string GBCServer::handleRequest(const std::string & request)
+{
+    std::istringstream words(request);
+    std::string command, arg1, arg2;
+    words >> command >> arg1 >> arg2;
+
+    if (command == "step")
+    {
+        uint32_t frames, state = joypad_state;
+        if (!parseNumber(arg1, UINT32_MAX, frames) ||
+            (!arg2.empty() && !parseNumber(arg2, 0xFF, state)))
+        {
+            return "error usage: step <frames> [buttons]";
+        }
+        if (frames > GBC_SERVER_MAX_STEP_FRAMES)
+        {
+            return "error step runs at most " + std::to_string(GBC_SERVER_MAX_STEP_FRAMES) + " frames";
+        }
+
+        emu->get_Joypad()->updateButtons(joypad_state, state);
+        joypad_state = state;
+
+        // runFrame() leaves the end of the frame to its caller, as the emulator's own loop would do it
+        for (uint32_t frame = 0; frame < frames; frame++)
+        {
+            emu->runFrame();
+            frame_sink->frameReady(emu->getFrameRaw());
+            emu->get_APU()->writeSamplesOutAsync();
+            frames_run++;
+        }
+
+        const uint64_t ram_entry = publishRAM();
+        return "ok " + std::to_string(static_cast<int64_t>(frame_ring->getWriteSequence()) - 1) + " " + std::to_string(ram_entry);
+    }
+    else if (command == "input")
+    {
+        uint32_t state;
+        if (!parseNumber(arg1, 0xFF, state))
+        {
+            return "error usage: input <buttons>";
+        }
+
+        emu->get_Joypad()->updateButtons(joypad_state, state);
+        joypad_state = state;
+        return "ok";
+    }
+    else if (command == "ram")
+    {
+        return "ok " + std::to_string(publishRAM());
+    }
+    else if (command == "snapshot" || command == "restore")
+    {
+        const std::string & name = arg1;
+        if (name.empty())
+        {
+            return "error usage: " + command + " <name>";
+        }
+
+        if (command == "snapshot")
+        {
+            std::vector<uint8_t> & state = snapshots[name];
+            emu->snapshot(state);
+            return "ok " + std::to_string(state.size());
+        }
+
+        const auto snapshot = snapshots.find(name);
+        if (snapshot == snapshots.end())
+        {
+            return "error no snapshot " + name;
+        }
+        if (!emu->restore(snapshot->second))
+        {
+            return "error could not restore " + name;
+        }
+        joypad_state = emu->get_Joypad()->getJoypadState();
+        return "ok " + std::to_string(publishRAM());
+    }
+    else if (command == "reset")
+    {
+        emu->reset();
+        joypad_state = INPUT_NO_BUTTONS;
+        return "ok " + std::to_string(publishRAM());
+    }
+    else if (command == "ping")
+    {
+        return "ok";
+    }
+    else if (command == "quit")
+    {
+        stop();
+        return "ok";
+    }
+
+    return "error unknown request '" + command + "'";
+}
+
+uint64_t GBCServer::publishRAM()
+{
+    // APU registers as of now, not the last time it caught up
+    emu->get_APU()->catchUp();
+    emu->peek(0x0000, GBC_SERVER_RAM_SIZE, ram_ring->beginEntry());
+    return ram_ring->commitEntry(GBC_SERVER_RAM_SIZE, frames_run);
+}
@@ -0,0 +1,80 @@
+#ifndef GBC_SERVER_H
+#define GBC_SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "GBCEmulator.h"
+#include "SharedMemorySinks.h"
+
+#define GBC_SERVER_FRAME_SLOTS 16
+#define GBC_SERVER_AUDIO_SLOTS 64
+#define GBC_SERVER_AUDIO_SLOT_SIZE 0x1000
+#define GBC_SERVER_RAM_SLOTS 16
+#define GBC_SERVER_RAM_SIZE 0x10000         // Whole memory map, 0x0000 - 0xFFFF
+#define GBC_SERVER_MAX_REQUEST 256          // Longer lines drop the connection
+#define GBC_SERVER_POLL_MS 100              // How long stop() can take to be noticed
+#define GBC_SERVER_MAX_STEP_FRAMES 3600     // A minute of frames, no other request is served while they run
+
+// Runs one headless emulator for other processes on the same machine.
+// Frames, audio and RAM snapshots go into POSIX shared memory rings '<shm_name>-frames', '-audio'
+// and '-ram' (see SharedMemoryRing.h), so readers never copy them through the socket.
+// Requests come in over a Unix domain socket, one per line, and get one reply line each, in order.
+// Clients can send any number of requests at once without waiting for their replies:
+//   step <frames> [buttons]    Runs up to GBC_SERVER_MAX_STEP_FRAMES frames holding 'buttons', then
+//                              publishes RAM. Replies 'ok <newest frame entry> <RAM entry>'
+//   input <buttons>            Holds 'buttons' from the next step on. Replies 'ok'
+//   ram                        Publishes RAM. Replies 'ok <RAM entry>'
+//   snapshot <name>            Keeps a save state in the server. Replies 'ok <bytes>'
+//   restore <name>             Goes back to a snapshot, then publishes RAM. Replies 'ok <RAM entry>'
+//   reset                      Goes back to power on, nothing held, then publishes RAM. Replies 'ok <RAM entry>'
+//   ping                       Replies 'ok'
+//   quit                       Replies 'ok' and stops the server
+// Buttons are a joypad state as returned by Joypad::getJoypadState(), a cleared bit is held.
+// Anything else replies 'error <reason>'
+class GBCServer
+{
+public:
+    // Throws if the ROM can't be read, or the socket or shared memory can't be made
+    GBCServer(const std::string & rom_path, const std::string & socket_path, const std::string & shm_name,
+        const std::string & bios_path = "");
+    virtual ~GBCServer();
+
+    // Serves clients until 'quit' or stop()
+    void run();
+    // Safe to call from any thread
+    void stop();
+
+    std::shared_ptr<GBCEmulator> getEmulator() const;
+
+private:
+    struct Client
+    {
+        int fd;
+        std::string requests;   // Received, not yet complete
+    };
+
+    bool readRequests(Client & client);
+    std::string handleRequest(const std::string & request);
+    uint64_t publishRAM();
+
+    std::shared_ptr<GBCEmulator> emu;
+    std::shared_ptr<SharedMemoryRing> frame_ring;
+    std::shared_ptr<SharedMemoryRing> audio_ring;
+    std::shared_ptr<SharedMemoryRing> ram_ring;
+    std::shared_ptr<SharedMemoryFrameSink> frame_sink;
+
+    std::string socket_path;
+    int listen_fd;
+    std::vector<Client> clients;
+    std::atomic_bool running;
+
+    uint8_t joypad_state;
+    uint64_t frames_run;
+    std::unordered_map<std::string, std::vector<uint8_t>> snapshots;
+};
+
+#endif // GBC_SERVER_H
@@ -8,6 +8,7 @@
 #include "Debug.h"
 #include "Tile.h"
 #include "CartridgeReader.h"
+#include <algorithm>
 
 GPU::GPU(std::shared_ptr<spdlog::logger> _logger)
     : logger(_logger)
@@ -23,6 +24,20 @@ GPU::GPU(std::shared_ptr<spdlog::logger> _logger)
     render_full_frame = false;
 
 	lcd_control = 0;
+    lcd_status = 0;
+    window_y_pos = 0;
+    window_x_pos = 0;
+    bg_palette = 0;
+    object_pallete0 = 0;
+    object_pallete1 = 0;
+    oam_dma = 0;
+    hdma1 = hdma2 = hdma3 = hdma4 = hdma5 = 0;
+    object_size = 8;
+    window_display_enable = false;
+    object_display_enable = false;
+    enable_lcd_y_compare_interrupt = false;
+    cgb_background_palette_data.fill(0);
+    cgb_sprite_palette_data.fill(0);
 
 	vram_banks.resize(num_vram_banks, std::vector<unsigned char>(VRAM_SIZE, 0));
 	object_attribute_memory.resize(OAM_SIZE);
@@ -59,18 +74,38 @@ GPU::GPU(std::shared_ptr<spdlog::logger> _logger)
     bg_tiles_updated = false;
 
     objects_pos_to_use.resize(OAM_NUM_SPRITES);
+
+    render_line = &GPU::renderScanline<false>;
+
+    cgb_palette_generations.fill(0);
+    rendering_enabled = true;
+    pipelined_rendering = false;    // Frontends turn it on, headless emulators are usually run many to a core
+    stop_render_thread = false;
+    lines_queued = 0;
+    lines_rendered = 0;
+
+    observation = {};
+    observation_enabled = false;
+    downscale_rows_done = 0;
+    memset(frame_shades, 0, sizeof(frame_shades));
 }
 
 
 GPU::~GPU()
 {
+    stopRenderThread();
     memory.reset();
     logger.reset();
 }
 
 GPU& GPU::operator=(const GPU& rhs)
-{   // Copy from rhs
+{   // Wait for both GPUs to finish drawing queued lines
+    finishRendering();
+    const_cast<GPU&>(rhs).finishRendering();
+
+    // Copy from rhs
     is_color_gb         = rhs.is_color_gb;
+    render_line         = rhs.render_line;
     num_vram_banks      = rhs.num_vram_banks;
     curr_vram_bank      = rhs.curr_vram_bank;
     ticks_accumulated   = rhs.ticks_accumulated;
@@ -109,6 +144,7 @@ GPU& GPU::operator=(const GPU& rhs)
     cgb_sprite_palette_data         = rhs.cgb_sprite_palette_data;
     cgb_bg_to_oam_priority_array    = rhs.cgb_bg_to_oam_priority_array;
     cgb_bg_scanline_color_palettes  = rhs.cgb_bg_scanline_color_palettes;
+    cgb_palette_generations         = rhs.cgb_palette_generations;
 
     hdma1 = rhs.hdma1;
     hdma2 = rhs.hdma2;
@@ -134,11 +170,181 @@ GPU& GPU::operator=(const GPU& rhs)
     memcpy(object_palette0_color, rhs.object_palette0_color, PALETTE_DATA_SIZE * sizeof(SDL_Color));
     memcpy(object_palette1_color, rhs.object_palette1_color, PALETTE_DATA_SIZE * sizeof(SDL_Color));
 
+    // Tiles and palettes have been replaced, drop all pre-colored tiles
+    tile_color_cache.clear();
+
     return *this;
 }
 
+void GPU::saveState(StateWriter & state)
+{
+    finishRendering();
+
+    state.write(gpu_mode);
+    state.write(frame_is_ready);
+    state.write(render_full_frame);
+    state.write(cgb_dma_in_progress);
+    state.write(cgb_dma_hblank_in_progress);
+    state.write(curr_vram_bank);
+    state.write(ticks_accumulated);
+    state.write(y_roll_over);
+
+    // LCD registers
+    state.write(lcd_control);
+    state.write(lcd_status);
+    state.write(scroll_y);
+    state.write(scroll_x);
+    state.write(lcd_y);
+    state.write(lcd_y_compare);
+    state.write(window_y_pos);
+    state.write(window_x_pos);
+    state.write(bg_palette);
+    state.write(object_pallete0);
+    state.write(object_pallete1);
+    state.write(cgb_background_palette_index);
+    state.write(cgb_sprite_palette_index);
+    state.write(cgb_auto_increment_background_palette_index);
+    state.write(cgb_auto_increment_sprite_palette_index);
+    state.write(cgb_background_palette_data);
+    state.write(cgb_sprite_palette_data);
+    state.write(oam_dma);
+    state.write(hdma1);
+    state.write(hdma2);
+    state.write(hdma3);
+    state.write(hdma4);
+    state.write(hdma5);
+    state.write(cgb_dma_transfer_bytes_left);
+
+    // LCD Control and Status Register objects
+    state.write(window_tile_map_display_select);
+    state.write(bg_tile_data_select);
+    state.write(bg_tile_map_select);
+    state.write(bg_tile_data_select_method);
+    state.write(bg_tile_map_select_method);
+    state.write(object_size);
+    state.write(lcd_display_enable);
+    state.write(window_display_enable);
+    state.write(object_display_enable);
+    state.write(bg_display_enable);
+    state.write(enable_lcd_y_compare_interrupt);
+    state.write(lcd_status_interrupt_signal);
+    state.write(wait_frame_to_render_window);
+
+    for (const std::vector<unsigned char> & bank : vram_banks)
+    {
+        state.writeVector(bank);
+    }
+    state.writeVector(object_attribute_memory);
+    state.writeVector(objects_pos_to_use);
+
+    state.write(frame);
+    state.write(curr_frame);
+}
+
+void GPU::loadState(StateReader & state)
+{
+    finishRendering();
+
+    state.read(gpu_mode);
+    state.read(frame_is_ready);
+    state.read(render_full_frame);
+    state.read(cgb_dma_in_progress);
+    state.read(cgb_dma_hblank_in_progress);
+    state.read(curr_vram_bank);
+    state.read(ticks_accumulated);
+    state.read(y_roll_over);
+
+    // LCD registers
+    state.read(lcd_control);
+    state.read(lcd_status);
+    state.read(scroll_y);
+    state.read(scroll_x);
+    state.read(lcd_y);
+    state.read(lcd_y_compare);
+    state.read(window_y_pos);
+    state.read(window_x_pos);
+    state.read(bg_palette);
+    state.read(object_pallete0);
+    state.read(object_pallete1);
+    state.read(cgb_background_palette_index);
+    state.read(cgb_sprite_palette_index);
+    state.read(cgb_auto_increment_background_palette_index);
+    state.read(cgb_auto_increment_sprite_palette_index);
+    state.read(cgb_background_palette_data);
+    state.read(cgb_sprite_palette_data);
+    state.read(oam_dma);
+    state.read(hdma1);
+    state.read(hdma2);
+    state.read(hdma3);
+    state.read(hdma4);
+    state.read(hdma5);
+    state.read(cgb_dma_transfer_bytes_left);
+
+    // LCD Control and Status Register objects
+    state.read(window_tile_map_display_select);
+    state.read(bg_tile_data_select);
+    state.read(bg_tile_map_select);
+    state.read(bg_tile_data_select_method);
+    state.read(bg_tile_map_select_method);
+    state.read(object_size);
+    state.read(lcd_display_enable);
+    state.read(window_display_enable);
+    state.read(object_display_enable);
+    state.read(bg_display_enable);
+    state.read(enable_lcd_y_compare_interrupt);
+    state.read(lcd_status_interrupt_signal);
+    state.read(wait_frame_to_render_window);
+
+    for (std::vector<unsigned char> & bank : vram_banks)
+    {
+        state.readVector(bank);
+    }
+    state.readVector(object_attribute_memory);
+    state.readVector(objects_pos_to_use);
+
+    {
+        std::lock_guard<std::mutex> lg(frame_mutex);
+        state.read(frame);
+        state.read(curr_frame);
+    }
+
+    // Decode tiles from VRAM's tile data
+    for (int bank = 0; bank < num_vram_banks; bank++)
+    {
+        for (uint8_t tile_block_num = 0; tile_block_num < NUM_BG_TILE_BLOCKS; tile_block_num++)
+        {
+            for (int tile_num = 0; tile_num < NUM_BG_TILES_PER_BLOCK; tile_num++)
+            {
+                const size_t vram_pos = (0x800 * tile_block_num) + (tile_num * NUM_BYTES_PER_TILE);
+                bg_tiles[bank][tile_block_num][tile_num].setRawData(&vram_banks[bank][vram_pos]);
+            }
+        }
+    }
+
+    // Palette colors
+    for (uint8_t i = 0; i < CGB_PALETTE_DATA_SIZE_RAW; i++)
+    {
+        cgb_background_palettes[i / 8].updateRawByte(i % 8, cgb_background_palette_data[i]);
+        cgb_sprite_palettes[i / 8].updateRawByte(i % 8, cgb_sprite_palette_data[i]);
+    }
+    for (uint32_t & generation : cgb_palette_generations)
+    {
+        generation++;
+    }
+    set_color_palette(bg_palette_color, bg_palette);
+    set_color_palette(object_palette0_color, object_pallete0, true);
+    set_color_palette(object_palette1_color, object_pallete1, true);
+
+    is_cgb_tile_palette_updated = true;
+    is_tile_palette_updated = true;
+    bg_tiles_updated = true;
+    tile_color_cache.clear();
+}
+
 void GPU::init_color_gb()
 {
+    finishRendering();
+
     is_color_gb = true;
 	num_vram_banks = 2;
 	vram_banks.resize(num_vram_banks, std::vector<unsigned char>(VRAM_SIZE, 0));
@@ -157,6 +363,11 @@ void GPU::init_color_gb()
 
     // Reset DMG-only variable
     curr_opt_gb_palette = CGBPaletteCombo::NONE;
+
+    // Use CGB renderer
+    render_line = &GPU::renderScanline<true>;
+
+    tile_color_cache.clear();
 }
 
 std::uint8_t GPU::readByte(const uint16_t& pos, const bool limit_access) const
@@ -278,6 +489,9 @@ void GPU::setByte(const uint16_t& pos, const uint8_t& val, const bool limit_acce
             return;
         }
 
+        // Queued lines read VRAM and tiles directly
+        finishRendering();
+
 		vram_banks[curr_vram_bank % num_vram_banks][pos - 0x8000] = val;
 
 		// Background Tile Data: 0x8000 - 0x97FF
@@ -679,6 +893,7 @@ void GPU::update_lcd_status_coincidence_flag()
 }
 
 // Draws the 256x256 pixel Background to bg_frame[]
+template <bool is_cgb>
 void GPU::renderFullBackgroundMap()
 {
     int tile_map_vram_offset = bg_tile_map_select.start - 0x8000;
@@ -693,8 +908,6 @@ void GPU::renderFullBackgroundMap()
     uint16_t row_pixel_offset;
     uint16_t use_row;
     uint8_t use_col;
-    uint8_t pixel_use_row;
-    uint8_t pixel_use_col;
 
     // CGB variables
     uint8_t cgb_tile_attributes = 0;
@@ -711,7 +924,7 @@ void GPU::renderFullBackgroundMap()
         // Get tile number from tile map
         use_tile_num = vram_banks[0][map_tile_num_offset];
 
-        if (is_color_gb)
+        if constexpr (is_cgb)
         {   // Get Tile's attributes
             cgb_tile_attributes = vram_banks[1][map_tile_num_offset];
 
@@ -724,10 +937,10 @@ void GPU::renderFullBackgroundMap()
         }
 
         // Find which tile block should be used
-        tile_block_num = getTileBlockNum(use_tile_num);
+        tile_block_num = getTileBlockNum(use_tile_num, bg_tile_data_select_method);
 
         // Get the tile
-        if (is_color_gb)
+        if constexpr (is_cgb)
         {
             tile = getTileFromBGTiles(cgb_tile_vram_bank_num, tile_block_num, use_tile_num);
         }
@@ -744,39 +957,31 @@ void GPU::renderFullBackgroundMap()
         {
             use_row = (row * 256) + row_pixel_offset; // (0..65535)
 
-            for (uint8_t col = 0; col < 8; col++)
-            {
-                use_col = col + ((tile_map_pos * 8) & 255); // (0..255)
-
-                pixel_use_col = col;
-                pixel_use_row = row;
+            if constexpr (is_cgb)
+            {   // Copy pre-colored row, flips are already applied
+                const SDL_Color * cgb_color_row = tile_color_cache.getRow(*tile, cgb_tile_vram_bank_num,
+                    getTileIndex(tile_block_num, use_tile_num),
+                    cgb_background_palettes[cgb_bg_palette_num], cgb_bg_palette_num,
+                    cgb_palette_generations[cgb_bg_palette_num], false,
+                    cgb_horizontal_flip, cgb_vertical_flip, row);
 
-                // Check if tile needs to be drawn flipped
-                if (is_color_gb)
+                for (uint8_t col = 0; col < 8; col++)
                 {
-                    if (cgb_vertical_flip)
-                    {   // Vertically mirrored
-                        pixel_use_row = 7 - row;
-                    }
-
-                    if (cgb_horizontal_flip)
-                    {   // Horizontally mirrored
-                        pixel_use_col = 7 - col;
-                    }
+                    use_col = col + ((tile_map_pos * 8) & 255); // (0..255)
+                    bg_frame[use_col + use_row] = cgb_color_row[col];
                 }
+                continue;
+            }
+
+            for (uint8_t col = 0; col < 8; col++)
+            {
+                use_col = col + ((tile_map_pos * 8) & 255); // (0..255)
 
                 // Get individual pixel color
-                pixel_color = tile_data[pixel_use_col + (pixel_use_row * 8)];
+                pixel_color = tile_data[col + (row * 8)];
 
                 // Set pixel in frame
-                if (is_color_gb)
-                {
-                    bg_frame[use_col + use_row] = cgb_background_palettes[cgb_bg_palette_num].getColor(pixel_color);
-                }
-                else
-                {
-                    bg_frame[use_col + use_row] = bg_palette_color[pixel_color];
-                }
+                bg_frame[use_col + use_row] = bg_palette_color[pixel_color];
             }
         }
     }
@@ -825,17 +1030,17 @@ void GPU::drawShownBackgroundArea()
     }
 }
 
-void GPU::drawBackgroundLine()
+template <bool is_cgb>
+void GPU::drawBackgroundLine(const LineState& line)
 {
     Tile * tile;
     uint16_t tile_map_offset;
     uint16_t use_tile_num;
     uint8_t tile_block_num;
     uint8_t curr_tile_col;
-    uint8_t pixel_use_row;
-    uint8_t pixel_use_col;
 
     // CGB variables
+    const SDL_Color * cgb_color_row = NULL;
     uint8_t cgb_tile_attributes = 0;
     uint8_t cgb_bg_palette_num;
     bool cgb_tile_vram_bank_num = 0;
@@ -844,15 +1049,15 @@ void GPU::drawBackgroundLine()
     bool cgb_bg_to_OAM_priority;
 
     // Calculate which row of the Tile we're in (0..7)
-    const uint8_t curr_tile_row = (lcd_y + scroll_y) & 0x07;
+    const uint8_t curr_tile_row = (line.lcd_y + line.scroll_y) & 0x07;
 
     // Get VRAM offset for which set of tiles to use
-    const uint16_t tile_map_vram_offset = bg_tile_map_select.start - 0x8000;
+    const uint16_t tile_map_vram_offset = line.bg_tile_map_select.start - 0x8000;
 
-    uint8_t use_pixel_x = scroll_x;
-    const uint8_t use_pixel_y = scroll_y + lcd_y;     // Will rollover naturally due to uint8 (0..255)
+    uint8_t use_pixel_x = line.scroll_x;
+    const uint8_t use_pixel_y = line.scroll_y + line.lcd_y;     // Will rollover naturally due to uint8 (0..255)
 
-    const uint16_t frame_y_offset = lcd_y * SCREEN_PIXEL_W;
+    const uint16_t frame_y_offset = line.lcd_y * SCREEN_PIXEL_W;
 
     // Draw scanline
     std::lock_guard<std::mutex> lg(frame_mutex);
@@ -864,7 +1069,7 @@ void GPU::drawBackgroundLine()
         // Get tile number from tile map
         use_tile_num = vram_banks[0][tile_map_vram_offset + tile_map_offset];
 
-        if (is_color_gb)
+        if constexpr (is_cgb)
         {   // Get Tile's attributes
             cgb_tile_attributes = vram_banks[1][tile_map_vram_offset + tile_map_offset];
 
@@ -880,18 +1085,18 @@ void GPU::drawBackgroundLine()
         }
 
         // Find which tile memory block should be used
-        tile_block_num = getTileBlockNum(use_tile_num);
+        tile_block_num = getTileBlockNum(use_tile_num, line.bg_tile_data_select_method);
 
         // Get the tile
-        if (is_color_gb)
+        if constexpr (is_cgb)
         {
             tile = getTileFromBGTiles(cgb_tile_vram_bank_num, tile_block_num, use_tile_num);
 
             // Save tile's most recent used ColorPalette
-            tile->setCGBColorPalette(&cgb_background_palettes[cgb_bg_palette_num]);
+            tile->setCGBColorPalette(&line.cgb_background_palettes[cgb_bg_palette_num]);
 
             // Keep track of ColorPalette used at this pixel in the scanline
-            cgb_bg_scanline_color_palettes[frame_x] = &cgb_background_palettes[cgb_bg_palette_num];
+            cgb_bg_scanline_color_palettes[frame_x] = &line.cgb_background_palettes[cgb_bg_palette_num];
         }
         else
         {
@@ -899,27 +1104,7 @@ void GPU::drawBackgroundLine()
         }
 
         // Calculate which col of the Tile we're in (0..7)
-        curr_tile_col = (scroll_x + frame_x) & 0x07;
-
-        pixel_use_row = curr_tile_row;
-        pixel_use_col = curr_tile_col;
-
-        // Check if tile needs to be drawn flipped
-        if (is_color_gb)
-        {
-            if (cgb_vertical_flip)
-            {   // Vertically mirrored
-                pixel_use_row = 7 - curr_tile_row;
-            }
-
-            if (cgb_horizontal_flip)
-            {   // Horizontally mirrored
-                pixel_use_col = 7 - curr_tile_col;
-            }
-        }
-
-        // Get pixel
-        const uint8_t & pixel = tile->getPixel(pixel_use_row, pixel_use_col);
+        curr_tile_col = (line.scroll_x + frame_x) & 0x07;
 
         if (frame_x + frame_y_offset > SCREEN_PIXEL_TOTAL)
         {
@@ -931,13 +1116,24 @@ void GPU::drawBackgroundLine()
         }
 
         // Draw pixel
-        if (is_color_gb)
-        {
-            frame[frame_x + frame_y_offset] = cgb_background_palettes[cgb_bg_palette_num].getColor(pixel);
+        if constexpr (is_cgb)
+        {   // Get pre-colored row once per tile, flips are already applied
+            if (cgb_color_row == NULL || curr_tile_col == 0)
+            {
+                cgb_color_row = tile_color_cache.getRow(*tile, cgb_tile_vram_bank_num,
+                    getTileIndex(tile_block_num, use_tile_num),
+                    line.cgb_background_palettes[cgb_bg_palette_num], cgb_bg_palette_num,
+                    line.cgb_palette_generations[cgb_bg_palette_num], false,
+                    cgb_horizontal_flip, cgb_vertical_flip, curr_tile_row);
+            }
+
+            frame[frame_x + frame_y_offset] = cgb_color_row[curr_tile_col];
         }
         else
         {
-            frame[frame_x + frame_y_offset] = bg_palette_color[pixel];
+            const uint8_t & pixel = tile->getPixel(curr_tile_row, curr_tile_col);
+            frame[frame_x + frame_y_offset] = line.bg_palette_color[pixel];
+            frame_shades[frame_x + frame_y_offset] = (line.bg_palette >> (pixel * 2)) & 0x03;
         }
 
         // Will rollover naturally due to uint8 (0..255)
@@ -945,18 +1141,18 @@ void GPU::drawBackgroundLine()
     }
 }
 
-void GPU::drawWindowLine()
+template <bool is_cgb>
+void GPU::drawWindowLine(const LineState& line)
 {
     Tile * tile;
     uint16_t tile_map_offset;
     uint16_t use_tile_num;
     uint8_t tile_block_num;
     uint8_t curr_tile_col;
-    uint8_t pixel_use_row;
-    uint8_t pixel_use_col;
     uint8_t use_pixel_x;;
 
     // CGB variables
+    const SDL_Color * cgb_color_row = NULL;
     uint8_t cgb_tile_attributes = 0;
     uint8_t cgb_bg_palette_num;
     bool cgb_tile_vram_bank_num = 0;
@@ -965,22 +1161,22 @@ void GPU::drawWindowLine()
     bool cgb_bg_to_OAM_priority;
 
     // Calculate which row of the Tile we're in (0..7)
-    uint8_t curr_tile_row = (lcd_y - window_y_pos) & 0x07;
+    uint8_t curr_tile_row = (line.lcd_y - line.window_y_pos) & 0x07;
 
     // Get VRAM offset for which set of tiles to use
-    uint16_t tile_map_vram_offset = window_tile_map_display_select.start - 0x8000;
+    uint16_t tile_map_vram_offset = line.window_tile_map_display_select.start - 0x8000;
 
-    uint8_t pixel_x_start = window_x_pos - 7;
-    uint8_t use_pixel_y = lcd_y - window_y_pos;     // Will rollover naturally due to uint8 (0..255)
+    uint8_t pixel_x_start = line.window_x_pos - 7;
+    uint8_t use_pixel_y = line.lcd_y - line.window_y_pos;     // Will rollover naturally due to uint8 (0..255)
 
-    uint16_t frame_y_offset = lcd_y * SCREEN_PIXEL_W;
+    uint16_t frame_y_offset = line.lcd_y * SCREEN_PIXEL_W;
 
     //if (use_pixel_y > SCREEN_PIXEL_H)
     //{
     //    use_pixel_y -= SCREEN_PIXEL_H;
     //}
 
-    if (window_x_pos < 7)
+    if (line.window_x_pos < 7)
     {
         pixel_x_start = 0;
     }
@@ -990,17 +1186,17 @@ void GPU::drawWindowLine()
     //    return;
     //}
 
-    if (window_x_pos >= 167)
+    if (line.window_x_pos >= 167)
     {
         return;
     }
 
-    if (window_y_pos >= SCREEN_PIXEL_H)
+    if (line.window_y_pos >= SCREEN_PIXEL_H)
     {
         return;
     }
 
-    if (window_y_pos > lcd_y)
+    if (line.window_y_pos > line.lcd_y)
     {
         return;
     }
@@ -1026,7 +1222,7 @@ void GPU::drawWindowLine()
         // Get tile number from tile map
         use_tile_num = vram_banks[0][tile_map_vram_offset + tile_map_offset];
 
-        if (is_color_gb)
+        if constexpr (is_cgb)
         {   // Get Tile's attributes
             cgb_tile_attributes = vram_banks[1][tile_map_vram_offset + tile_map_offset];
 
@@ -1042,18 +1238,18 @@ void GPU::drawWindowLine()
         }
 
         // Find which tile memory block should be used
-        tile_block_num = getTileBlockNum(use_tile_num);
+        tile_block_num = getTileBlockNum(use_tile_num, line.bg_tile_data_select_method);
 
         // Get the tile
-        if (is_color_gb)
+        if constexpr (is_cgb)
         {
             tile = getTileFromBGTiles(cgb_tile_vram_bank_num, tile_block_num, use_tile_num);
 
             // Save tile's most recent used ColorPalette
-            tile->setCGBColorPalette(&cgb_background_palettes[cgb_bg_palette_num]);
+            tile->setCGBColorPalette(&line.cgb_background_palettes[cgb_bg_palette_num]);
 
             // Keep track of ColorPalette used at this pixel in the scanline
-            cgb_bg_scanline_color_palettes[frame_x] = &cgb_background_palettes[cgb_bg_palette_num];
+            cgb_bg_scanline_color_palettes[frame_x] = &line.cgb_background_palettes[cgb_bg_palette_num];
         }
         else
         {
@@ -1063,39 +1259,31 @@ void GPU::drawWindowLine()
         // Calculate which col of the Tile we're in (0..7)
         curr_tile_col = use_pixel_x & 0x07;
 
-        pixel_use_col = curr_tile_col;
-        pixel_use_row = curr_tile_row;
-
-        // Check if tile needs to be drawn flipped
-        if (is_color_gb)
-        {
-            if (cgb_vertical_flip)
-            {   // Vertically mirrored
-                pixel_use_row = 7 - curr_tile_row;
-            }
-
-            if (cgb_horizontal_flip)
-            {   // Horizontally mirrored
-                pixel_use_col = 7 - curr_tile_col;
+        // Draw pixel
+        if constexpr (is_cgb)
+        {   // Get pre-colored row once per tile, flips are already applied
+            if (cgb_color_row == NULL || curr_tile_col == 0)
+            {
+                cgb_color_row = tile_color_cache.getRow(*tile, cgb_tile_vram_bank_num,
+                    getTileIndex(tile_block_num, use_tile_num),
+                    line.cgb_background_palettes[cgb_bg_palette_num], cgb_bg_palette_num,
+                    line.cgb_palette_generations[cgb_bg_palette_num], false,
+                    cgb_horizontal_flip, cgb_vertical_flip, curr_tile_row);
             }
-        }
-
-        // Get pixel
-        const uint8_t & pixel = tile->getPixel(pixel_use_row, pixel_use_col);
 
-        // Draw pixel
-        if (is_color_gb)
-        {
-            frame[frame_x + frame_y_offset] = cgb_background_palettes[cgb_bg_palette_num].getColor(pixel);
+            frame[frame_x + frame_y_offset] = cgb_color_row[curr_tile_col];
         }
         else
         {
-            frame[frame_x + frame_y_offset] = bg_palette_color[pixel];
+            const uint8_t & pixel = tile->getPixel(curr_tile_row, curr_tile_col);
+            frame[frame_x + frame_y_offset] = line.bg_palette_color[pixel];
+            frame_shades[frame_x + frame_y_offset] = (line.bg_palette >> (pixel * 2)) & 0x03;
         }
     }
 }
 
-void GPU::drawOAMLine()
+template <bool is_cgb>
+void GPU::drawOAMLine(const LineState& line)
 {
     Tile * tile;
     std::uint8_t curr_sprite;
@@ -1108,14 +1296,15 @@ void GPU::drawOAMLine()
     bool object_behind_bg, sprite_y_flip, sprite_x_flip, sprite_palette_num;
     uint8_t sprite_y_start, sprite_y_end;
     uint8_t num_x_pixels_to_draw = 8;
+    const SDL_Color * cgb_color_row = NULL;
 
     pixel_x = pixel_y = 0;
 
-    uint16_t frame_y_offset = lcd_y * SCREEN_PIXEL_W;
+    uint16_t frame_y_offset = line.lcd_y * SCREEN_PIXEL_W;
 
-    if (!is_color_gb)
+    if constexpr (!is_cgb)
     {   // Sort OAM objects by X position (largest = lower priority = draw first)
-        sortNonCGBOAMSpriteOrder();
+        sortNonCGBOAMSpriteOrder(line.object_attribute_memory);
     }
 
     std::lock_guard<std::mutex> lg(frame_mutex);
@@ -1130,26 +1319,26 @@ void GPU::drawOAMLine()
 
         // Parse current sprite's 4 bytes of data
         curr_sprite     = i / 4;
-        sprite_y        = object_attribute_memory[i] - 16;
-        sprite_x        = object_attribute_memory[i + 1] - 8;
-        sprite_tile_num = object_attribute_memory[i + 2];
-        byte3           = object_attribute_memory[i + 3];
+        sprite_y        = line.object_attribute_memory[i] - 16;
+        sprite_x        = line.object_attribute_memory[i + 1] - 8;
+        sprite_tile_num = line.object_attribute_memory[i + 2];
+        byte3           = line.object_attribute_memory[i + 3];
 
         object_behind_bg    = byte3 & BIT7;
         sprite_y_flip       = byte3 & BIT6;
         sprite_x_flip       = byte3 & BIT5;
         sprite_palette_num  = byte3 & BIT4; // Non CGB Mode only
 
-        if (is_color_gb)
+        if constexpr (is_cgb)
         {
             cgb_tile_vram_bank_num = byte3 & BIT3;
             cgb_sprite_palette_num = byte3 & 0x07;
         }
 
         // Calculate sprite_y_start and sprite_y_end
-        sprite_y_end = sprite_y + object_size;  // Will naturally roll over
+        sprite_y_end = sprite_y + line.object_size;  // Will naturally roll over
         
-        if (object_attribute_memory[i] < 16)
+        if (line.object_attribute_memory[i] < 16)
         {
             sprite_y_start = 0;
         }
@@ -1166,7 +1355,7 @@ void GPU::drawOAMLine()
         }
 
         // Check to see if sprite is rendered on current line (Y position)
-        if (sprite_y_start <= lcd_y && sprite_y_end > lcd_y)
+        if (sprite_y_start <= line.lcd_y && sprite_y_end > line.lcd_y)
         {
 
             //logger->info("Drawing OAM sprite: %{0:d},\tlcd_y: %{1:d}",
@@ -1175,9 +1364,9 @@ void GPU::drawOAMLine()
 
             // Check for case of object_size = 16, ie sprite size is 8x16
             // Then check if we should be using the next sprite 8x8 sprite to draw
-            if (object_size == 16)
+            if (line.object_size == 16)
             {
-                uint8_t curr_sprite_y = lcd_y - sprite_y;
+                uint8_t curr_sprite_y = line.lcd_y - sprite_y;
 
                 // the sprite is not flipped and
                 // curr_sprite_y > 7
@@ -1199,12 +1388,19 @@ void GPU::drawOAMLine()
             tile_block_num = getSpriteTileBlockNum(sprite_tile_num);
 
             // Get the tile
-            if (is_color_gb)
+            if constexpr (is_cgb)
             {
                 tile = getTileFromBGTiles(cgb_tile_vram_bank_num, tile_block_num, sprite_tile_num);
 
                 // Save tile's most recent used ColorPalette
-                tile->setCGBColorPalette(&cgb_sprite_palettes[cgb_sprite_palette_num]);
+                tile->setCGBColorPalette(&line.cgb_sprite_palettes[cgb_sprite_palette_num]);
+
+                // Get pre-colored row, flips are already applied
+                cgb_color_row = tile_color_cache.getRow(*tile, cgb_tile_vram_bank_num,
+                    getTileIndex(tile_block_num, sprite_tile_num),
+                    line.cgb_sprite_palettes[cgb_sprite_palette_num], cgb_sprite_palette_num,
+                    line.cgb_palette_generations[8 + cgb_sprite_palette_num], true,
+                    sprite_x_flip, sprite_y_flip, (line.lcd_y - sprite_y) & 0x07);
             }
             else
             {
@@ -1229,7 +1425,7 @@ void GPU::drawOAMLine()
 
                 // Check if pixel should be drawn due to object_behind_bg flag
                 // or CGB's object_behind_bg flag
-                if (is_color_gb)
+                if constexpr (is_cgb)
                 {   // Ensure that we have a BG palette present
                     if (cgb_bg_scanline_color_palettes[use_x])
                     {
@@ -1253,22 +1449,35 @@ void GPU::drawOAMLine()
                 }
                 else if (object_behind_bg)
                 {   // Non-CGB handling
-                    bg_is_color_0 = SDLColorsAreEqual(curr_frame_pixel, bg_palette_color[0]);
+                    bg_is_color_0 = SDLColorsAreEqual(curr_frame_pixel, line.bg_palette_color[0]);
                     if (bg_is_color_0 == false)
                     {   // Current BG pixel == color 1, 2, or 3 - don't draw sprite here
                         continue;
                     }
                 }
 
+                if constexpr (is_cgb)
+                {   // Draw sprite in color
+                    const SDL_Color & sprite_color = cgb_color_row[x];
+
+                    if (sprite_color.a == 0)
+                    {
+                        continue;   // Color 0 == transparent == don't display
+                    }
+
+                    frame[use_x + frame_y_offset] = sprite_color;
+                    continue;
+                }
+
                 // Find out which col of the sprite to use for this pixel
                 pixel_x = x;
                 // Find out which row of the sprite to use for this line
-                pixel_y = lcd_y - sprite_y;
+                pixel_y = line.lcd_y - sprite_y;
 
                 // Check if sprite needs to be drawn flipped
                 if (sprite_y_flip)
                 {   // Vertically mirrored
-                    pixel_y = object_size - 1 - pixel_y;
+                    pixel_y = line.object_size - 1 - pixel_y;
                 }
 
                 if (sprite_x_flip)
@@ -1276,7 +1485,7 @@ void GPU::drawOAMLine()
                     pixel_x = 7 - pixel_x;
                 }
 
-                if (object_size == 16)
+                if (line.object_size == 16)
                 {
                     if (pixel_y > 7)
                     {
@@ -1292,21 +1501,16 @@ void GPU::drawOAMLine()
                     continue;   // Color 0 == transparent == don't display
                 }
 
-                // Draw sprite pixel to frame
-                if (is_color_gb)
-                {   // Draw sprite in color
-                    frame[use_x + frame_y_offset] = cgb_sprite_palettes[cgb_sprite_palette_num].getColor(pixel_color);
+                // Draw sprite in gray scale
+                if (sprite_palette_num == 0)
+                {
+                    frame[use_x + frame_y_offset] = line.object_palette0_color[pixel_color];
+                    frame_shades[use_x + frame_y_offset] = (line.object_palette0 >> (pixel_color * 2)) & 0x03;
                 }
                 else
-                {   // Draw sprite in gray scale
-                    if (sprite_palette_num == 0)
-                    {
-                        frame[use_x + frame_y_offset] = object_palette0_color[pixel_color];
-                    }
-                    else
-                    {
-                        frame[use_x + frame_y_offset] = object_palette1_color[pixel_color];
-                    }
+                {
+                    frame[use_x + frame_y_offset] = line.object_palette1_color[pixel_color];
+                    frame_shades[use_x + frame_y_offset] = (line.object_palette1 >> (pixel_color * 2)) & 0x03;
                 }
 
             } // end for(x)
@@ -1316,33 +1520,355 @@ void GPU::drawOAMLine()
 
 void GPU::renderLine()
 {
-    if (lcd_y > 144)
+    if (lcd_y >= SCREEN_PIXEL_H ||
+        !rendering_enabled)
     {
         return;
     }
 
     logger->debug("lcd_y: {}", lcd_y);
 
-    if (bg_display_enable)
+    if (!pipelined_rendering)
+    {   // DMG or CGB scanline renderer, selected once at cartridge load
+        captureLineState(inline_line_state);
+        (this->*render_line)(inline_line_state);
+        return;
+    }
+
+    if (!render_thread.joinable())
+    {
+        startRenderThread();
+    }
+
+    std::unique_lock<std::mutex> lk(render_mutex);
+
+    // Wait for a free LineState
+    render_cv.wait(lk, [this]() { return lines_queued - lines_rendered < line_states.size(); });
+    LineState & line = line_states[lines_queued % line_states.size()];
+
+    lk.unlock();
+    captureLineState(line);
+    lk.lock();
+
+    lines_queued++;
+    lk.unlock();
+    render_cv.notify_all();
+}
+
+void GPU::captureLineState(LineState& line) const
+{
+    line.lcd_y          = lcd_y;
+    line.scroll_y       = scroll_y;
+    line.scroll_x       = scroll_x;
+    line.window_y_pos   = window_y_pos;
+    line.window_x_pos   = window_x_pos;
+    line.object_size    = object_size;
+    line.bg_display_enable      = bg_display_enable;
+    line.window_display_enable  = window_display_enable;
+    line.object_display_enable  = object_display_enable;
+    line.wait_frame_to_render_window    = wait_frame_to_render_window;
+    line.bg_tile_data_select_method     = bg_tile_data_select_method;
+    line.window_tile_map_display_select = window_tile_map_display_select;
+    line.bg_tile_map_select             = bg_tile_map_select;
+    line.bg_palette         = bg_palette;
+    line.object_palette0    = object_pallete0;
+    line.object_palette1    = object_pallete1;
+
+    memcpy(line.bg_palette_color, bg_palette_color, PALETTE_DATA_SIZE * sizeof(SDL_Color));
+    memcpy(line.object_palette0_color, object_palette0_color, PALETTE_DATA_SIZE * sizeof(SDL_Color));
+    memcpy(line.object_palette1_color, object_palette1_color, PALETTE_DATA_SIZE * sizeof(SDL_Color));
+
+    if (is_color_gb)
     {
-        drawBackgroundLine();
+        line.cgb_background_palettes    = cgb_background_palettes;
+        line.cgb_sprite_palettes        = cgb_sprite_palettes;
+        line.cgb_palette_generations    = cgb_palette_generations;
     }
 
-    if (window_display_enable && !wait_frame_to_render_window)
+    std::copy(object_attribute_memory.begin(), object_attribute_memory.end(),
+        line.object_attribute_memory.begin());
+}
+
+void GPU::setPipelinedRendering(const bool& enable)
+{
+    if (enable == pipelined_rendering)
     {
-        drawWindowLine();
+        return;
     }
 
-    if (object_display_enable)
+    if (!enable)
     {
-        drawOAMLine();
+        stopRenderThread();
     }
 
-    if (is_color_gb)
+    pipelined_rendering = enable;
+    logger->info("Pipelined rendering: {}", pipelined_rendering);
+}
+
+bool GPU::isPipelinedRendering() const
+{
+    return pipelined_rendering;
+}
+
+void GPU::setRenderingEnabled(const bool& enable)
+{
+    rendering_enabled = enable;
+}
+
+bool GPU::isRenderingEnabled() const
+{
+    return rendering_enabled;
+}
+
+bool GPU::setFrameObservation(const FrameObservation& new_observation)
+{
+    if (new_observation.downscaled_luma &&
+        (new_observation.downscaled_w == 0 || new_observation.downscaled_w > SCREEN_PIXEL_W ||
+         new_observation.downscaled_h == 0 || new_observation.downscaled_h > SCREEN_PIXEL_H))
+    {
+        logger->error("Downscaled observation has to be 1x1 to {}x{}, not {}x{}", SCREEN_PIXEL_W, SCREEN_PIXEL_H,
+            new_observation.downscaled_w, new_observation.downscaled_h);
+        return false;
+    }
+
+    // Lines already queued may be writing to the old buffers
+    finishRendering();
+    observation = new_observation;
+    observation_enabled = observation.shades || observation.luma || observation.downscaled_luma;
+
+    if (observation.downscaled_luma)
+    {   // Source pixel x covers [x * w, (x + 1) * w) and downscaled pixel j covers [j * 160, (j + 1) * 160),
+        // so each source pixel is in one downscaled pixel or split between two
+        const uint16_t w = observation.downscaled_w;
+        const uint16_t h = observation.downscaled_h;
+        for (uint16_t x = 0; x < SCREEN_PIXEL_W; x++)
+        {
+            const uint16_t j = (x * w) / SCREEN_PIXEL_W;
+            downscale_col[x] = static_cast<uint8_t>(j);
+            downscale_col_weight[x] = static_cast<uint8_t>(std::min((x + 1) * w, (j + 1) * SCREEN_PIXEL_W) - x * w);
+        }
+        for (uint16_t y = 0; y < SCREEN_PIXEL_H; y++)
+        {
+            const uint16_t i = (y * h) / SCREEN_PIXEL_H;
+            downscale_row[y] = static_cast<uint8_t>(i);
+            downscale_row_weight[y] = static_cast<uint8_t>(std::min((y + 1) * h, (i + 1) * SCREEN_PIXEL_H) - y * h);
+        }
+        downscale_sums.assign(w * h, 0);
+        downscale_rows_done = 0;
+    }
+
+    return true;
+}
+
+void GPU::clearFrameObservation()
+{
+    finishRendering();
+    observation = {};
+    observation_enabled = false;
+}
+
+MemorySpan GPU::getVRAM(const int& bank) const
+{
+    if (bank < 0 || bank >= num_vram_banks)
+    {
+        return {};
+    }
+    return { vram_banks[bank].data(), vram_banks[bank].size() };
+}
+
+MemorySpan GPU::getOAM() const
+{
+    return { object_attribute_memory.data(), object_attribute_memory.size() };
+}
+
+int GPU::getNumVRAMBanks() const
+{
+    return num_vram_banks;
+}
+
+int GPU::getCurrentVRAMBank() const
+{
+    return curr_vram_bank % num_vram_banks;
+}
+
+void GPU::startRenderThread()
+{
+    line_states.resize(NUM_QUEUED_LINE_STATES);
+    lines_queued = 0;
+    lines_rendered = 0;
+    stop_render_thread = false;
+    render_thread = std::thread(&GPU::renderThreadLoop, this);
+}
+
+void GPU::stopRenderThread()
+{
+    if (!render_thread.joinable())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lg(render_mutex);
+        stop_render_thread = true;
+    }
+    render_cv.notify_all();
+    render_thread.join();
+}
+
+// Draws queued lines until stopped, all queued lines are drawn before exiting
+void GPU::renderThreadLoop()
+{
+    std::unique_lock<std::mutex> lk(render_mutex);
+
+    while (true)
+    {
+        render_cv.wait(lk, [this]() { return stop_render_thread || lines_rendered < lines_queued; });
+
+        if (lines_rendered == lines_queued)
+        {   // Stopping and nothing left to draw
+            break;
+        }
+
+        const LineState & line = line_states[lines_rendered % line_states.size()];
+
+        lk.unlock();
+        (this->*render_line)(line);
+        lk.lock();
+
+        lines_rendered++;
+        render_cv.notify_all();
+    }
+}
+
+// Waits for all queued lines to be drawn.
+// Must be called before changing state the render thread reads directly (VRAM, tiles, frame)
+void GPU::finishRendering()
+{
+    if (!render_thread.joinable())
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lk(render_mutex);
+    render_cv.wait(lk, [this]() { return lines_rendered == lines_queued; });
+}
+
+template <bool is_cgb>
+void GPU::renderScanline(const LineState& line)
+{
+    if (line.bg_display_enable)
+    {
+        drawBackgroundLine<is_cgb>(line);
+    }
+
+    if (line.window_display_enable && !line.wait_frame_to_render_window)
+    {
+        drawWindowLine<is_cgb>(line);
+    }
+
+    if (line.object_display_enable)
+    {
+        drawOAMLine<is_cgb>(line);
+    }
+
+    if constexpr (is_cgb)
     {   // Clear current scanline's background to OAM priority array
         cgb_bg_to_oam_priority_array.fill(0);
         cgb_bg_scanline_color_palettes.fill(NULL);
     }
+
+    if (observation_enabled)
+    {
+        writeObservationLine<is_cgb>(line.lcd_y);
+    }
+}
+
+template <bool is_cgb>
+void GPU::writeObservationLine(const uint8_t& line_y)
+{
+    const SDL_Color * frame_line = &frame[line_y * SCREEN_PIXEL_W];
+    for (int x = 0; x < SCREEN_PIXEL_W; x++)
+    {
+        const SDL_Color & color = frame_line[x];
+        observation_luma_line[x] = static_cast<uint8_t>((77 * color.r + 150 * color.g + 29 * color.b) >> 8);
+    }
+
+    if (observation.luma)
+    {
+        memcpy(&observation.luma[line_y * SCREEN_PIXEL_W], observation_luma_line.data(), SCREEN_PIXEL_W);
+    }
+
+    if (observation.shades)
+    {
+        uint8_t * shades_line = &observation.shades[line_y * SCREEN_PIXEL_W];
+        if constexpr (is_cgb)
+        {   // No shades in color, darker is higher like on DMG
+            for (int x = 0; x < SCREEN_PIXEL_W; x++)
+            {
+                shades_line[x] = (OBSERVATION_SHADES - 1) - (observation_luma_line[x] >> 6);
+            }
+        }
+        else
+        {
+            memcpy(shades_line, &frame_shades[line_y * SCREEN_PIXEL_W], SCREEN_PIXEL_W);
+        }
+    }
+
+    if (observation.downscaled_luma)
+    {
+        addDownscaledLine(line_y, observation_luma_line.data());
+    }
+}
+
+// Sums are weighted by the area of each source pixel inside each downscaled one,
+// a downscaled row is written out once the last line in it has been added
+void GPU::addDownscaledLine(const uint8_t& line_y, const uint8_t * luma_line)
+{
+    const uint16_t w = observation.downscaled_w;
+    const uint16_t h = observation.downscaled_h;
+
+    if (line_y == 0)
+    {   // Lines of a frame cut short by the LCD turning off are dropped
+        std::fill(downscale_sums.begin(), downscale_sums.end(), 0);
+        downscale_rows_done = 0;
+    }
+
+    const uint16_t row = downscale_row[line_y];
+    const uint32_t row_weights[2] = { downscale_row_weight[line_y], static_cast<uint32_t>(h - downscale_row_weight[line_y]) };
+    for (int r = 0; r < 2 && row + r < h; r++)
+    {
+        if (row_weights[r] == 0)
+        {
+            continue;
+        }
+
+        uint32_t * sums = &downscale_sums[(row + r) * w];
+        for (int x = 0; x < SCREEN_PIXEL_W; x++)
+        {
+            const uint32_t weighted = luma_line[x] * row_weights[r];
+            const uint16_t col = downscale_col[x];
+            sums[col] += weighted * downscale_col_weight[x];
+            if (col + 1 < w)
+            {
+                sums[col + 1] += weighted * (w - downscale_col_weight[x]);
+            }
+        }
+    }
+
+    // Every downscaled pixel covers SCREEN_PIXEL_W x SCREEN_PIXEL_H units
+    const uint32_t area = SCREEN_PIXEL_W * SCREEN_PIXEL_H;
+    while (downscale_rows_done < h &&
+        (downscale_rows_done + 1) * SCREEN_PIXEL_H <= (line_y + 1) * h)
+    {
+        uint32_t * sums = &downscale_sums[downscale_rows_done * w];
+        uint8_t * out = &observation.downscaled_luma[downscale_rows_done * w];
+        for (uint16_t j = 0; j < w; j++)
+        {
+            out[j] = static_cast<uint8_t>((sums[j] + area / 2) / area);
+            sums[j] = 0;
+        }
+        downscale_rows_done++;
+    }
 }
 
 uint16_t GPU::getTileMapNumber(const uint8_t& pixel_x, const uint8_t& pixel_y) const
@@ -1362,11 +1888,11 @@ uint16_t GPU::getTileMapNumber(const uint8_t& pixel_x, const uint8_t& pixel_y) c
     return tile_num;
 }
 
-uint8_t GPU::getTileBlockNum(const int& use_tile_num) const
+uint8_t GPU::getTileBlockNum(const int& use_tile_num, const bool& tile_data_select_method) const
 {
     uint8_t tile_block_num = 0;
 
-    if (bg_tile_data_select_method == 1)
+    if (tile_data_select_method == 1)
     {
         if (use_tile_num < 128)
         {
@@ -1391,6 +1917,12 @@ uint8_t GPU::getTileBlockNum(const int& use_tile_num) const
     return tile_block_num;
 }
 
+// Index of a tile within its VRAM bank (0..383)
+uint16_t GPU::getTileIndex(const uint8_t& tile_block_num, const int& use_tile_num) const
+{
+    return (tile_block_num * NUM_BG_TILES_PER_BLOCK) + (use_tile_num % NUM_BG_TILES_PER_BLOCK);
+}
+
 uint8_t GPU::getSpriteTileBlockNum(const int& use_tile_num) const
 {
     return use_tile_num / 128;
@@ -1445,7 +1977,9 @@ void GPU::run(const uint8_t & cpuTickDiff)
 
 			// Check if frame rendering has completed, start VBLANK interrupt
             if (lcd_y == 144)
-            {
+            {   // Frame's lines are all queued, wait for them to be drawn
+                finishRendering();
+
                 if (render_full_frame)
                 {
                     if (bg_frame.empty())
@@ -1453,7 +1987,14 @@ void GPU::run(const uint8_t & cpuTickDiff)
                         bg_frame.resize(TOTAL_SCREEN_PIXEL_W * TOTAL_SCREEN_PIXEL_H);
                     }
 
-                    renderFullBackgroundMap();
+                    if (is_color_gb)
+                    {
+                        renderFullBackgroundMap<true>();
+                    }
+                    else
+                    {
+                        renderFullBackgroundMap<false>();
+                    }
                 }
                 memory->interrupt_flag |= INTERRUPT_VBLANK;
                 set_lcd_status_mode_flag(GPU_MODE_VBLANK);
@@ -1477,6 +2018,7 @@ void GPU::run(const uint8_t & cpuTickDiff)
 
 			if (lcd_y > 153)
 			{   // Copy frame into curr_frame for use by external programs
+                finishRendering();
                 std::lock_guard<std::mutex> lg(frame_mutex);
                 std::memcpy(curr_frame, frame, sizeof(SDL_Color) * SCREEN_PIXEL_W * SCREEN_PIXEL_H);
                 frame_is_ready = true;
@@ -1559,6 +2101,7 @@ Tile * GPU::updateTile(const uint16_t& pos, const uint8_t& val,
 		byte_pos = pos - offset;
 		tile_num = std::floor(byte_pos / NUM_BYTES_PER_TILE);
 		tile = &bg_tiles[use_vram_bank][tile_block_num][tile_num];
+        tile_color_cache.invalidateTile(use_vram_bank, getTileIndex(tile_block_num, tile_num));
         /*if (tile_num == 2)
         {
             // Update byte_pos with correct offset
@@ -1575,6 +2118,11 @@ Tile * GPU::updateTile(const uint16_t& pos, const uint8_t& val,
     return tile;
 }
 
+const TileColorCacheStats& GPU::getTileColorCacheStats() const
+{
+    return tile_color_cache.getStats();
+}
+
 std::vector<std::vector<std::vector<Tile>>>& GPU::getBGTiles()
 {
     bg_tiles_updated = false;
@@ -1603,6 +2151,7 @@ void GPU::updateBackgroundPalette(const uint8_t& val)
 
     // Update color palette
     colorPalette.updateRawByte(cgb_background_palette_index % 8, val);
+    cgb_palette_generations[cgb_background_palette_index / 8]++;
 
     is_cgb_tile_palette_updated = true;
 
@@ -1618,6 +2167,7 @@ void GPU::updateSpritePalette(const uint8_t& val)
 
     // Update color palette
     colorPalette.updateRawByte(cgb_sprite_palette_index % 8, val);
+    cgb_palette_generations[8 + (cgb_sprite_palette_index / 8)]++;
 
     is_cgb_tile_palette_updated = true;
 
@@ -1627,7 +2177,7 @@ void GPU::updateSpritePalette(const uint8_t& val)
 }
 
 // Sorts OAM objects by X position (largest = lower priority = draw first)
-void GPU::sortNonCGBOAMSpriteOrder()
+void GPU::sortNonCGBOAMSpriteOrder(const std::array<unsigned char, OAM_SIZE>& oam)
 {
     std::vector<uint8_t> indices(OAM_NUM_SPRITES);
     std::vector<uint8_t> xPositions(OAM_NUM_SPRITES);
@@ -1635,7 +2185,7 @@ void GPU::sortNonCGBOAMSpriteOrder()
     // Get list of X positions
     for (int i = 0; i < OAM_NUM_SPRITES; i++)
     {
-        xPositions[i] = object_attribute_memory[(i * 4) + 1];
+        xPositions[i] = oam[(i * 4) + 1];
         indices[i] = i;
     }
 
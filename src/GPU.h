@@ -2,11 +2,16 @@
 #define GPU_H
 
 #include <array>
+#include <condition_variable>
 #include <unordered_map>
 #include <mutex>
+#include <thread>
 #include <vector>
-#include <SDL.h>
+#include <SDLTypes.h>
 #include "ColorPalette.h"
+#include "MemorySpan.h"
+#include "TileColorCache.h"
+#include "SaveState.h"
 #include <GetUniqueColorPalette.h>
 #include <spdlog/spdlog.h>
 
@@ -27,6 +32,10 @@
 #define TOTAL_SCREEN_TILE_H 32
 #define TOTAL_SCREEN_TILE_W 32
 
+#define NUM_QUEUED_LINE_STATES SCREEN_PIXEL_H
+
+#define OBSERVATION_SHADES 4
+
 class Memory;
 class Tile;
 
@@ -38,6 +47,38 @@ struct LCDSelect {
     uint16_t start, end;
 };
 
+// Everything needed to draw one scanline, captured when the line is rendered
+// so later register, palette and OAM writes don't affect it
+struct LineState {
+    uint8_t lcd_y;
+    uint8_t scroll_y, scroll_x;
+    uint8_t window_y_pos, window_x_pos;
+    uint8_t object_size;
+    bool bg_display_enable;
+    bool window_display_enable;
+    bool object_display_enable;
+    bool wait_frame_to_render_window;
+    bool bg_tile_data_select_method;
+    LCDSelect window_tile_map_display_select, bg_tile_map_select;
+    uint8_t bg_palette, object_palette0, object_palette1;
+    SDL_Color bg_palette_color[PALETTE_DATA_SIZE];
+    SDL_Color object_palette0_color[PALETTE_DATA_SIZE];
+    SDL_Color object_palette1_color[PALETTE_DATA_SIZE];
+    std::array<ColorPalette, 8> cgb_background_palettes;
+    std::array<ColorPalette, 8> cgb_sprite_palettes;
+    std::array<uint32_t, TILE_COLOR_CACHE_NUM_PALETTES> cgb_palette_generations;
+    std::array<unsigned char, OAM_SIZE> object_attribute_memory;
+};
+
+// Frame formats written out line by line as they're drawn, into buffers the caller owns,
+// row by row, one byte a pixel. Any can be nullptr. They're complete once frame_is_ready
+struct FrameObservation {
+    uint8_t * shades;               // SCREEN_PIXEL_TOTAL, 0 (lightest) - 3. The palette's shade on DMG, luma in 4 steps on CGB
+    uint8_t * luma;                 // SCREEN_PIXEL_TOTAL, (77 R + 150 G + 29 B) / 256
+    uint8_t * downscaled_luma;      // downscaled_w * downscaled_h, the average luma of the area each pixel covers
+    uint8_t downscaled_w, downscaled_h; // 1 - SCREEN_PIXEL_W and 1 - SCREEN_PIXEL_H
+};
+
 enum class CGBPaletteCombo : int {
     NONE,
     UP,
@@ -71,6 +112,10 @@ public:
     GPU(std::shared_ptr<spdlog::logger> logger);
     ~GPU();
     GPU& operator=(const GPU& rhs);
+    // Waits for queued lines to be drawn first
+    void saveState(StateWriter & state);
+    // Tiles and palette colors are rebuilt from VRAM and palette data, not stored
+    void loadState(StateReader & state);
 
     void init_color_gb();
     void run(const uint8_t & cpuTicks);
@@ -80,6 +125,22 @@ public:
     std::vector<std::vector<std::vector<Tile>>>& getBGTiles();
     const std::vector<int>& getUpdatedBGTileIndexes();
     void changeCGBPalette();
+    const TileColorCacheStats& getTileColorCacheStats() const;
+    // Draws lines on a render thread while the CPU runs on. Off by default
+    void setPipelinedRendering(const bool& enable);
+    bool isPipelinedRendering() const;
+    // Timing, interrupts and VRAM/OAM access are unchanged, lines just aren't drawn
+    void setRenderingEnabled(const bool& enable);
+    bool isRenderingEnabled() const;
+    // Returns false, keeping the last observation, if the downscaled size is out of range
+    bool setFrameObservation(const FrameObservation& observation);
+    void clearFrameObservation();
+    // VRAM and OAM as they are, without readByte()'s blocking during modes OAM and VRAM.
+    // Out of range banks give empty spans
+    MemorySpan getVRAM(const int& bank) const;
+    MemorySpan getOAM() const;
+    int getNumVRAMBanks() const;
+    int getCurrentVRAMBank() const;
 
     std::shared_ptr<Memory> memory;
     std::shared_ptr<spdlog::logger> logger;
@@ -105,11 +166,13 @@ private:
     void use_color_palette(const CGBROMPalette& wanted_palette);
     SDL_Color get_sdl_color(const uint32_t& color) const;
     void renderLine();
-    void drawBackgroundLine();
-    void drawWindowLine();
-    void drawOAMLine();
+    void captureLineState(LineState& line) const;
+    template <bool is_cgb> void renderScanline(const LineState& line);
+    template <bool is_cgb> void drawBackgroundLine(const LineState& line);
+    template <bool is_cgb> void drawWindowLine(const LineState& line);
+    template <bool is_cgb> void drawOAMLine(const LineState& line);
     uint16_t getTileMapNumber(const uint8_t& pixel_x, const uint8_t& pixel_y) const;
-    void renderFullBackgroundMap();
+    template <bool is_cgb> void renderFullBackgroundMap();
     void drawShownBackgroundArea();
     Tile * updateTile(const uint16_t& pos, const uint8_t& val, const bool& use_vram_bank, const uint8_t& tile_block_num);
     void set_lcd_control(const uint8_t& lcd_control);
@@ -121,16 +184,30 @@ private:
     CGBROMPalette get_cgb_rom_palette(const uint8_t& ref) const;
     uint8_t get_cgb_rom_palette_ref(const CGBPaletteCombo& ref) const;
 
-    uint8_t getTileBlockNum(const int& use_tile_num) const;
+    uint8_t getTileBlockNum(const int& use_tile_num, const bool& tile_data_select_method) const;
     uint8_t getSpriteTileBlockNum(const int& use_tile_num) const;
     Tile * getTileFromBGTiles(const uint8_t& use_vram_bank, const uint8_t& tile_block_num, const int& use_tile_num);
+    uint16_t getTileIndex(const uint8_t& tile_block_num, const int& use_tile_num) const;
 
     // Palette methods
     void updateBackgroundPalette(const uint8_t& val);
     void updateSpritePalette(const uint8_t& val);
 
     bool SDLColorsAreEqual(const SDL_Color & a, const SDL_Color & b);
-    void sortNonCGBOAMSpriteOrder();
+    void sortNonCGBOAMSpriteOrder(const std::array<unsigned char, OAM_SIZE>& oam);
+
+    // Pipelined rendering methods
+    void startRenderThread();
+    void stopRenderThread();
+    void renderThreadLoop();
+    void finishRendering();
+
+    // Frame observations
+    template <bool is_cgb> void writeObservationLine(const uint8_t& lcd_y);
+    void addDownscaledLine(const uint8_t& lcd_y, const uint8_t * luma_line);
+
+    // Scanline renderer, DMG or CGB
+    void (GPU::*render_line)(const LineState& line);
 
     int num_vram_banks;
     int curr_vram_bank;
@@ -156,7 +233,7 @@ private:
     std::array<unsigned char, CGB_PALETTE_DATA_SIZE_RAW> cgb_background_palette_data;
     std::array<unsigned char, CGB_PALETTE_DATA_SIZE_RAW> cgb_sprite_palette_data;
     std::array<bool, SCREEN_PIXEL_W> cgb_bg_to_oam_priority_array;
-    std::array<ColorPalette *, SCREEN_PIXEL_W> cgb_bg_scanline_color_palettes;
+    std::array<const ColorPalette *, SCREEN_PIXEL_W> cgb_bg_scanline_color_palettes;
 
     // LCD Object Attribute Memory DMA Transfers
     unsigned char oam_dma;
@@ -183,12 +260,42 @@ private:
     std::mutex frame_mutex;
 
     SDL_Color frame[SCREEN_PIXEL_W * SCREEN_PIXEL_H];
+    uint8_t frame_shades[SCREEN_PIXEL_W * SCREEN_PIXEL_H];   // DMG palette shade of each pixel in frame
 
     std::vector<std::vector<unsigned char>> vram_banks;
     std::vector<unsigned char> object_attribute_memory;
     std::vector<std::vector<std::vector<Tile>>> bg_tiles;
     std::vector<uint8_t> objects_pos_to_use;
 
+    // Pre-colored CGB tiles
+    TileColorCache tile_color_cache;
+    std::array<uint32_t, TILE_COLOR_CACHE_NUM_PALETTES> cgb_palette_generations;
+
+    bool rendering_enabled;
+
+    // Pipelined rendering, lines are drawn on render_thread from captured LineStates
+    bool pipelined_rendering;
+    bool stop_render_thread;
+    size_t lines_queued;
+    size_t lines_rendered;
+    LineState inline_line_state;
+    std::vector<LineState> line_states;
+    std::thread render_thread;
+    std::mutex render_mutex;
+    std::condition_variable render_cv;
+
+    // Frame observations, written by whichever thread draws the lines
+    FrameObservation observation;
+    bool observation_enabled;
+    std::array<uint8_t, SCREEN_PIXEL_W> observation_luma_line;
+    // Source pixels' share of the one or two downscaled pixels they fall in, in 1/SCREEN_PIXEL_W and 1/SCREEN_PIXEL_H
+    std::array<uint8_t, SCREEN_PIXEL_W> downscale_col;
+    std::array<uint8_t, SCREEN_PIXEL_W> downscale_col_weight;
+    std::array<uint8_t, SCREEN_PIXEL_H> downscale_row;
+    std::array<uint8_t, SCREEN_PIXEL_H> downscale_row_weight;
+    std::vector<uint32_t> downscale_sums;
+    uint8_t downscale_rows_done;
+
     CGBPaletteCombo curr_opt_gb_palette;
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,42 @@
+#ifdef _WIN32
+#include "stdafx.h"
+#endif // _WIN32
+
+#include "InputSource.h"
+
+uint8_t NullInputSource::pollJoypadState()
+{
+    return INPUT_NO_BUTTONS;
+}
+
+MemoryInputSource::MemoryInputSource(const std::vector<uint8_t> & initial_states)
+    : states(initial_states.begin(), initial_states.end())
+    , last_state(INPUT_NO_BUTTONS)
+{
+
+}
+
+uint8_t MemoryInputSource::pollJoypadState()
+{
+    std::lock_guard<std::mutex> lg(mutex);
+
+    if (!states.empty())
+    {
+        last_state = states.front();
+        states.pop_front();
+    }
+
+    return last_state;
+}
+
+void MemoryInputSource::pushJoypadState(const uint8_t & state)
+{
+    std::lock_guard<std::mutex> lg(mutex);
+    states.push_back(state);
+}
+
+size_t MemoryInputSource::getNumQueuedStates() const
+{
+    std::lock_guard<std::mutex> lg(mutex);
+    return states.size();
+}
@@ -0,0 +1,45 @@
+#ifndef INPUT_SOURCE_H
+#define INPUT_SOURCE_H
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#define INPUT_NO_BUTTONS 0xFF   // Joypad state with nothing held, a cleared bit is a held button
+
+// Where the emulator gets its buttons, polled once a frame on the emulator's thread.
+// States are as returned by Joypad::getJoypadState()
+class InputSource
+{
+public:
+    virtual ~InputSource() {}
+
+    virtual uint8_t pollJoypadState() = 0;
+};
+
+// Nothing is ever held
+class NullInputSource : public InputSource
+{
+public:
+    uint8_t pollJoypadState();
+};
+
+// Plays back a queue of states, one per frame. Holds the last one once the queue runs out
+class MemoryInputSource : public InputSource
+{
+public:
+    MemoryInputSource(const std::vector<uint8_t> & states = {});
+
+    uint8_t pollJoypadState();
+
+    void pushJoypadState(const uint8_t & state);
+    size_t getNumQueuedStates() const;
+
+private:
+    mutable std::mutex mutex;
+    std::deque<uint8_t> states;
+    uint8_t last_state;
+};
+
+#endif // INPUT_SOURCE_H
@@ -27,6 +27,20 @@ Joypad& Joypad::operator=(const Joypad& rhs)
     return *this;
 }
 
+void Joypad::saveState(StateWriter & state) const
+{
+    state.write(joypad_byte);
+    state.write(joypad_state);
+    state.write(hasInterrupt);
+}
+
+void Joypad::loadState(StateReader & state)
+{
+    state.read(joypad_byte);
+    state.read(joypad_state);
+    state.read(hasInterrupt);
+}
+
 void Joypad::set_joypad_button(BUTTON button)
 {
     uint8_t bitToUnset = 0;
@@ -116,28 +130,6 @@ std::uint8_t Joypad::get_joypad_byte()
     return out;
 }
 
-void Joypad::check_keyboard_input(SDL_Event *e)
-{
-	BUTTON b = NONE;
-	if (e->key.keysym.sym == SDLK_RIGHT)
-		b = RIGHT;
-	else if (e->key.keysym.sym == SDLK_LEFT)
-		b = LEFT;
-	else if (e->key.keysym.sym == SDLK_UP)
-		b = UP;
-	else if (e->key.keysym.sym == SDLK_DOWN)
-		b = DOWN;
-	else if (e->key.keysym.sym == SDLK_RETURN)
-		b = START;
-	else if (e->key.keysym.sym == SDLK_z)
-		b = A;
-	else if (e->key.keysym.sym == SDLK_x)
-		b = B;
-
-	if (b != NONE)
-		set_joypad_button(b);
-}
-
 uint8_t Joypad::unsetBit(const uint8_t byte, const uint8_t bitToUnset) const
 {
     uint8_t bit_flipped = bitToUnset ^ 0xFF;
@@ -179,4 +171,46 @@ bool Joypad::buttonIsSet(const BUTTON& button) const
 uint8_t Joypad::getJoypadState() const
 {
     return joypad_state;
-}
\ No newline at end of file
+}
+
+void Joypad::setJoypadState(const uint8_t & state)
+{
+    joypad_state = state;
+}
+
+void Joypad::updateButtons(const uint8_t & previous_state, const uint8_t & state)
+{
+    for (int button = DOWN; button < NONE; button++)
+    {
+        const uint8_t bit = getButtonBit(static_cast<BUTTON>(button));
+        if (!((previous_state ^ state) & bit))
+        {
+            continue;
+        }
+
+        if (state & bit)
+        {
+            release_joypad_button(static_cast<BUTTON>(button));
+        }
+        else
+        {
+            set_joypad_button(static_cast<BUTTON>(button));
+        }
+    }
+}
+
+uint8_t Joypad::getButtonBit(const BUTTON & button)
+{
+    switch (button)
+    {
+    case RIGHT:     return BIT0;
+    case LEFT:      return BIT1;
+    case UP:        return BIT2;
+    case DOWN:      return BIT3;
+    case A:         return BIT4;
+    case B:         return BIT5;
+    case SELECT:    return BIT6;
+    case START:     return BIT7;
+    default:        return 0;
+    }
+}
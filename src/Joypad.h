@@ -6,8 +6,8 @@
 #endif
 
 #include <cstdint>
-#include <SDL.h>
 #include <spdlog/spdlog.h>
+#include "SaveState.h"
 
 #define BIT0 0x01
 #define BIT1 0x02
@@ -24,6 +24,8 @@ public:
 	Joypad(std::shared_ptr<spdlog::logger> logger);
 	~Joypad();
     Joypad& operator=(const Joypad& rhs);
+    void saveState(StateWriter & state) const;
+    void loadState(StateReader & state);
 
     enum BUTTON : int
     {
@@ -42,13 +44,18 @@ public:
     void release_joypad_button(BUTTON button);
 	void set_joypad_byte(uint8_t val);
 	uint8_t get_joypad_byte();
-	void check_keyboard_input(SDL_Event *e);
     uint8_t unsetBit(const uint8_t byte, const uint8_t bitToUnset) const;
     bool bitIsUnset(const uint8_t byte, const uint8_t bitSet) const;
     bool buttonIsDirectionKey(const BUTTON b) const;
     bool buttonIsButtonKey(const BUTTON b) const;
     bool buttonIsSet(const BUTTON& b) const;
     uint8_t getJoypadState() const;
+    // Buttons held, as returned by getJoypadState()
+    void setJoypadState(const uint8_t & state);
+    // Presses and releases the buttons that changed between two joypad states
+    void updateButtons(const uint8_t & previous_state, const uint8_t & state);
+    // Bit of 'button' in a joypad state
+    static uint8_t getButtonBit(const BUTTON & button);
 
 	std::shared_ptr<spdlog::logger> logger;
     bool hasInterrupt;
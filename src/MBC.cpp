@@ -14,6 +14,9 @@ MBC::MBC(int mbcNum, int numROMBanks, int numRAMBanks, std::shared_ptr<spdlog::l
     rom_banking_mode = true;
     ram_banking_mode = false;
     external_ram_enabled = false;
+    rtc_timer_enabled = false;
+    prev_mbc3_latch  = 0;
+    curr_mbc3_latch  = 0;
     wroteToRAMBanks  = false;
     wroteToRTC       = false;
     auto_save        = false;
@@ -28,7 +31,6 @@ MBC::MBC(int mbcNum, int numROMBanks, int numRAMBanks, std::shared_ptr<spdlog::l
         num_ram_banks++;
     }
 
-    romBanks.resize(num_rom_banks, std::vector<unsigned char>(ROM_BANK_SIZE, 0));
     ramBanks.resize(num_ram_banks, std::vector<unsigned char>(RAM_BANK_SIZE, 0));
 
     mbc_num = mbcNum;
@@ -90,6 +92,47 @@ MBC& MBC::operator=(const MBC& rhs)
     return *this;
 }
 
+// ROM banks never change, only RAM, RTC and banking registers are saved
+void MBC::saveState(StateWriter & state) const
+{
+    for (const std::vector<unsigned char> & bank : ramBanks)
+    {
+        state.writeVector(bank);
+    }
+    state.writeVector(rtcRegisters);
+
+    state.write(curr_rom_bank);
+    state.write(curr_ram_bank);
+    state.write(rom_banking_mode);
+    state.write(ram_banking_mode);
+    state.write(rtc_timer_enabled);
+    state.write(external_ram_enabled);
+    state.write(prev_mbc3_latch);
+    state.write(curr_mbc3_latch);
+}
+
+void MBC::loadState(StateReader & state)
+{
+    for (std::vector<unsigned char> & bank : ramBanks)
+    {
+        state.readVector(bank);
+    }
+    state.readVector(rtcRegisters);
+
+    state.read(curr_rom_bank);
+    state.read(curr_ram_bank);
+    state.read(rom_banking_mode);
+    state.read(ram_banking_mode);
+    state.read(rtc_timer_enabled);
+    state.read(external_ram_enabled);
+    state.read(prev_mbc3_latch);
+    state.read(curr_mbc3_latch);
+
+    // RAM no longer matches the .sav
+    wroteToRAMBanks = true;
+    wroteToRTC      = true;
+}
+
 void MBC::MBC1_init()
 {
 	setFromTo(&rom_from_to, 0x4000, 0x7FFF);
@@ -170,7 +213,7 @@ std::uint8_t MBC::readByte(const uint16_t pos) const
 	case 0x2000:
 	case 0x3000:
         logger->trace("Reading from ROM bank: 0");
-		return romBanks[0][pos];
+		return (*romBanks)[0][pos];
 
 		// ROM 01 - N
 	case 0x4000:
@@ -180,17 +223,17 @@ std::uint8_t MBC::readByte(const uint16_t pos) const
         if (mbc_num == 1 && ram_banking_mode)
         {   // Only ROM banks 0x00-0x1F can be used during RAM banking mode
             logger->trace("Reading from ROM bank: {}", curr_rom_bank % 0x1F);
-            return romBanks[curr_rom_bank % 0x1F][pos - 0x4000];
+            return (*romBanks)[curr_rom_bank % 0x1F][pos - 0x4000];
         }
         /*if (mbc_num == 5 && ram_banking_mode)
         {    // Only ROM banks 0x00-0x01FF can be used during RAM banking mode
             logger->trace("Reading from ROM bank: {}", curr_rom_bank % 0x1FF);
-            return romBanks[curr_rom_bank % 0x1FF][pos - 0x4000];
+            return (*romBanks)[curr_rom_bank % 0x1FF][pos - 0x4000];
         }*/
         
         // All ROM banks can be accessed
         logger->trace("Reading from ROM bank: {}", curr_rom_bank % num_rom_banks);
-        return romBanks[curr_rom_bank % num_rom_banks][pos - 0x4000];
+        return (*romBanks)[curr_rom_bank % num_rom_banks][pos - 0x4000];
 
 		// External RAM
 	case 0xA000:
@@ -681,6 +724,41 @@ bool MBC::ramBanksAreEmpty() const
     return true;
 }
 
+const unsigned char * MBC::getMappedROMBank() const
+{
+    if (mbc_num == 1 && ram_banking_mode)
+    {
+        return (*romBanks)[curr_rom_bank % 0x1F].data();
+    }
+    return (*romBanks)[curr_rom_bank % num_rom_banks].data();
+}
+
+const unsigned char * MBC::getMappedRAMBank() const
+{
+    if (!external_ram_enabled || ramBanks.empty())
+    {
+        return nullptr;
+    }
+
+    if (mbc_num == 1)
+    {
+        if (rom_banking_mode)
+        {
+            return ramBanks[0].data();
+        }
+        else if (ram_banking_mode)
+        {
+            return ramBanks[curr_ram_bank % num_ram_banks].data();
+        }
+        return nullptr;
+    }
+    else if (mbc_num == 3 && curr_ram_bank > 0x03)
+    {
+        return nullptr;
+    }
+    return ramBanks[curr_ram_bank % num_ram_banks].data();
+}
+
 void MBC::latchCurrTimeToRTC()
 {
     if (mbc_num != 3 ||
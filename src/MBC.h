@@ -6,6 +6,7 @@
 #include <string>
 #include <vector>
 #include <spdlog/spdlog.h>
+#include "SaveState.h"
 
 enum MBC_Type {
     UNKNOWN,
@@ -32,6 +33,8 @@ public:
     MBC(int mbc_num, int num_rom_banks, int num_ram_banks, std::shared_ptr<spdlog::logger> logger);
     virtual ~MBC();
     MBC& operator=(const MBC& rhs);
+    void saveState(StateWriter & state) const;
+    void loadState(StateReader & state);
 
     // Reading and writing methods
     uint8_t readByte(const uint16_t pos) const;
@@ -43,10 +46,14 @@ public:
     void saveRAMToFile(const std::string & filename);
     void saveRTCToFile(const std::string & filename);
     bool ramBanksAreEmpty() const;
+    // Banks readByte() reads at 0x4000 - 0x7FFF and 0xA000 - 0xBFFF.
+    // No RAM bank when RAM is off or an RTC register is mapped instead
+    const unsigned char * getMappedROMBank() const;
+    const unsigned char * getMappedRAMBank() const;
 
     // Variables
     std::shared_ptr<spdlog::logger> logger;
-    std::vector<std::vector<unsigned char>> romBanks;	// size per bank = 16 KB = 0x4000
+    std::shared_ptr<const std::vector<std::vector<unsigned char>>> romBanks;	// size per bank = 16 KB = 0x4000, shared with clones
     std::vector<std::vector<unsigned char>> ramBanks;	// size per bank = 8 KB = 0x2000
     std::vector<unsigned char> rtcRegisters;
     const uint16_t ROM_BANK_SIZE = 0x4000;
@@ -11,8 +11,28 @@
 #include <APU.h>
 #include <SerialTransfer.h>
 #include "Debug.h"
+#include <algorithm>
+#include <cstring>
 #include <string>
 
+namespace
+{
+    // I/O registers readByte() has something for, the rest read 0xFF
+    bool ioRegisterIsMapped(const uint16_t & pos, const bool & is_cgb)
+    {
+        if (pos < 0xFF08 || pos == 0xFF0F ||
+           (pos >= 0xFF10 && pos < 0xFF4C) ||
+            pos == 0xFF4D || pos == 0xFF4F ||
+           (pos >= 0xFF51 && pos <= 0xFF55) ||
+           (pos >= 0xFF68 && pos <= 0xFF6B) ||
+            pos == 0xFF70)
+        {
+            return true;
+        }
+        return is_cgb && (pos == 0xFF6C || (pos >= 0xFF72 && pos <= 0xFF77));
+    }
+}
+
 Memory::Memory(std::shared_ptr<spdlog::logger> _logger,
     std::shared_ptr<CartridgeReader> _cartidgeReader,
     std::shared_ptr<MBC> _mbc,
@@ -42,6 +62,13 @@ Memory::Memory(std::shared_ptr<spdlog::logger> _logger,
     cgb_undoc_reg_ff6c  = 0;
     cgb_perform_speed_switch = false;
 
+    // Same power on state every time, so emulators of the same ROM run the same
+    memset(cgb_undoc_regs, 0, sizeof(cgb_undoc_regs));
+    memset(high_ram, 0, sizeof(high_ram));
+    memset(timer, 0, sizeof(timer));
+    memset(linkport, 0, sizeof(linkport));
+    gamepad = 0;
+
 	initWorkRAM(cartridgeReader->isColorGB() || force_cgb_mode);
     initROMBanks();
 }
@@ -81,6 +108,61 @@ Memory& Memory::operator=(const Memory& rhs)
     return *this;
 }
 
+void Memory::saveState(StateWriter & state) const
+{
+    state.write(cgb_perform_speed_switch);
+    state.write(cgb_speed_mode);
+    state.write(cgb_undoc_reg_ff6c);
+    state.write(cgb_undoc_regs);
+    state.write(high_ram);
+    state.write(gamepad);
+    state.write(timer);
+    state.write(linkport);
+    state.write(interrupt_flag);
+    state.write(interrupt_enable);
+    state.write(curr_working_ram_bank);
+    for (const std::vector<unsigned char> & bank : working_ram_banks)
+    {
+        state.writeVector(bank);
+    }
+
+    state.write(timer_enabled);
+    state.write(clock_frequency);
+    state.write(clock_div_rate);
+    state.write(clock_tima_rate);
+    state.write(clock_speed);
+    state.write(clock_div_accumulator);
+    state.write(clock_tima_accumulator);
+}
+
+// The number of working RAM banks is set by the color mode, which the state is checked against
+void Memory::loadState(StateReader & state)
+{
+    state.read(cgb_perform_speed_switch);
+    state.read(cgb_speed_mode);
+    state.read(cgb_undoc_reg_ff6c);
+    state.read(cgb_undoc_regs);
+    state.read(high_ram);
+    state.read(gamepad);
+    state.read(timer);
+    state.read(linkport);
+    state.read(interrupt_flag);
+    state.read(interrupt_enable);
+    state.read(curr_working_ram_bank);
+    for (std::vector<unsigned char> & bank : working_ram_banks)
+    {
+        state.readVector(bank);
+    }
+
+    state.read(timer_enabled);
+    state.read(clock_frequency);
+    state.read(clock_div_rate);
+    state.read(clock_tima_rate);
+    state.read(clock_speed);
+    state.read(clock_div_accumulator);
+    state.read(clock_tima_accumulator);
+}
+
 void Memory::reset()
 {
     cartridgeReader.reset();
@@ -113,7 +195,126 @@ void Memory::initWorkRAM(bool isColorGB)
 }
 
 
-std::uint8_t Memory::readByte(std::uint16_t pos, bool limit_access) const
+void Memory::peek(const uint16_t & start, const size_t & length, uint8_t * out) const
+{
+    const size_t end = std::min<size_t>(start + length, 0x10000);
+    size_t pos = start;
+
+    if (start + length > end)
+    {   // Past the end of the memory map
+        std::memset(out + (end - start), 0xFF, start + length - end);
+    }
+
+    while (pos < end)
+    {
+        uint8_t * dest = out + (pos - start);
+        const uint8_t * src = nullptr;
+        size_t region_end;
+
+        if (pos < 0x0100 && cartridgeReader->has_bios && cartridgeReader->is_in_bios)
+        {
+            region_end = 0x0100;
+            const size_t bios_size = std::min<size_t>(cartridgeReader->bios.size(), region_end);
+            if (pos >= bios_size)
+            {
+                region_end = std::min(region_end, end);
+                std::memset(dest, 0xFF, region_end - pos);
+                pos = region_end;
+                continue;
+            }
+            region_end = bios_size;
+            src = &cartridgeReader->bios[pos];
+        }
+        else if (pos < 0x4000)
+        {
+            region_end = 0x4000;
+            src = &(*mbc->romBanks)[0][pos];
+        }
+        else if (pos < 0x8000)
+        {
+            region_end = 0x8000;
+            src = mbc->getMappedROMBank() + (pos - 0x4000);
+        }
+        else if (pos < 0xA000)
+        {
+            region_end = 0xA000;
+            src = gpu->getVRAM(gpu->getCurrentVRAMBank()).data + (pos - 0x8000);
+        }
+        else if (pos < 0xC000)
+        {
+            region_end = 0xC000;
+            const uint8_t * ram_bank = mbc->getMappedRAMBank();
+            if (ram_bank)
+            {
+                src = ram_bank + (pos - 0xA000);
+            }
+            else
+            {   // RAM off or an RTC register, both the same byte everywhere
+                region_end = std::min(region_end, end);
+                std::memset(dest, mbc->ramBanks.empty() ? 0xFF : mbc->readByte(pos), region_end - pos);
+                pos = region_end;
+                continue;
+            }
+        }
+        else if (pos < 0xFE00)
+        {   // Work RAM, then its echo from 0xE000
+            const uint16_t offset = (pos - 0xC000) % 0x2000;
+            const int switchable_bank = (is_color_gb && curr_working_ram_bank != 0) ? curr_working_ram_bank : 1;
+
+            region_end = std::min<size_t>(pos - offset % WORK_RAM_SIZE + WORK_RAM_SIZE, 0xFE00);
+            src = &working_ram_banks[(offset < WORK_RAM_SIZE) ? 0 : switchable_bank][offset % WORK_RAM_SIZE];
+        }
+        else if (pos < 0xFEA0)
+        {
+            region_end = 0xFEA0;
+            src = gpu->getOAM().data + (pos - 0xFE00);
+        }
+        else if (pos < 0xFF00)
+        {
+            region_end = std::min<size_t>(0xFF00, end);
+            std::memset(dest, 0xFF, region_end - pos);
+            pos = region_end;
+            continue;
+        }
+        else if (pos < 0xFF80)
+        {   // Registers are read one by one, the APU's without catching it up
+            region_end = std::min<size_t>(0xFF80, end);
+            for (; pos < region_end; pos++)
+            {
+                if (!ioRegisterIsMapped(static_cast<uint16_t>(pos), is_color_gb))
+                {
+                    out[pos - start] = 0xFF;
+                }
+                else if (pos >= 0xFF10 && pos < 0xFF40)
+                {
+                    out[pos - start] = apu->peekByte(static_cast<uint16_t>(pos));
+                }
+                else
+                {
+                    out[pos - start] = readByte(static_cast<uint16_t>(pos), false);
+                }
+            }
+            continue;
+        }
+        else if (pos < 0xFFFF)
+        {
+            region_end = 0xFFFF;
+            src = &high_ram[pos - 0xFF80];
+        }
+        else
+        {
+            region_end = 0x10000;
+            src = &interrupt_enable;
+        }
+
+        region_end = std::min(region_end, end);
+        std::memcpy(dest, src, region_end - pos);
+        pos = region_end;
+    }
+}
+
+template <bool is_cgb>
+std::uint8_t Memory::readMappedByte(std::uint16_t pos, bool limit_access) const
 {
 	if (cartridgeReader->has_bios &&
         cartridgeReader->is_in_bios &&
@@ -173,7 +374,7 @@ std::uint8_t Memory::readByte(std::uint16_t pos, bool limit_access) const
 			}
 			else if ((pos & 0xF000) < 0xE000)
 			{
-                if (is_color_gb)
+                if constexpr (is_cgb)
                 {   // 0xD000 - 0xDFFF
                     if (curr_working_ram_bank == 0)
                     {
@@ -192,7 +393,7 @@ std::uint8_t Memory::readByte(std::uint16_t pos, bool limit_access) const
 				{   // 0xE000 - 0xEFFF
 					return working_ram_banks[0][pos - 0xE000];
 				}
-				else if (pos >= 0xF000 && is_color_gb)
+				else if (pos >= 0xF000 && is_cgb)
 				{   // 0xF000 - 0xFDFF
                     if (curr_working_ram_bank == 0)
                     {
@@ -265,7 +466,7 @@ std::uint8_t Memory::readByte(std::uint16_t pos, bool limit_access) const
 				// 0xFF40 - 0xFF6B : GPU LCD
 				return gpu->readByte(pos, limit_access);
 			}
-            else if (pos == 0xFF6C && is_color_gb)
+            else if (pos == 0xFF6C && is_cgb)
             {
                 return cgb_undoc_reg_ff6c;
             }
@@ -274,7 +475,7 @@ std::uint8_t Memory::readByte(std::uint16_t pos, bool limit_access) const
                 // 0xFF70 : WRAM select (CBG Only)
                 return curr_working_ram_bank | 0xF8;    // Bits 3-7 are masked with 1s
             }
-            else if (pos >= 0xFF72 && pos <= 0xFF77 && is_color_gb)
+            else if (pos >= 0xFF72 && pos <= 0xFF77 && is_cgb)
             {
                 if (pos == 0xFF75)
                 {
@@ -320,6 +521,15 @@ std::uint8_t Memory::readByte(std::uint16_t pos, bool limit_access) const
 	//return cartridgeReader->readByte(pos);
 }
 
+std::uint8_t Memory::readByte(std::uint16_t pos, bool limit_access) const
+{   // DMG or CGB memory map. A branch that always goes the same way, and both maps can be inlined
+    if (is_color_gb)
+    {
+        return readMappedByte<true>(pos, limit_access);
+    }
+    return readMappedByte<false>(pos, limit_access);
+}
+
 void Memory::setByte(std::uint16_t pos, std::uint8_t val, bool limit_access)
 {
 	switch (pos & 0xF000)
@@ -559,12 +769,17 @@ void Memory::setByte(std::uint16_t pos, std::uint8_t val, bool limit_access)
 
 void Memory::initROMBanks()
 {
-	std::uint64_t counter = 0;
+    if (mbc->romBanks)
+    {   // Shared with the emulator this one was cloned from
+        return;
+    }
+
+    auto romBanks = std::make_shared<std::vector<std::vector<unsigned char>>>(cartridgeReader->num_ROM_banks);
 	for (int i = 0; i < cartridgeReader->num_ROM_banks; i++)
 	{
-		mbc->romBanks[i] = std::vector<unsigned char>(cartridgeReader->romBuffer.begin() + (i * mbc->ROM_BANK_SIZE), cartridgeReader->romBuffer.begin() + ((i + 1)* mbc->ROM_BANK_SIZE));
-		counter += mbc->ROM_BANK_SIZE;
+		(*romBanks)[i] = std::vector<unsigned char>(cartridgeReader->romBuffer.begin() + (i * mbc->ROM_BANK_SIZE), cartridgeReader->romBuffer.begin() + ((i + 1)* mbc->ROM_BANK_SIZE));
 	}
+    mbc->romBanks = romBanks;
 
     // Free cartridgeReader from holding ROM in memory
     // since it's now in the emulator's ROM banks
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <spdlog/spdlog.h>
+#include "SaveState.h"
 
 #define WORK_RAM_SIZE 0x1000
 
@@ -41,6 +42,8 @@ public:
         const bool force_cgb_mode);
     virtual ~Memory();
     Memory& operator=(const Memory& rhs);
+    void saveState(StateWriter & state) const;
+    void loadState(StateReader & state);
 
     void reset();
     void initWorkRAM(bool isColorGB);
@@ -53,6 +56,9 @@ public:
     void initGBPowerOn();
     void setByte(uint16_t pos, uint8_t val, bool limit_access = true);
     uint8_t readByte(uint16_t pos, bool limit_access = true) const;
+    // Copies 'length' bytes from 'start' on into 'out' as readByte(pos, false) reads them, a region
+    // at a time. I/O reads have no side effects and unused addresses, or ones past 0xFFFF, are 0xFF
+    void peek(const uint16_t & start, const size_t & length, uint8_t * out) const;
 
     // Variables
     std::shared_ptr<CartridgeReader> cartridgeReader;
@@ -94,5 +100,6 @@ public:
 
 private:
     void updateTimerRates();
+    template <bool is_cgb> uint8_t readMappedByte(uint16_t pos, bool limit_access) const;
 };
 #endif
\ No newline at end of file
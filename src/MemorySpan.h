@@ -0,0 +1,15 @@
+#ifndef MEMORY_SPAN_H
+#define MEMORY_SPAN_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Read-only view straight into an emulator's memory, no copy is made.
+// Stays valid for as long as the emulator does, and sees every later write
+struct MemorySpan
+{
+    const uint8_t * data = nullptr;
+    size_t size = 0;
+};
+
+#endif // MEMORY_SPAN_H
@@ -0,0 +1,278 @@
+#ifdef _WIN32
+#include "stdafx.h"
+#endif // _WIN32
+
+#include "RewindBuffer.h"
+#include <cstring>
+
+RewindBuffer::RewindBuffer(const size_t & budget)
+    : capturing_buffer(REWIND_NUM_CAPTURE_BUFFERS)
+    , compressing(false)
+    , stop_compression_thread(false)
+    , dropped_snapshots(0)
+    , has_newest(false)
+    , deltas_size(0)
+    , memory_budget(budget)
+{
+    for (size_t i = 0; i < REWIND_NUM_CAPTURE_BUFFERS; i++)
+    {
+        free_buffers.push_back(i);
+    }
+
+    compression_thread = std::thread(&RewindBuffer::compressionThreadLoop, this);
+}
+
+RewindBuffer::~RewindBuffer()
+{
+    {
+        std::lock_guard<std::mutex> lg(queue_mutex);
+        stop_compression_thread = true;
+    }
+    queue_cv.notify_all();
+    compression_thread.join();
+}
+
+void RewindBuffer::setMemoryBudget(const size_t & bytes)
+{
+    std::lock_guard<std::mutex> lg(history_mutex);
+    memory_budget = bytes;
+    trimToBudget();
+}
+
+size_t RewindBuffer::getMemoryBudget() const
+{
+    return memory_budget;
+}
+
+std::vector<uint8_t> * RewindBuffer::getCaptureBuffer()
+{
+    std::lock_guard<std::mutex> lg(queue_mutex);
+
+    if (capturing_buffer == REWIND_NUM_CAPTURE_BUFFERS)
+    {
+        if (free_buffers.empty())
+        {   // Skipping a snapshot only makes that step of the rewind longer
+            dropped_snapshots++;
+            return nullptr;
+        }
+
+        capturing_buffer = free_buffers.front();
+        free_buffers.pop_front();
+    }
+
+    return &capture_buffers[capturing_buffer];
+}
+
+void RewindBuffer::submitCapture()
+{
+    {
+        std::lock_guard<std::mutex> lg(queue_mutex);
+        if (capturing_buffer == REWIND_NUM_CAPTURE_BUFFERS)
+        {
+            return;
+        }
+
+        submitted_buffers.push_back(capturing_buffer);
+        capturing_buffer = REWIND_NUM_CAPTURE_BUFFERS;
+    }
+    queue_cv.notify_all();
+}
+
+bool RewindBuffer::stepBack(std::vector<uint8_t> & state)
+{
+    {   // Snapshots still being compressed are newer than anything in the history
+        std::unique_lock<std::mutex> lk(queue_mutex);
+        waitForCompression(lk);
+    }
+
+    std::lock_guard<std::mutex> lg(history_mutex);
+    if (!has_newest)
+    {
+        return false;
+    }
+
+    state = newest;
+
+    if (deltas.empty())
+    {
+        has_newest = false;
+        return true;
+    }
+
+    applyDelta(deltas.back(), newest);
+    deltas_size -= deltas.back().capacity();
+    if (spare_deltas.size() < REWIND_MAX_SPARE_DELTAS)
+    {
+        spare_deltas.push_back(std::move(deltas.back()));
+    }
+    deltas.pop_back();
+
+    return true;
+}
+
+void RewindBuffer::clear()
+{
+    {
+        std::unique_lock<std::mutex> lk(queue_mutex);
+        waitForCompression(lk);
+    }
+
+    std::lock_guard<std::mutex> lg(history_mutex);
+    has_newest = false;
+    deltas.clear();
+    deltas_size = 0;
+}
+
+RewindStats RewindBuffer::getStats()
+{
+    RewindStats stats;
+
+    {
+        std::lock_guard<std::mutex> lg(queue_mutex);
+        stats.dropped_snapshots = dropped_snapshots;
+    }
+
+    std::lock_guard<std::mutex> lg(history_mutex);
+    stats.num_snapshots = has_newest ? deltas.size() + 1 : 0;
+    stats.memory_used = (has_newest ? newest.capacity() : 0) + deltas_size;
+    return stats;
+}
+
+void RewindBuffer::waitForCompression(std::unique_lock<std::mutex> & lk)
+{
+    queue_cv.wait(lk, [this]() { return submitted_buffers.empty() && !compressing; });
+}
+
+void RewindBuffer::compressionThreadLoop()
+{
+    std::unique_lock<std::mutex> lk(queue_mutex);
+
+    while (true)
+    {
+        queue_cv.wait(lk, [this]() { return stop_compression_thread || !submitted_buffers.empty(); });
+        if (stop_compression_thread)
+        {
+            break;
+        }
+
+        const size_t buffer = submitted_buffers.front();
+        submitted_buffers.pop_front();
+        compressing = true;
+        lk.unlock();
+
+        {
+            std::lock_guard<std::mutex> lg(history_mutex);
+            addState(capture_buffers[buffer]);
+        }
+
+        lk.lock();
+        free_buffers.push_back(buffer);
+        compressing = false;
+        queue_cv.notify_all();
+    }
+}
+
+void RewindBuffer::addState(const std::vector<uint8_t> & state)
+{
+    if (has_newest && newest.size() == state.size())
+    {
+        deltas.push_back(getSpareDelta());
+        encodeDelta(state, newest, deltas.back());
+        deltas_size += deltas.back().capacity();
+    }
+    else
+    {   // States of another size are from another ROM or version, nothing to diff against
+        deltas.clear();
+        deltas_size = 0;
+    }
+
+    newest = state;
+    has_newest = true;
+
+    trimToBudget();
+}
+
+void RewindBuffer::trimToBudget()
+{
+    while (!deltas.empty() && newest.capacity() + deltas_size > memory_budget)
+    {
+        deltas_size -= deltas.front().capacity();
+        if (spare_deltas.size() < REWIND_MAX_SPARE_DELTAS)
+        {
+            spare_deltas.push_back(std::move(deltas.front()));
+        }
+        deltas.pop_front();
+    }
+}
+
+std::vector<uint8_t> RewindBuffer::getSpareDelta()
+{
+    if (spare_deltas.empty())
+    {
+        return std::vector<uint8_t>();
+    }
+
+    std::vector<uint8_t> delta = std::move(spare_deltas.back());
+    spare_deltas.pop_back();
+    return delta;
+}
+
+// Delta is a list of runs, each one is
+//   uint32_t unchanged_bytes, uint32_t changed_bytes, 'changed_bytes' bytes of older ^ newer
+void RewindBuffer::encodeDelta(const std::vector<uint8_t> & newer, const std::vector<uint8_t> & older, std::vector<uint8_t> & delta)
+{
+    delta.clear();
+
+    const size_t size = newer.size();
+    size_t i = 0;
+    while (i < size)
+    {
+        const size_t run_start = i;
+        while (i < size && newer[i] == older[i])
+        {
+            i++;
+        }
+
+        // Changed bytes run until the next long enough run of unchanged ones
+        const size_t changed_start = i;
+        size_t unchanged = 0;
+        while (i < size && unchanged < REWIND_MIN_ZERO_RUN)
+        {
+            unchanged = (newer[i] == older[i]) ? unchanged + 1 : 0;
+            i++;
+        }
+        i -= unchanged;
+
+        const uint32_t run[2] = {
+            static_cast<uint32_t>(changed_start - run_start),
+            static_cast<uint32_t>(i - changed_start)
+        };
+        const size_t pos = delta.size();
+        delta.resize(pos + sizeof(run) + run[1]);
+        std::memcpy(&delta[pos], run, sizeof(run));
+
+        uint8_t * changed = &delta[pos + sizeof(run)];
+        for (size_t j = changed_start; j < i; j++)
+        {
+            *changed++ = older[j] ^ newer[j];
+        }
+    }
+}
+
+void RewindBuffer::applyDelta(const std::vector<uint8_t> & delta, std::vector<uint8_t> & state)
+{
+    size_t pos = 0;
+    size_t state_pos = 0;
+    while (pos + (sizeof(uint32_t) * 2) <= delta.size())
+    {
+        uint32_t run[2];
+        std::memcpy(run, &delta[pos], sizeof(run));
+        pos += sizeof(run);
+
+        state_pos += run[0];
+        for (uint32_t j = 0; j < run[1]; j++)
+        {
+            state[state_pos++] ^= delta[pos++];
+        }
+    }
+}
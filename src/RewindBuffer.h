@@ -0,0 +1,81 @@
+#ifndef REWIND_BUFFER_H
+#define REWIND_BUFFER_H
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define REWIND_DEFAULT_MEMORY_BUDGET (64 * 1024 * 1024)
+#define REWIND_DEFAULT_FRAMES_PER_SNAPSHOT 2
+#define REWIND_NUM_CAPTURE_BUFFERS 4    // Snapshots the emulation thread can get ahead of the compression thread
+#define REWIND_MIN_ZERO_RUN 8           // Shorter runs of unchanged bytes are cheaper to store as literals
+#define REWIND_MAX_SPARE_DELTAS 8
+
+struct RewindStats {
+    size_t num_snapshots;
+    size_t memory_used;             // Bytes, newest snapshot included
+    uint64_t dropped_snapshots;     // Compression thread was behind
+};
+
+// History of machine states for rewinding.
+// The newest state is kept as is, each older one is stored as the run length
+// encoded XOR against the state after it. Snapshots are copied into a pooled
+// buffer on the emulation thread and compressed on a background thread.
+// Oldest states are dropped to stay within the memory budget
+class RewindBuffer
+{
+public:
+    RewindBuffer(const size_t & memory_budget = REWIND_DEFAULT_MEMORY_BUDGET);
+    virtual ~RewindBuffer();
+
+    void setMemoryBudget(const size_t & bytes);
+    size_t getMemoryBudget() const;
+
+    // Free buffer to snapshot into, or nullptr if all are waiting to be compressed
+    std::vector<uint8_t> * getCaptureBuffer();
+    // Queues the buffer from getCaptureBuffer() for compression
+    void submitCapture();
+
+    // Takes the newest state out of the history. Returns false once it's empty
+    bool stepBack(std::vector<uint8_t> & state);
+    void clear();
+    RewindStats getStats();
+
+private:
+    void compressionThreadLoop();
+    void waitForCompression(std::unique_lock<std::mutex> & lk);
+    void addState(const std::vector<uint8_t> & state);
+    void trimToBudget();
+    std::vector<uint8_t> getSpareDelta();
+
+    static void encodeDelta(const std::vector<uint8_t> & newer, const std::vector<uint8_t> & older, std::vector<uint8_t> & delta);
+    static void applyDelta(const std::vector<uint8_t> & delta, std::vector<uint8_t> & state);
+
+    // Emulation thread <-> compression thread, guarded by queue_mutex
+    std::array<std::vector<uint8_t>, REWIND_NUM_CAPTURE_BUFFERS> capture_buffers;
+    std::deque<size_t> free_buffers;
+    std::deque<size_t> submitted_buffers;
+    size_t capturing_buffer;
+    bool compressing;
+    bool stop_compression_thread;
+    uint64_t dropped_snapshots;
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+
+    // History, guarded by history_mutex
+    std::vector<uint8_t> newest;
+    bool has_newest;
+    std::deque<std::vector<uint8_t>> deltas;    // Oldest first, deltas.back() turns 'newest' into the state before it
+    std::vector<std::vector<uint8_t>> spare_deltas;
+    size_t deltas_size;
+    size_t memory_budget;
+    std::mutex history_mutex;
+
+    std::thread compression_thread;
+};
+
+#endif // REWIND_BUFFER_H
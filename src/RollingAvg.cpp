@@ -1,35 +0,0 @@
-#include <RollingAvg.h>
-
-RollingAvg::RollingAvg()
-    : sum(0)
-{
-
-}
-
-RollingAvg::~RollingAvg()
-{
-
-}
-
-void RollingAvg::Push(const size_t& sample)
-{
-    if (data.size() >= APU_ROLLING_AVG_SAMPLE_SIZE)
-    {
-        sum -= data.front();
-        data.pop();
-    }
-    data.push(sample);
-    sum += sample;
-}
-
-size_t RollingAvg::GetRollingAvg()
-{
-    if (data.empty())
-    {
-        return 0;
-    }
-    else
-    {
-        return sum / data.size();
-    }
-}
\ No newline at end of file
@@ -0,0 +1,275 @@
+#ifdef _WIN32
+#include "stdafx.h"
+#endif // _WIN32
+
+#include "SDLSinks.h"
+#include <cstring>
+
+SDLAudioSink::SDLAudioSink(std::shared_ptr<spdlog::logger> _logger)
+    : logger(_logger)
+    , audio_device_id(0)
+    , sdl_silence_val(0)
+{
+    if (SDL_Init(SDL_INIT_AUDIO) < 0)
+    {
+        logger->error("SDL_Init(SDL_INIT_AUDIO) failed: {0:s}", SDL_GetError());
+    }
+}
+
+SDLAudioSink::~SDLAudioSink()
+{
+    close();
+}
+
+int SDLAudioSink::open(const int & sample_rate, const SDL_AudioFormat & format, const uint32_t & target_buffer_ms)
+{
+    close();
+
+    SDL_AudioSpec desired_spec = {};
+    SDL_AudioSpec obtained_spec = {};
+    desired_spec.callback = audioCallback;
+    desired_spec.format  = format;
+    desired_spec.freq = sample_rate;
+    desired_spec.channels = 2;
+    desired_spec.userdata = this;
+
+    // Device asks for audio every half of the target buffering, rounded down to a power of 2
+    const uint32_t target_samples = (sample_rate * target_buffer_ms) / 1000;
+    desired_spec.samples = 256;
+    while (desired_spec.samples * 4 <= target_samples)
+    {
+        desired_spec.samples <<= 1;
+    }
+
+    audio_device_id = SDL_OpenAudioDevice(NULL,
+        0,
+        &desired_spec,
+        &obtained_spec,
+        SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);  // SDL converts any other differences
+
+    if (audio_device_id == 0)
+    {
+        logger->error("Failed to open audio: {0:s}", SDL_GetError());
+        return 0;
+    }
+
+    if (obtained_spec.format != desired_spec.format)
+    {
+        logger->error("Failed to get audio format requested, from: {} to: {}",
+            desired_spec.format,
+            obtained_spec.format);
+    }
+
+    // Get 'silence' value/byte
+    sdl_silence_val = obtained_spec.silence;
+
+    if (obtained_spec.freq != sample_rate)
+    {
+        logger->info("Audio device sample rate: {}, requested: {}",
+            obtained_spec.freq,
+            sample_rate);
+    }
+
+    // Device starts paused, so the ring buffer can be made before the callback runs
+    audio_ring_buffer = std::make_unique<AudioRingBuffer>(
+        (static_cast<size_t>(obtained_spec.freq) * AUDIO_RING_BUFFER_MS / 1000) * getAudioSampleSize(format));
+
+    return obtained_spec.freq;
+}
+
+void SDLAudioSink::close()
+{
+    if (audio_device_id == 0)
+    {
+        return;
+    }
+
+    // Closing stops the callback, the ring buffer can be freed after
+    SDL_CloseAudioDevice(audio_device_id);
+    audio_device_id = 0;
+    audio_ring_buffer.reset();
+}
+
+void SDLAudioSink::setPaused(const bool & paused)
+{
+    if (audio_device_id != 0)
+    {
+        SDL_PauseAudioDevice(audio_device_id, paused);
+    }
+}
+
+size_t SDLAudioSink::write(const uint8_t * data, const size_t & num_bytes)
+{
+    if (!audio_ring_buffer)
+    {
+        return 0;
+    }
+
+    return audio_ring_buffer->write(data, num_bytes);
+}
+
+void SDLAudioSink::clear()
+{
+    if (!audio_ring_buffer)
+    {
+        return;
+    }
+
+    // Callback can't be reading while it's cleared
+    SDL_LockAudioDevice(audio_device_id);
+    audio_ring_buffer->clear();
+    SDL_UnlockAudioDevice(audio_device_id);
+}
+
+bool SDLAudioSink::isRealTime() const
+{
+    return true;
+}
+
+size_t SDLAudioSink::getBufferedBytes() const
+{
+    if (!audio_ring_buffer)
+    {
+        return 0;
+    }
+
+    return audio_ring_buffer->getBufferedBytes();
+}
+
+// The audio callback wakes this up, so there's no polling
+void SDLAudioSink::waitForBufferedBytes(const size_t & target_bytes, const std::chrono::milliseconds & timeout)
+{
+    if (!audio_ring_buffer)
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(audio_drain_mutex);
+    audio_drained.wait_for(lock, timeout, [this, target_bytes]()
+    {
+        return audio_ring_buffer->getBufferedBytes() <= target_bytes;
+    });
+}
+
+AudioRingBufferStats SDLAudioSink::getStats() const
+{
+    if (!audio_ring_buffer)
+    {
+        return {};
+    }
+
+    return audio_ring_buffer->getStats();
+}
+
+// Runs on SDL's audio thread, must not log or touch anything but the ring buffer
+void SDLAudioSink::audioCallback(void * userdata, uint8_t * stream, int len)
+{
+    SDLAudioSink * sink = static_cast<SDLAudioSink *>(userdata);
+
+    sink->audio_ring_buffer->read(stream, static_cast<size_t>(len), sink->sdl_silence_val);
+
+    {   // Emulator can't miss the wake up between checking the buffer and waiting
+        std::lock_guard<std::mutex> lock(sink->audio_drain_mutex);
+    }
+    sink->audio_drained.notify_one();
+}
+
+SDLFrameSink::SDLFrameSink()
+    : frame()
+    , have_new_frame(false)
+{
+
+}
+
+void SDLFrameSink::frameReady(const SDL_Color * new_frame)
+{
+    std::lock_guard<std::mutex> lg(mutex);
+    std::memcpy(frame.data(), new_frame, sizeof(SDL_Color) * SCREEN_PIXEL_TOTAL);
+    have_new_frame = true;
+}
+
+bool SDLFrameSink::updateTexture(SDL_Texture * texture)
+{
+    std::lock_guard<std::mutex> lg(mutex);
+    if (!have_new_frame)
+    {
+        return false;
+    }
+
+    SDL_UpdateTexture(texture, NULL, frame.data(), SCREEN_PIXEL_W * sizeof(SDL_Color));
+    have_new_frame = false;
+    return true;
+}
+
+SDLInputSource::SDLInputSource()
+    : state(INPUT_NO_BUTTONS)
+{
+
+}
+
+uint8_t SDLInputSource::pollJoypadState()
+{
+    return state;
+}
+
+bool SDLInputSource::handleEvent(const SDL_Event & event)
+{
+    Joypad::BUTTON button = Joypad::BUTTON::NONE;
+
+    switch (event.type)
+    {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+    {
+        switch (event.key.keysym.sym)
+        {
+        case SDLK_w: button = Joypad::BUTTON::UP;       break;
+        case SDLK_a: button = Joypad::BUTTON::LEFT;     break;
+        case SDLK_s: button = Joypad::BUTTON::DOWN;     break;
+        case SDLK_d: button = Joypad::BUTTON::RIGHT;    break;
+        case SDLK_z: button = Joypad::BUTTON::A;        break;
+        case SDLK_x: button = Joypad::BUTTON::B;        break;
+        case SDLK_m: button = Joypad::BUTTON::START;    break;
+        case SDLK_n: button = Joypad::BUTTON::SELECT;   break;
+        }
+        break;
+    }
+    case SDL_JOYBUTTONDOWN:
+    case SDL_JOYBUTTONUP:
+    {
+        switch (event.jbutton.button)
+        {
+        case SDL_CONTROLLER_BUTTON_A:           button = Joypad::BUTTON::A;         break;
+        case SDL_CONTROLLER_BUTTON_B:           button = Joypad::BUTTON::B;         break;
+        case SDL_CONTROLLER_BUTTON_START:       button = Joypad::BUTTON::START;     break;
+        case SDL_CONTROLLER_BUTTON_LEFTSHOULDER:button = Joypad::BUTTON::SELECT;    break;
+        case SDL_CONTROLLER_BUTTON_DPAD_UP:     button = Joypad::BUTTON::UP;        break;
+        case SDL_CONTROLLER_BUTTON_DPAD_DOWN:   button = Joypad::BUTTON::DOWN;      break;
+        case SDL_CONTROLLER_BUTTON_DPAD_LEFT:   button = Joypad::BUTTON::LEFT;      break;
+        case SDL_CONTROLLER_BUTTON_DPAD_RIGHT:  button = Joypad::BUTTON::RIGHT;     break;
+        }
+        break;
+    }
+    }
+
+    if (button == Joypad::BUTTON::NONE)
+    {
+        return false;
+    }
+
+    setButton(button, event.type == SDL_KEYDOWN || event.type == SDL_JOYBUTTONDOWN);
+    return true;
+}
+
+void SDLInputSource::setButton(const Joypad::BUTTON & button, const bool & held)
+{
+    const uint8_t bit = Joypad::getButtonBit(button);
+    if (held)
+    {
+        state &= static_cast<uint8_t>(~bit);
+    }
+    else
+    {
+        state |= bit;
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef SDL_SINKS_H
+#define SDL_SINKS_H
+
+#include <AudioSink.h>
+#include <FrameSink.h>
+#include <InputSource.h>
+#include <Joypad.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <spdlog/spdlog.h>
+
+extern "C" {
+#include <SDL.h>
+}
+
+// Plays the audio on an SDL audio device.
+// The device's callback drains a lock free ring buffer on SDL's audio thread
+class SDLAudioSink : public AudioSink
+{
+public:
+    SDLAudioSink(std::shared_ptr<spdlog::logger> logger);
+    virtual ~SDLAudioSink();
+
+    int open(const int & sample_rate, const SDL_AudioFormat & format, const uint32_t & target_buffer_ms);
+    void close();
+    void setPaused(const bool & paused);
+    size_t write(const uint8_t * data, const size_t & num_bytes);
+    void clear();
+
+    bool isRealTime() const;
+    size_t getBufferedBytes() const;
+    void waitForBufferedBytes(const size_t & target_bytes, const std::chrono::milliseconds & timeout);
+    AudioRingBufferStats getStats() const;
+
+private:
+    static void audioCallback(void * userdata, uint8_t * stream, int len);
+
+    std::shared_ptr<spdlog::logger> logger;
+    std::unique_ptr<AudioRingBuffer> audio_ring_buffer;    // Filled by write(), drained by audioCallback()
+    std::mutex audio_drain_mutex;
+    std::condition_variable audio_drained;
+    SDL_AudioDeviceID audio_device_id;
+    uint8_t sdl_silence_val;
+};
+
+// Keeps the newest frame until the window's thread uploads it
+class SDLFrameSink : public FrameSink
+{
+public:
+    SDLFrameSink();
+
+    void frameReady(const SDL_Color * frame);
+
+    // Uploads the newest frame to 'texture' if it hasn't been yet, returns true if it did
+    bool updateTexture(SDL_Texture * texture);
+
+private:
+    std::mutex mutex;
+    std::array<SDL_Color, SCREEN_PIXEL_TOTAL> frame;
+    bool have_new_frame;
+};
+
+// Buttons from the keyboard and game controllers, the window's thread passes in their events
+class SDLInputSource : public InputSource
+{
+public:
+    SDLInputSource();
+
+    uint8_t pollJoypadState();
+
+    // Returns true if the event was for a joypad button
+    bool handleEvent(const SDL_Event & event);
+
+private:
+    void setButton(const Joypad::BUTTON & button, const bool & held);
+
+    std::atomic<uint8_t> state;
+};
+
+#endif // SDL_SINKS_H
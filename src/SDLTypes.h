@@ -0,0 +1,44 @@
+#ifndef SDL_TYPES_H
+#define SDL_TYPES_H
+
+// Plain SDL types the core uses for pixels and audio formats.
+// Headless builds (GBC_HEADLESS) define them here with the same layout and values,
+// so the core doesn't need SDL to build or run
+
+#ifdef GBC_HEADLESS
+
+#include <cstdint>
+
+struct SDL_Color {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    uint8_t a;
+};
+
+typedef uint16_t SDL_AudioFormat;
+
+#define AUDIO_S16LSB 0x8010
+#define AUDIO_S16MSB 0x9010
+#define AUDIO_F32LSB 0x8120
+#define AUDIO_F32MSB 0x9120
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define AUDIO_S16SYS AUDIO_S16MSB
+#define AUDIO_F32SYS AUDIO_F32MSB
+#else
+#define AUDIO_S16SYS AUDIO_S16LSB
+#define AUDIO_F32SYS AUDIO_F32LSB
+#endif
+
+#define SDL_MIX_MAXVOLUME 128
+
+#else
+
+extern "C" {
+#include <SDL.h>
+}
+
+#endif // GBC_HEADLESS
+
+#endif // SDL_TYPES_H
@@ -3,11 +3,15 @@
 #include <SDL_thread.h>
 #include <fmt/core.h>
 
+#define MAX_RUN_AHEAD_FRAMES 3
+
 SDLWindow::SDLWindow(const std::string& log_name)
     :   ScreenInterface()
     , logger(spdlog::rotating_logger_mt("SDLWindow", log_name, 1024 * 1024 * 3, 3))
+    , frame_sink(std::make_shared<SDLFrameSink>())
+    , input(std::make_shared<SDLInputSource>())
     , keep_aspect_ratio(true)
-    , have_new_frame(false)
+    , pipelined_synthesis(false)
     , using_connected_controller(-1)
 {
     init();
@@ -115,14 +119,27 @@ void SDLWindow::hookToEmulator(std::shared_ptr<GBCEmulator> emulator)
         updateWindowTitle("");
     }
 
-    // Set emulator display output to SDL screen
-    emulator->setFrameUpdateMethod(std::bind(&SDLWindow::display, this, std::placeholders::_1));
+    // Set emulator display output to SDL screen, buttons come from the keyboard and controllers
+    emulator->setFrameSink(frame_sink);
+    emulator->setInputSource(input);
+
+    // Hold backspace to rewind
+    emulator->setRewindEnabled(true);
+
+    // A spare core draws the lines while the emulator's thread runs the CPU
+    emulator->get_GPU()->setPipelinedRendering(std::thread::hardware_concurrency() > 1);
+    emulator->get_APU()->setPipelinedSynthesis(pipelined_synthesis);
 
     // Get emulator joypad, hook up XInput joypad to emulator joypad
     joypad = emulator->get_Joypad();
     joypadx = std::make_shared<JoypadXInput>(joypad);   // Joypad XInput support
 }
 
+void SDLWindow::setPipelinedSynthesis(const bool & enable)
+{
+    pipelined_synthesis = enable;
+}
+
 void SDLWindow::display(std::array<SDL_Color, SCREEN_PIXEL_TOTAL> frame)
 {
     if (!renderer)
@@ -131,9 +148,7 @@ void SDLWindow::display(std::array<SDL_Color, SCREEN_PIXEL_TOTAL> frame)
         return;
     }
 
-    std::lock_guard<std::mutex> lg(renderer_mutex);
-    curr_frame = frame;
-    have_new_frame = true;
+    frame_sink->frameReady(frame.data());
 }
 
 void SDLWindow::updateWindowTitle(const std::string & framerate)
@@ -146,6 +161,10 @@ void SDLWindow::updateWindowTitle(const std::string & framerate)
         {
             title += " | " + framerate;
         }
+        if (emu->getRunAheadFrames() > 0)
+        {   // Cost of running ahead, to pick how many frames the host can afford
+            title += fmt::format(" | Run-ahead {}: {:.2f}", emu->getRunAheadFrames(), emu->runAheadTimeMicro.count() / 1000.0);
+        }
         SDL_SetWindowTitle(window, title.c_str());
     }
 }
@@ -165,6 +184,7 @@ int SDLWindow::run(bool start_emu)
     while (run)
     {   // Process input here
         SDL_PollEvent(&event);
+        input->handleEvent(event);
         switch (event.type)
         {
         case SDL_QUIT:
@@ -182,7 +202,18 @@ int SDLWindow::run(bool start_emu)
                 "";
 
             // Check file extension for valid game type
-            if (romIsValid(romNameStr))
+            if (emu && emu->getROMName() == romNameStr)
+            {   // Same ROM again, restarting it in place keeps the ROM, logs and audio device
+                emu->stop();
+                if (emu_thread.joinable())
+                {
+                    emu_thread.join();
+                }
+
+                emu->reset();
+                startEmulator();
+            }
+            else if (romIsValid(romNameStr))
             {
                 if (emu)
                 {
@@ -194,6 +225,7 @@ int SDLWindow::run(bool start_emu)
                     biosPath,
                     false,      // Debug mode
                     false);     // Force CGB mode
+                savestate.clear();  // Was for the last ROM
                 hookToEmulator(emu);
                 updateWindowTitle("");
                 startEmulator();
@@ -206,14 +238,7 @@ int SDLWindow::run(bool start_emu)
         {
             switch (event.key.keysym.sym)
             {
-            case SDLK_w: joypad->set_joypad_button(Joypad::BUTTON::UP);     break;
-            case SDLK_a: joypad->set_joypad_button(Joypad::BUTTON::LEFT);   break;
-            case SDLK_s: joypad->set_joypad_button(Joypad::BUTTON::DOWN);   break;
-            case SDLK_d: joypad->set_joypad_button(Joypad::BUTTON::RIGHT);  break;
-            case SDLK_z: joypad->set_joypad_button(Joypad::BUTTON::A);      break;
-            case SDLK_x: joypad->set_joypad_button(Joypad::BUTTON::B);      break;
-            case SDLK_m: joypad->set_joypad_button(Joypad::BUTTON::START);  break;
-            case SDLK_n: joypad->set_joypad_button(Joypad::BUTTON::SELECT); break;
+            case SDLK_BACKSPACE: emu->setRewinding(true);                   break;
             case SDLK_r:
             {
                 loadSaveState();
@@ -229,6 +254,16 @@ int SDLWindow::run(bool start_emu)
                 emu->changeCGBPalette();
                 break;
             }
+            case SDLK_p:
+            {
+                toggleAudioRecording();
+                break;
+            }
+            case SDLK_k:
+            {   // Cycle through the number of frames to run ahead
+                emu->setRunAheadFrames((emu->getRunAheadFrames() + 1) % (MAX_RUN_AHEAD_FRAMES + 1));
+                break;
+            }
             } // end switch()
             break;
         } // end case SDL_KEYDOWN
@@ -237,63 +272,11 @@ int SDLWindow::run(bool start_emu)
         {
             switch (event.key.keysym.sym)
             {
-            case SDLK_w: joypad->release_joypad_button(Joypad::BUTTON::UP);     break;
-            case SDLK_a: joypad->release_joypad_button(Joypad::BUTTON::LEFT);   break;
-            case SDLK_s: joypad->release_joypad_button(Joypad::BUTTON::DOWN);   break;
-            case SDLK_d: joypad->release_joypad_button(Joypad::BUTTON::RIGHT);  break;
-            case SDLK_z: joypad->release_joypad_button(Joypad::BUTTON::A);      break;
-            case SDLK_x: joypad->release_joypad_button(Joypad::BUTTON::B);      break;
-            case SDLK_m: joypad->release_joypad_button(Joypad::BUTTON::START);  break;
-            case SDLK_n: joypad->release_joypad_button(Joypad::BUTTON::SELECT); break;
+            case SDLK_BACKSPACE: emu->setRewinding(false);                      break;
             }
             break;
         } // end case SDL_KEYUP
 
-        case SDL_JOYBUTTONDOWN:
-        {
-            SDL_Log("JOYBUTTONDOWN %d", event.jbutton.button);
-
-            switch (event.jbutton.button)
-            {
-                case SDL_CONTROLLER_BUTTON_A:           emu->set_joypad_button(Joypad::BUTTON::A); break;
-                case SDL_CONTROLLER_BUTTON_B:           emu->set_joypad_button(Joypad::BUTTON::B); break;
-                case SDL_CONTROLLER_BUTTON_START:       emu->set_joypad_button(Joypad::BUTTON::START); break;
-                case SDL_CONTROLLER_BUTTON_LEFTSHOULDER:emu->set_joypad_button(Joypad::BUTTON::SELECT); break;
-                case SDL_CONTROLLER_BUTTON_DPAD_UP:     emu->set_joypad_button(Joypad::BUTTON::UP); break;
-                case SDL_CONTROLLER_BUTTON_DPAD_DOWN:   emu->set_joypad_button(Joypad::BUTTON::DOWN); break;
-                case SDL_CONTROLLER_BUTTON_DPAD_LEFT:   emu->set_joypad_button(Joypad::BUTTON::LEFT); break;
-                case SDL_CONTROLLER_BUTTON_DPAD_RIGHT:  emu->set_joypad_button(Joypad::BUTTON::RIGHT); break;
-                case SDL_CONTROLLER_BUTTON_BACK:
-                {
-                    //quit = true;
-                    break;
-                }
-            }
-            break;
-        }
-
-        case SDL_JOYBUTTONUP:
-        {
-            SDL_Log("JOYBUTTONUP %d", event.jbutton.button);
-
-            switch (event.jbutton.button)
-            {
-                case SDL_CONTROLLER_BUTTON_A:           emu->release_joypad_button(Joypad::BUTTON::A); break;
-                case SDL_CONTROLLER_BUTTON_B:           emu->release_joypad_button(Joypad::BUTTON::B); break;
-                case SDL_CONTROLLER_BUTTON_START:       emu->release_joypad_button(Joypad::BUTTON::START); break;
-                case SDL_CONTROLLER_BUTTON_LEFTSHOULDER:emu->release_joypad_button(Joypad::BUTTON::SELECT); break;
-                case SDL_CONTROLLER_BUTTON_DPAD_UP:     emu->release_joypad_button(Joypad::BUTTON::UP); break;
-                case SDL_CONTROLLER_BUTTON_DPAD_DOWN:   emu->release_joypad_button(Joypad::BUTTON::DOWN); break;
-                case SDL_CONTROLLER_BUTTON_DPAD_LEFT:   emu->release_joypad_button(Joypad::BUTTON::LEFT); break;
-                case SDL_CONTROLLER_BUTTON_DPAD_RIGHT:  emu->release_joypad_button(Joypad::BUTTON::RIGHT); break;
-                case SDL_CONTROLLER_BUTTON_BACK:
-                {
-
-                }
-            }
-            break;
-        }
-
         case SDL_WINDOWEVENT:
         {
             switch (event.window.event)
@@ -321,14 +304,12 @@ int SDLWindow::run(bool start_emu)
             joypadx->refreshButtonStates(using_connected_controller);
         }
 
-        if (have_new_frame)
+        if (frame_sink->updateTexture(screen_texture))
         {
             std::lock_guard<std::mutex> lg(renderer_mutex);
-            SDL_UpdateTexture(screen_texture, NULL, curr_frame.data(), SCREEN_PIXEL_W * sizeof(SDL_Color));
             //SDL_RenderClear(renderer);
             SDL_RenderCopy(renderer, screen_texture, NULL, NULL);
             SDL_RenderPresent(renderer);
-            have_new_frame = false;
 #ifndef __ANDROID__
             if (emu)
             {
@@ -410,6 +391,7 @@ bool SDLWindow::romIsValid(const std::string& filepath)
     return ret;
 }
 
+// Save state is kept in memory and written to "<ROM name>.state"
 void SDLWindow::takeSaveState()
 {
     if (!emu)
@@ -418,26 +400,33 @@ void SDLWindow::takeSaveState()
     }
 
     // Stop the emulator first so we don't save it while running
-    emu->setStopRunning(true);
-    if (emu_savestate)
+    emu->stop();
+    if (emu_thread.joinable())
     {
-        emu_savestate.reset();
+        emu_thread.join();
     }
 
-    // Create emulator savestate
-    emu_savestate = std::make_shared<GBCEmulator>(emu->getROMName(), emu->getROMName() + ".log");
-
-    // Copy current emulator into emulator savestate
-    *emu_savestate.get() = *emu.get();
+    emu->snapshot(savestate);
+    if (!writeSaveStateFile(emu->getROMName() + ".state", savestate))
+    {
+        logger->error("Failed to write save state to {}.state", emu->getROMName());
+    }
 
     // Start emulator again
     startEmulator();
 }
 
+// Loads the last save state taken, or "<ROM name>.state" if none have been taken since starting
 void SDLWindow::loadSaveState()
 {
-    if (!emu_savestate || !emu)
-    {   // Need a save state and an emulator to load a savestate
+    if (!emu)
+    {   // Need an emulator to load a savestate
+        return;
+    }
+
+    if (savestate.empty() &&
+        !readSaveStateFile(emu->getROMName() + ".state", savestate))
+    {
         return;
     }
 
@@ -448,9 +437,35 @@ void SDLWindow::loadSaveState()
         emu_thread.join();
     }
 
-    // Load emulator savestate into emulator
-    *emu.get() = *emu_savestate.get();
+    emu->restore(savestate);
+    startEmulator();
+}
+
+// Records audio to "<ROM name>.wav", with a file for each channel next to it
+void SDLWindow::toggleAudioRecording()
+{
+    if (!emu)
+    {
+        return;
+    }
+
+    // Stop the emulator first so the APU isn't running while recording starts or stops
+    emu->stop();
+    if (emu_thread.joinable())
+    {
+        emu_thread.join();
+    }
+
+    std::shared_ptr<APU> apu = emu->get_APU();
+    if (apu->isRecording())
+    {
+        apu->stopRecording();
+    }
+    else
+    {
+        apu->startRecording(emu->getROMName() + ".wav", true);
+    }
 
-    hookToEmulator(emu);
+    // Start emulator again
     startEmulator();
-}
\ No newline at end of file
+}
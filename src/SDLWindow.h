@@ -4,12 +4,14 @@
 #include <ScreenInterface.h>
 #include <GBCEmulator.h>
 #include <JoypadXInput.h>
+#include <SDLSinks.h>
 #include <atomic>
 #include <array>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 #include <spdlog/spdlog.h>
 
 extern "C" {
@@ -30,6 +32,8 @@ public:
 
     void display(std::array<SDL_Color, SCREEN_PIXEL_TOTAL> frame);
     void hookToEmulator(std::shared_ptr<GBCEmulator> emulator);
+    // Emulators hooked up from then on synthesize audio on the APU's own thread
+    void setPipelinedSynthesis(const bool & enable);
     static bool romIsValid(const std::string & filepath);
     static std::string getFileExtension(const std::string & filepath);
     int run(bool start_emu = false);
@@ -40,13 +44,15 @@ private:
     void updateWindowTitle(const std::string & framerate);
     void takeSaveState();
     void loadSaveState();
+    void toggleAudioRecording();
 
     std::shared_ptr<GBCEmulator> emu;
-    std::shared_ptr<GBCEmulator> emu_savestate;
+    std::vector<uint8_t> savestate;
     std::shared_ptr<Joypad> joypad;
     std::shared_ptr<JoypadXInput> joypadx;
     std::shared_ptr<spdlog::logger> logger;
-    std::array<SDL_Color, SCREEN_PIXEL_TOTAL> curr_frame;
+    std::shared_ptr<SDLFrameSink> frame_sink;
+    std::shared_ptr<SDLInputSource> input;
     std::thread emu_thread;
     std::mutex renderer_mutex;
     SDL_GLContext glContext;
@@ -57,7 +63,7 @@ private:
     SDL_Rect screen_texture_rect;
     uint64_t framerate;
     bool keep_aspect_ratio;
-    std::atomic_bool have_new_frame;
+    bool pipelined_synthesis;
     int using_connected_controller;
 };
 
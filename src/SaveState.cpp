@@ -0,0 +1,156 @@
+#ifdef _WIN32
+#include "stdafx.h"
+#endif // _WIN32
+
+#include "SaveState.h"
+#include <fstream>
+#include <zlib.h>
+
+StateWriter::StateWriter(std::vector<uint8_t> & state)
+    : state(state)
+    , pos(0)
+{
+
+}
+
+void StateWriter::writeBytes(const void * data, const size_t & num_bytes)
+{
+    if (num_bytes == 0)
+    {
+        return;
+    }
+
+    if (pos + num_bytes > state.size())
+    {   // Only allocates when the blob grows past its capacity
+        state.resize(pos + num_bytes);
+    }
+
+    std::memcpy(&state[pos], data, num_bytes);
+    pos += num_bytes;
+}
+
+void StateWriter::finish()
+{
+    state.resize(pos);
+}
+
+size_t StateWriter::getPosition() const
+{
+    return pos;
+}
+
+StateReader::StateReader(const uint8_t * data, const size_t & size)
+    : data(data)
+    , size(size)
+    , pos(0)
+    , failed(false)
+{
+
+}
+
+void StateReader::readBytes(void * out, const size_t & num_bytes)
+{
+    if (failed || num_bytes > size - pos)
+    {
+        failed = true;
+        return;
+    }
+
+    if (num_bytes > 0)
+    {
+        std::memcpy(out, data + pos, num_bytes);
+    }
+    pos += num_bytes;
+}
+
+bool StateReader::hasFailed() const
+{
+    return failed;
+}
+
+size_t StateReader::getPosition() const
+{
+    return pos;
+}
+
+bool writeSaveStateFile(const std::filesystem::path & path, const std::vector<uint8_t> & state, const bool & compress)
+{
+    SaveStateFileHeader header = {};
+    header.magic = SAVE_STATE_FILE_MAGIC;
+    header.state_size = state.size();
+
+    const uint8_t * data = state.data();
+    std::vector<uint8_t> compressed;
+    if (compress)
+    {
+        uLongf compressed_size = compressBound(static_cast<uLong>(state.size()));
+        compressed.resize(compressed_size);
+
+        if (compress2(compressed.data(), &compressed_size, state.data(), static_cast<uLong>(state.size()), Z_BEST_SPEED) != Z_OK)
+        {
+            return false;
+        }
+
+        compressed.resize(compressed_size);
+        data = compressed.data();
+        header.flags |= SAVE_STATE_FILE_COMPRESSED;
+    }
+    header.data_size = compress ? compressed.size() : state.size();
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(data), header.data_size);
+    return file.good();
+}
+
+bool readSaveStateFile(const std::filesystem::path & path, std::vector<uint8_t> & state)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    std::error_code ec;
+    const uintmax_t file_size = std::filesystem::file_size(path, ec);
+
+    SaveStateFileHeader header;
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (ec ||
+        !file.good() ||
+        header.magic != SAVE_STATE_FILE_MAGIC ||
+        header.data_size != file_size - sizeof(header) ||
+        header.state_size > SAVE_STATE_MAX_SIZE)
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> data(header.data_size);
+    file.read(reinterpret_cast<char *>(data.data()), data.size());
+    if (static_cast<uint64_t>(file.gcount()) != header.data_size)
+    {
+        return false;
+    }
+
+    if (!(header.flags & SAVE_STATE_FILE_COMPRESSED))
+    {
+        state = std::move(data);
+        return state.size() == header.state_size;
+    }
+
+    state.resize(header.state_size);
+    uLongf state_size = static_cast<uLongf>(header.state_size);
+    if (uncompress(state.data(), &state_size, data.data(), static_cast<uLong>(data.size())) != Z_OK ||
+        state_size != header.state_size)
+    {
+        state.clear();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,123 @@
+#ifndef SAVE_STATE_H
+#define SAVE_STATE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <type_traits>
+#include <vector>
+
+#define SAVE_STATE_MAGIC 0x53434247         // "GBCS"
+#define SAVE_STATE_VERSION 1                // Bump when anything written by saveState() changes
+#define SAVE_STATE_FILE_MAGIC 0x46434247    // "GBCF"
+#define SAVE_STATE_FILE_COMPRESSED 0x01
+#define SAVE_STATE_MAX_SIZE (1 << 24)       // Far more than any state, stops a bad file from allocating
+
+// Start of every state blob, checked before anything is restored
+struct SaveStateHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;              // Whole blob, header included
+    uint16_t rom_checksum;      // Global checksum from the cartridge header
+    uint16_t game_title_hash;
+    uint8_t is_color_gb;
+    uint8_t reserved[3];
+};
+
+// Start of a save state file, the state follows it, compressed with zlib when flagged
+struct SaveStateFileHeader {
+    uint32_t magic;
+    uint32_t flags;
+    uint64_t state_size;        // Uncompressed
+    uint64_t data_size;         // As stored in the file
+};
+
+// Writes plain data into a flat blob.
+// The blob is written over from the start and only grows, so once it's been
+// used for one snapshot the next ones don't allocate
+class StateWriter
+{
+public:
+    StateWriter(std::vector<uint8_t> & state);
+
+    template <typename T>
+    void write(const T & value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain data can be written to a state");
+        writeBytes(&value, sizeof(T));
+    }
+
+    template <typename T>
+    void writeVector(const std::vector<T> & values)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain data can be written to a state");
+        write(static_cast<uint32_t>(values.size()));
+        writeBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    // Overwrites something already written, like a header whose size wasn't known yet
+    template <typename T>
+    void writeAt(const size_t & pos, const T & value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain data can be written to a state");
+        std::memcpy(&state[pos], &value, sizeof(T));
+    }
+
+    void writeBytes(const void * data, const size_t & num_bytes);
+    // Trims the blob to what was written
+    void finish();
+    size_t getPosition() const;
+
+private:
+    std::vector<uint8_t> & state;
+    size_t pos;
+};
+
+// Reads plain data back out of a blob written by StateWriter.
+// Reading past the end marks the reader as failed and leaves the values untouched
+class StateReader
+{
+public:
+    StateReader(const uint8_t * data, const size_t & size);
+
+    template <typename T>
+    void read(T & value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain data can be read from a state");
+        readBytes(&value, sizeof(T));
+    }
+
+    // 'values' is only resized if its size changed
+    template <typename T>
+    void readVector(std::vector<T> & values)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain data can be read from a state");
+        uint32_t num_values = 0;
+        read(num_values);
+
+        if (failed || (static_cast<size_t>(num_values) * sizeof(T)) > size - pos)
+        {
+            failed = true;
+            return;
+        }
+
+        values.resize(num_values);
+        readBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    void readBytes(void * data, const size_t & num_bytes);
+    bool hasFailed() const;
+    size_t getPosition() const;
+
+private:
+    const uint8_t * data;
+    size_t size;
+    size_t pos;
+    bool failed;
+};
+
+bool writeSaveStateFile(const std::filesystem::path & path, const std::vector<uint8_t> & state, const bool & compress = true);
+bool readSaveStateFile(const std::filesystem::path & path, std::vector<uint8_t> & state);
+
+#endif // SAVE_STATE_H
@@ -22,6 +22,28 @@ SerialTransfer::~SerialTransfer()
 
 }
 
+void SerialTransfer::saveState(StateWriter & state) const
+{
+    state.write(transfer_enabled);
+    state.write(register_sb);
+    state.write(register_sc);
+    state.write(transfer_bit);
+    state.write(transfer_step);
+    state.write(transfer_clock_load);
+    state.write(transfer_clocks_accumulated);
+}
+
+void SerialTransfer::loadState(StateReader & state)
+{
+    state.read(transfer_enabled);
+    state.read(register_sb);
+    state.read(register_sc);
+    state.read(transfer_bit);
+    state.read(transfer_step);
+    state.read(transfer_clock_load);
+    state.read(transfer_clocks_accumulated);
+}
+
 void SerialTransfer::setByte(const uint16_t& addr, const uint8_t& val, const bool is_color_gb)
 {
     switch (addr)
@@ -38,6 +60,13 @@ void SerialTransfer::setByte(const uint16_t& addr, const uint8_t& val, const boo
 
             register_sc = val & 0x83;
 
+            // Transfers never finish without a link partner, so every write starting one sends SB
+            if ((register_sc & BIT7) &&
+                sent_bytes.size() < SERIAL_SENT_BYTES_MAX)
+            {
+                sent_bytes += static_cast<char>(register_sb);
+            }
+
             if (!prev_enabled &&
                 (register_sc & BIT7))
             {   // Just enabled serial transfer
@@ -122,4 +151,14 @@ bool SerialTransfer::tick(const uint8_t& ticks)
 void SerialTransfer::setTransferBit(const uint8_t& _transfer_bit)
 {
     transfer_bit = _transfer_bit & 0x01;
-}
\ No newline at end of file
+}
+
+std::string SerialTransfer::getSentBytes() const
+{
+    return sent_bytes;
+}
+
+void SerialTransfer::clearSentBytes()
+{
+    sent_bytes.clear();
+}
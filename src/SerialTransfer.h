@@ -3,7 +3,11 @@
 
 #include <stdint.h>
 #include <memory>
+#include <string>
 #include <spdlog/spdlog.h>
+#include "SaveState.h"
+
+#define SERIAL_SENT_BYTES_MAX 0x10000   // Bytes kept by getSentBytes(), later ones are dropped
 
 class SerialTransfer
 {
@@ -11,10 +15,16 @@ public:
     SerialTransfer(std::shared_ptr<spdlog::logger> logger);
     virtual ~SerialTransfer();
 
+    void saveState(StateWriter & state) const;
+    void loadState(StateReader & state);
+
     void setByte(const uint16_t& addr, const uint8_t& val, const bool is_color_gb);
     uint8_t readByte(const uint16_t& addr) const;
     bool tick(const uint8_t& ticks);
     void setTransferBit(const uint8_t& transfer_bit);
+    // Every byte the game has started sending, test ROMs print their results this way
+    std::string getSentBytes() const;
+    void clearSentBytes();
 
 private:
     std::shared_ptr<spdlog::logger> logger;
@@ -25,6 +35,7 @@ private:
     uint8_t transfer_step;
     uint16_t transfer_clock_load;
     uint16_t transfer_clocks_accumulated;
+    std::string sent_bytes;
 };
 
 #endif // SRC_SERIALTRANSFER_H
\ No newline at end of file
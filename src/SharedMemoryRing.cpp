@@ -0,0 +1,215 @@
+#include "SharedMemoryRing.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    size_t alignUp(const size_t & size)
+    {
+        return (size + SHM_RING_ALIGNMENT - 1) / SHM_RING_ALIGNMENT * SHM_RING_ALIGNMENT;
+    }
+
+    size_t getSlotStride(const uint32_t & slot_size)
+    {
+        return alignUp(sizeof(SharedMemoryRingSlot) + slot_size);
+    }
+
+    std::runtime_error makeError(const std::string & what, const std::string & name)
+    {
+        return std::runtime_error(what + " " + name + ": " + std::strerror(errno));
+    }
+}
+
+SharedMemoryRing::SharedMemoryRing(const std::string & name, const uint32_t & num_slots, const uint32_t & slot_size)
+    : name(name)
+    , memory(nullptr)
+    , memory_size(alignUp(sizeof(SharedMemoryRingHeader)) + num_slots * getSlotStride(slot_size))
+    , header(nullptr)
+    , next_entry(0)
+{
+    if (num_slots == 0)
+    {
+        throw std::runtime_error("Shared memory ring " + name + " needs at least one slot");
+    }
+
+    // Whatever was left behind by a server that didn't exit cleanly goes first
+    shm_unlink(name.c_str());
+
+    const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        throw makeError("Could not create shared memory", name);
+    }
+
+    if (ftruncate(fd, memory_size) != 0)
+    {
+        const std::runtime_error error = makeError("Could not size shared memory", name);
+        close(fd);
+        shm_unlink(name.c_str());
+        throw error;
+    }
+
+    void * mapped = mmap(nullptr, memory_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        const std::runtime_error error = makeError("Could not map shared memory", name);
+        shm_unlink(name.c_str());
+        throw error;
+    }
+    memory = static_cast<uint8_t *>(mapped);
+
+    // ftruncate() zeroed it all, every slot's sequence starts at 0, never written
+    header = new (memory) SharedMemoryRingHeader();
+    header->magic = SHM_RING_MAGIC;
+    header->version = SHM_RING_VERSION;
+    header->num_slots = num_slots;
+    header->slot_size = slot_size;
+    header->write_sequence.store(0, std::memory_order_release);
+
+    for (uint32_t i = 0; i < num_slots; i++)
+    {
+        new (getSlot(i)) SharedMemoryRingSlot();
+    }
+}
+
+SharedMemoryRing::~SharedMemoryRing()
+{
+    munmap(memory, memory_size);
+    shm_unlink(name.c_str());
+}
+
+void SharedMemoryRing::setInfo(const uint32_t & info0, const uint32_t & info1)
+{
+    header->info[0] = info0;
+    header->info[1] = info1;
+}
+
+uint8_t * SharedMemoryRing::beginEntry()
+{
+    SharedMemoryRingSlot * slot = getSlot(next_entry);
+
+    // Readers still copying the old entry out see the sequence move and drop it
+    slot->sequence.store(2 * next_entry + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    return reinterpret_cast<uint8_t *>(slot) + sizeof(SharedMemoryRingSlot);
+}
+
+uint64_t SharedMemoryRing::commitEntry(const size_t & size, const uint64_t & tag)
+{
+    SharedMemoryRingSlot * slot = getSlot(next_entry);
+    slot->tag = tag;
+    slot->size = static_cast<uint32_t>(std::min<size_t>(size, header->slot_size));
+    slot->sequence.store(2 * next_entry + 2, std::memory_order_release);
+
+    header->write_sequence.store(next_entry + 1, std::memory_order_release);
+    return next_entry++;
+}
+
+uint64_t SharedMemoryRing::publish(const void * data, const size_t & size, const uint64_t & tag)
+{
+    uint8_t * entry = beginEntry();
+    std::memcpy(entry, data, std::min<size_t>(size, header->slot_size));
+    return commitEntry(size, tag);
+}
+
+const std::string & SharedMemoryRing::getName() const
+{
+    return name;
+}
+
+uint32_t SharedMemoryRing::getSlotSize() const
+{
+    return header->slot_size;
+}
+
+uint64_t SharedMemoryRing::getWriteSequence() const
+{
+    return next_entry;
+}
+
+SharedMemoryRingSlot * SharedMemoryRing::getSlot(const uint64_t & entry) const
+{
+    const size_t offset = alignUp(sizeof(SharedMemoryRingHeader)) + (entry % header->num_slots) * getSlotStride(header->slot_size);
+    return reinterpret_cast<SharedMemoryRingSlot *>(memory + offset);
+}
+
+SharedMemoryRingReader::SharedMemoryRingReader(const std::string & name)
+    : memory(nullptr)
+    , memory_size(0)
+    , header(nullptr)
+{
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+    {
+        throw makeError("Could not open shared memory", name);
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SharedMemoryRingHeader))
+    {
+        close(fd);
+        throw std::runtime_error("Shared memory " + name + " is too small for a ring");
+    }
+    memory_size = info.st_size;
+
+    void * mapped = mmap(nullptr, memory_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        throw makeError("Could not map shared memory", name);
+    }
+    memory = static_cast<const uint8_t *>(mapped);
+    header = reinterpret_cast<const SharedMemoryRingHeader *>(memory);
+
+    if (header->magic != SHM_RING_MAGIC ||
+        header->version != SHM_RING_VERSION ||
+        alignUp(sizeof(SharedMemoryRingHeader)) + header->num_slots * getSlotStride(header->slot_size) > memory_size)
+    {
+        munmap(const_cast<uint8_t *>(memory), memory_size);
+        throw std::runtime_error("Shared memory " + name + " isn't a ring this version can read");
+    }
+}
+
+SharedMemoryRingReader::~SharedMemoryRingReader()
+{
+    munmap(const_cast<uint8_t *>(memory), memory_size);
+}
+
+bool SharedMemoryRingReader::read(const uint64_t & entry, std::vector<uint8_t> & out, uint64_t & tag) const
+{
+    const size_t offset = alignUp(sizeof(SharedMemoryRingHeader)) + (entry % header->num_slots) * getSlotStride(header->slot_size);
+    const SharedMemoryRingSlot * slot = reinterpret_cast<const SharedMemoryRingSlot *>(memory + offset);
+    const uint64_t written = 2 * entry + 2;
+
+    if (slot->sequence.load(std::memory_order_acquire) != written)
+    {
+        return false;
+    }
+
+    const uint32_t size = std::min(slot->size, header->slot_size);
+    out.resize(size);
+    std::memcpy(out.data(), reinterpret_cast<const uint8_t *>(slot) + sizeof(SharedMemoryRingSlot), size);
+    tag = slot->tag;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot->sequence.load(std::memory_order_relaxed) == written;
+}
+
+const SharedMemoryRingHeader & SharedMemoryRingReader::getHeader() const
+{
+    return *header;
+}
+
+uint64_t SharedMemoryRingReader::getWriteSequence() const
+{
+    return header->write_sequence.load(std::memory_order_acquire);
+}
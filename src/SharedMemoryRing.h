@@ -0,0 +1,95 @@
+#ifndef SHARED_MEMORY_RING_H
+#define SHARED_MEMORY_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define SHM_RING_MAGIC 0x52434247       // "GBCR"
+#define SHM_RING_VERSION 1
+#define SHM_RING_ALIGNMENT 64           // Header and every slot start on a cache line of their own
+
+// Layout of a ring in POSIX shared memory, for readers in any language:
+// a SharedMemoryRingHeader, then 'num_slots' slots, each a SharedMemoryRingSlot followed by 'slot_size' bytes,
+// with the header and each slot padded out to a multiple of SHM_RING_ALIGNMENT.
+// Entry n goes in slot n % num_slots. Its slot's sequence is odd while it's written and 2 * (n + 1) once
+// it's done, so a reader checks the sequence before and after copying an entry out and retries if it moved
+struct SharedMemoryRingHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_slots;
+    uint32_t slot_size;
+    uint32_t info[2];                       // Frames: width, height. Audio: sample rate, SDL_AudioFormat
+    std::atomic<uint64_t> write_sequence;   // Entries written so far, the newest is write_sequence - 1
+};
+
+struct SharedMemoryRingSlot
+{
+    std::atomic<uint64_t> sequence;
+    uint64_t tag;       // Frames and RAM: frame number. Audio: byte offset into the stream
+    uint32_t size;      // Bytes of the slot used
+    uint32_t reserved;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared memory sequences have to be lock free");
+
+// Single writer side of a ring, which creates the shared memory object and unlinks it when it goes.
+// Writing never waits on readers, slow readers just miss entries
+class SharedMemoryRing
+{
+public:
+    // 'name' is a POSIX shared memory name, '/something'. Replaces a ring left behind with the same name.
+    // Throws if the shared memory can't be made
+    SharedMemoryRing(const std::string & name, const uint32_t & num_slots, const uint32_t & slot_size);
+    virtual ~SharedMemoryRing();
+    SharedMemoryRing(const SharedMemoryRing &) = delete;
+    SharedMemoryRing& operator=(const SharedMemoryRing &) = delete;
+
+    void setInfo(const uint32_t & info0, const uint32_t & info1);
+
+    // Writing straight into the next slot, 'slot_size' bytes, then committing 'size' of them
+    uint8_t * beginEntry();
+    uint64_t commitEntry(const size_t & size, const uint64_t & tag);
+    // Copies 'size' bytes, no more than 'slot_size', in as the next entry. Returns its number
+    uint64_t publish(const void * data, const size_t & size, const uint64_t & tag);
+
+    const std::string & getName() const;
+    uint32_t getSlotSize() const;
+    uint64_t getWriteSequence() const;
+
+private:
+    SharedMemoryRingSlot * getSlot(const uint64_t & entry) const;
+
+    std::string name;
+    uint8_t * memory;
+    size_t memory_size;
+    SharedMemoryRingHeader * header;
+    uint64_t next_entry;
+};
+
+// Read only view of a ring another process writes
+class SharedMemoryRingReader
+{
+public:
+    // Throws if there's no ring called 'name'
+    SharedMemoryRingReader(const std::string & name);
+    virtual ~SharedMemoryRingReader();
+    SharedMemoryRingReader(const SharedMemoryRingReader &) = delete;
+    SharedMemoryRingReader& operator=(const SharedMemoryRingReader &) = delete;
+
+    // Returns false if 'entry' hasn't been written yet or was overwritten while it was read
+    bool read(const uint64_t & entry, std::vector<uint8_t> & out, uint64_t & tag) const;
+
+    const SharedMemoryRingHeader & getHeader() const;
+    uint64_t getWriteSequence() const;
+
+private:
+    const uint8_t * memory;
+    size_t memory_size;
+    const SharedMemoryRingHeader * header;
+};
+
+#endif // SHARED_MEMORY_RING_H
@@ -0,0 +1,75 @@
+#include "SharedMemorySinks.h"
+#include <algorithm>
+
+SharedMemoryFrameSink::SharedMemoryFrameSink(std::shared_ptr<SharedMemoryRing> ring)
+    : ring(ring)
+    , frame_count(0)
+{
+    ring->setInfo(SCREEN_PIXEL_W, SCREEN_PIXEL_H);
+}
+
+void SharedMemoryFrameSink::frameReady(const SDL_Color * frame)
+{
+    ring->publish(frame, sizeof(SDL_Color) * SCREEN_PIXEL_TOTAL, frame_count++);
+}
+
+SharedMemoryAudioSink::SharedMemoryAudioSink(std::shared_ptr<SharedMemoryRing> ring)
+    : ring(ring)
+    , bytes_written(0)
+    , entry_size(ring->getSlotSize())
+{
+
+}
+
+int SharedMemoryAudioSink::open(const int & sample_rate, const SDL_AudioFormat & format, const uint32_t &)
+{
+    ring->setInfo(sample_rate, format);
+    entry_size = ring->getSlotSize() / getAudioSampleSize(format) * getAudioSampleSize(format);
+    return sample_rate;
+}
+
+void SharedMemoryAudioSink::close()
+{
+
+}
+
+void SharedMemoryAudioSink::setPaused(const bool &)
+{
+
+}
+
+size_t SharedMemoryAudioSink::write(const uint8_t * data, const size_t & num_bytes)
+{
+    for (size_t pos = 0; pos < num_bytes && entry_size > 0; pos += entry_size)
+    {
+        const size_t size = std::min(entry_size, num_bytes - pos);
+        ring->publish(data + pos, size, bytes_written);
+        bytes_written += size;
+    }
+    return num_bytes;
+}
+
+void SharedMemoryAudioSink::clear()
+{
+
+}
+
+bool SharedMemoryAudioSink::isRealTime() const
+{
+    return false;
+}
+
+size_t SharedMemoryAudioSink::getBufferedBytes() const
+{
+    return 0;
+}
+
+void SharedMemoryAudioSink::waitForBufferedBytes(const size_t &, const std::chrono::milliseconds &)
+{
+
+}
+
+AudioRingBufferStats SharedMemoryAudioSink::getStats() const
+{
+    return {};
+}
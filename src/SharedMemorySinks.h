@@ -0,0 +1,47 @@
+#ifndef SHARED_MEMORY_SINKS_H
+#define SHARED_MEMORY_SINKS_H
+
+#include <AudioSink.h>
+#include <FrameSink.h>
+#include <SharedMemoryRing.h>
+#include <memory>
+
+// Publishes every frame into a ring as its next entry, tagged with the frame's number
+class SharedMemoryFrameSink : public FrameSink
+{
+public:
+    // The ring's slots have to fit a frame, SCREEN_PIXEL_TOTAL SDL_Colors
+    SharedMemoryFrameSink(std::shared_ptr<SharedMemoryRing> ring);
+
+    void frameReady(const SDL_Color * frame);
+
+private:
+    std::shared_ptr<SharedMemoryRing> ring;
+    uint64_t frame_count;
+};
+
+// Publishes the audio into a ring as it's written, split into entries of up to a slot each,
+// tagged with their byte offset into the stream. Never real time, the emulator isn't held back
+class SharedMemoryAudioSink : public AudioSink
+{
+public:
+    SharedMemoryAudioSink(std::shared_ptr<SharedMemoryRing> ring);
+
+    int open(const int & sample_rate, const SDL_AudioFormat & format, const uint32_t & target_buffer_ms);
+    void close();
+    void setPaused(const bool & paused);
+    size_t write(const uint8_t * data, const size_t & num_bytes);
+    void clear();
+
+    bool isRealTime() const;
+    size_t getBufferedBytes() const;
+    void waitForBufferedBytes(const size_t & target_bytes, const std::chrono::milliseconds & timeout);
+    AudioRingBufferStats getStats() const;
+
+private:
+    std::shared_ptr<SharedMemoryRing> ring;
+    uint64_t bytes_written;
+    size_t entry_size;      // Whole samples that fit in a slot
+};
+
+#endif // SHARED_MEMORY_SINKS_H
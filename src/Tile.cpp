@@ -4,6 +4,7 @@
 #endif // _WIN32
 
 #include "Tile.h"
+#include <algorithm>
 
 Tile::Tile()
     : color_palette(NULL)
@@ -27,6 +28,16 @@ void Tile::updateRawData(const uint8_t & pos, const uint8_t & val)
 	}
 }
 
+void Tile::setRawData(const uint8_t * data)
+{
+    std::copy(data, data + NUM_BYTES_PER_TILE, raw_data.begin());
+
+    for (uint8_t row_num = 0; row_num < 8; row_num++)
+    {
+        updatePixelRow(row_num);
+    }
+}
+
 void Tile::updatePixelRow(const uint8_t & row_num)
 {
 	if (row_num < 8)
@@ -78,12 +89,12 @@ void Tile::parseCGBAttribute()
     bg_to_OAM_priority      = cgb_attribute & 0x80;
 }
 
-void Tile::setCGBColorPalette(ColorPalette * colorPalette)
+void Tile::setCGBColorPalette(const ColorPalette * colorPalette)
 {
     color_palette = colorPalette;
 }
 
-ColorPalette* Tile::getCGBColorPalette() const
+const ColorPalette* Tile::getCGBColorPalette() const
 {
     return color_palette;
 }
\ No newline at end of file
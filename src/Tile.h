@@ -16,11 +16,13 @@ public:
 	~Tile();
 
 	void updateRawData(const uint8_t & pos, const uint8_t & val);
+    // Replaces all NUM_BYTES_PER_TILE bytes of the tile
+    void setRawData(const uint8_t * data);
     uint8_t getPixel(const uint8_t & row, const uint8_t & column) const;
     const std::vector<uint8_t>& getRawPixelData() const;
     void setCGBAttribute(const uint8_t & attribute_byte);
-    void setCGBColorPalette(ColorPalette * color_palette);
-    ColorPalette* getCGBColorPalette() const;
+    void setCGBColorPalette(const ColorPalette * color_palette);
+    const ColorPalette* getCGBColorPalette() const;
 
     std::vector<uint8_t> pixels;
 
@@ -37,7 +39,7 @@ private:
     bool horizontal_flip;
     bool vertical_flip;
     bool bg_to_OAM_priority;
-    ColorPalette * color_palette;
+    const ColorPalette * color_palette;
 };
 
 
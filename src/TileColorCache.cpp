@@ -0,0 +1,144 @@
+#ifdef _WIN32
+#include "stdafx.h"
+#endif // _WIN32
+
+#include "TileColorCache.h"
+
+TileColorCache::TileColorCache(const size_t & budget_bytes)
+    : slot_bits(0)
+{
+    // Use the largest power of 2 number of slots that fits in the budget
+    size_t num_slots = 1;
+    size_t fixed_bytes = sizeof(tile_generations);
+    while (fixed_bytes + (num_slots * 2 * sizeof(Entry)) <= budget_bytes && slot_bits < 16)
+    {
+        num_slots *= 2;
+        slot_bits++;
+    }
+
+    entries.resize(num_slots);
+    clear();
+    resetStats();
+}
+
+TileColorCache::~TileColorCache()
+{
+
+}
+
+const SDL_Color * TileColorCache::getRow(const Tile & tile, const uint8_t & vram_bank, const uint16_t & tile_index,
+    const ColorPalette & palette, const uint8_t & palette_num, const uint32_t & palette_generation,
+    const bool & is_sprite, const bool & horizontal_flip, const bool & vertical_flip, const uint8_t & row)
+{
+    const uint8_t palette_id = (palette_num & 0x07) | (is_sprite ? 0x08 : 0x00);
+    const uint32_t key = getKey(vram_bank, tile_index, palette_id, horizontal_flip, vertical_flip);
+    const uint32_t tile_generation = tile_generations[(vram_bank & 0x01) * TILE_COLOR_CACHE_NUM_TILES + tile_index];
+
+    Entry & entry = entries[getSlot(key)];
+
+    if (entry.valid &&
+        entry.key == key &&
+        entry.tile_generation == tile_generation &&
+        entry.palette_generation == palette_generation)
+    {
+        stats.hits++;
+    }
+    else
+    {
+        stats.misses++;
+        if (entry.valid && entry.key != key)
+        {   // Slot is being reused by a different tile
+            stats.evictions++;
+        }
+
+        fillEntry(entry, tile, palette, is_sprite, horizontal_flip, vertical_flip);
+        entry.key = key;
+        entry.tile_generation = tile_generation;
+        entry.palette_generation = palette_generation;
+        entry.valid = true;
+    }
+
+    return &entry.colors[(row & 0x07) * 8];
+}
+
+void TileColorCache::invalidateTile(const uint8_t & vram_bank, const uint16_t & tile_index)
+{
+    tile_generations[(vram_bank & 0x01) * TILE_COLOR_CACHE_NUM_TILES + tile_index]++;
+    stats.invalidations++;
+}
+
+void TileColorCache::clear()
+{
+    for (Entry & entry : entries)
+    {
+        entry.valid = false;
+    }
+    tile_generations.fill(0);
+}
+
+const TileColorCacheStats & TileColorCache::getStats() const
+{
+    return stats;
+}
+
+void TileColorCache::resetStats()
+{
+    stats = {};
+}
+
+size_t TileColorCache::getNumSlots() const
+{
+    return entries.size();
+}
+
+size_t TileColorCache::getMemoryUsage() const
+{
+    return (entries.size() * sizeof(Entry)) + sizeof(tile_generations);
+}
+
+uint32_t TileColorCache::getKey(const uint8_t & vram_bank, const uint16_t & tile_index, const uint8_t & palette_id,
+    const bool & horizontal_flip, const bool & vertical_flip) const
+{
+    // | bank (1) | tile index (9) | palette id (4) | v flip (1) | h flip (1) |
+    return ((vram_bank & 0x01) << 15) |
+        ((tile_index & 0x1FF) << 6) |
+        ((palette_id & 0x0F) << 2) |
+        (vertical_flip << 1) |
+        horizontal_flip;
+}
+
+size_t TileColorCache::getSlot(const uint32_t & key) const
+{
+    if (slot_bits == 0)
+    {
+        return 0;
+    }
+
+    // Fibonacci hashing, spreads neighbouring tiles across the slots
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> (64 - slot_bits));
+}
+
+void TileColorCache::fillEntry(Entry & entry, const Tile & tile, const ColorPalette & palette, const bool & is_sprite,
+    const bool & horizontal_flip, const bool & vertical_flip)
+{
+    const std::vector<uint8_t> & tile_data = tile.getRawPixelData();
+
+    for (uint8_t row = 0; row < 8; row++)
+    {
+        const uint8_t pixel_use_row = vertical_flip ? 7 - row : row;
+
+        for (uint8_t col = 0; col < 8; col++)
+        {
+            const uint8_t pixel_use_col = horizontal_flip ? 7 - col : col;
+            const uint8_t & pixel = tile_data[pixel_use_col + (pixel_use_row * 8)];
+
+            SDL_Color & color = entry.colors[col + (row * 8)];
+            color = palette.getColor(pixel);
+
+            if (is_sprite)
+            {   // Color 0 == transparent for sprites
+                color.a = (pixel == 0) ? 0x00 : 0xFF;
+            }
+        }
+    }
+}
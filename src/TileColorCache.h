@@ -0,0 +1,70 @@
+#ifndef TILE_COLOR_CACHE_H
+#define TILE_COLOR_CACHE_H
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <SDLTypes.h>
+#include "Tile.h"
+#include "ColorPalette.h"
+
+#define TILE_COLOR_CACHE_BUDGET_BYTES (512 * 1024)
+#define TILE_COLOR_CACHE_NUM_VRAM_BANKS 2
+#define TILE_COLOR_CACHE_NUM_TILES (NUM_BG_TILE_BLOCKS * NUM_BG_TILES_PER_BLOCK)
+#define TILE_COLOR_CACHE_NUM_PALETTES 16    // 8 Background + 8 Sprite palettes
+
+struct TileColorCacheStats
+{
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t invalidations;
+};
+
+// Cache of Tiles already converted to SDL_Colors, keyed by VRAM bank, tile index, palette and flip.
+// Entries are direct mapped into a fixed number of slots so the cache never grows past its budget.
+// Palette contents are versioned by the caller, which passes the palette's generation number.
+class TileColorCache
+{
+public:
+    TileColorCache(const size_t & budget_bytes = TILE_COLOR_CACHE_BUDGET_BYTES);
+    virtual ~TileColorCache();
+
+    // Returns 8 colors for the wanted row, flips already applied.
+    // Sprite color 0 is returned with alpha 0 (transparent)
+    const SDL_Color * getRow(const Tile & tile, const uint8_t & vram_bank, const uint16_t & tile_index,
+        const ColorPalette & palette, const uint8_t & palette_num, const uint32_t & palette_generation,
+        const bool & is_sprite, const bool & horizontal_flip, const bool & vertical_flip, const uint8_t & row);
+
+    void invalidateTile(const uint8_t & vram_bank, const uint16_t & tile_index);
+    void clear();
+
+    const TileColorCacheStats & getStats() const;
+    void resetStats();
+    size_t getNumSlots() const;
+    size_t getMemoryUsage() const;
+
+private:
+    struct Entry
+    {
+        uint32_t key;
+        uint32_t tile_generation;
+        uint32_t palette_generation;
+        bool valid;
+        std::array<SDL_Color, 8 * 8> colors;
+    };
+
+    uint32_t getKey(const uint8_t & vram_bank, const uint16_t & tile_index, const uint8_t & palette_id,
+        const bool & horizontal_flip, const bool & vertical_flip) const;
+    size_t getSlot(const uint32_t & key) const;
+    void fillEntry(Entry & entry, const Tile & tile, const ColorPalette & palette, const bool & is_sprite,
+        const bool & horizontal_flip, const bool & vertical_flip);
+
+    std::vector<Entry> entries;
+    std::array<uint32_t, TILE_COLOR_CACHE_NUM_VRAM_BANKS * TILE_COLOR_CACHE_NUM_TILES> tile_generations;
+    uint8_t slot_bits;
+    TileColorCacheStats stats;
+};
+
+#endif // TILE_COLOR_CACHE_H
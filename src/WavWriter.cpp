@@ -0,0 +1,193 @@
+#ifdef _WIN32
+#include "stdafx.h"
+#endif // _WIN32
+
+#include "WavWriter.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+
+#define WAV_HEADER_SIZE 58             // RIFF, fmt with an empty extension, fact and data chunk headers
+#define WAV_FORMAT_IEEE_FLOAT 3
+
+WavWriter::WavWriter()
+    : data_bytes(0)
+    , sample_rate(0)
+    , num_channels(0)
+    , stop_writer_thread(false)
+    , failed(false)
+{
+
+}
+
+WavWriter::~WavWriter()
+{
+    close();
+}
+
+bool WavWriter::open(const std::filesystem::path & path, const uint32_t & rate, const uint16_t & channels)
+{
+    close();
+
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    sample_rate = rate;
+    num_channels = channels;
+    data_bytes = 0;
+    failed = false;
+
+    // Sizes are filled in when the file is closed
+    writeHeader();
+
+    queue = std::make_unique<AudioRingBuffer>(WAV_WRITER_QUEUE_BYTES);
+    file_buffer.reserve(WAV_WRITER_FILE_BUFFER_BYTES + WAV_WRITER_QUEUE_BYTES);
+
+    stop_writer_thread = false;
+    writer_thread = std::thread(&WavWriter::writerThreadLoop, this);
+    return true;
+}
+
+void WavWriter::close()
+{
+    if (!writer_thread.joinable())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lg(writer_mutex);
+        stop_writer_thread = true;
+    }
+    writer_cv.notify_all();
+    writer_thread.join();
+
+    // Writer thread has emptied the queue, go back and fill in the sizes
+    file.seekp(0);
+    writeHeader();
+    file.close();
+}
+
+bool WavWriter::isOpen() const
+{
+    return writer_thread.joinable();
+}
+
+void WavWriter::write(const float * samples, const size_t & num_values)
+{
+    if (!queue)
+    {
+        return;
+    }
+
+    queue->write(reinterpret_cast<const uint8_t *>(samples), num_values * sizeof(float));
+}
+
+AudioRingBufferStats WavWriter::getQueueStats() const
+{
+    return queue ? queue->getStats() : AudioRingBufferStats{ 0, 0, 0 };
+}
+
+bool WavWriter::hasFailed() const
+{
+    return failed;
+}
+
+// Empties the queue every WAV_WRITER_POLL_MS, and once more when stopped
+void WavWriter::writerThreadLoop()
+{
+    std::unique_lock<std::mutex> lk(writer_mutex);
+
+    while (!stop_writer_thread)
+    {
+        writer_cv.wait_for(lk, std::chrono::milliseconds(WAV_WRITER_POLL_MS), [this]() { return stop_writer_thread; });
+
+        writeQueuedSamples();
+        if (file_buffer.size() >= WAV_WRITER_FILE_BUFFER_BYTES)
+        {
+            flushFileBuffer();
+        }
+    }
+
+    writeQueuedSamples();
+    flushFileBuffer();
+}
+
+void WavWriter::writeQueuedSamples()
+{
+    // Only read what's there, reading more would count as an underrun
+    const size_t num_bytes = queue->getBufferedBytes();
+    const size_t offset = file_buffer.size();
+
+    file_buffer.resize(offset + num_bytes);
+    queue->read(&file_buffer[offset], num_bytes, 0);
+}
+
+void WavWriter::flushFileBuffer()
+{
+    if (file_buffer.empty())
+    {
+        return;
+    }
+
+    file.write(reinterpret_cast<const char *>(file_buffer.data()), file_buffer.size());
+    if (!file.good())
+    {
+        failed = true;
+    }
+
+    data_bytes += file_buffer.size();
+    file_buffer.clear();
+}
+
+void WavWriter::writeHeader()
+{
+    std::array<uint8_t, WAV_HEADER_SIZE> header;
+    size_t pos = 0;
+
+    // .wav is little endian
+    auto put = [&header, &pos](const uint32_t & value, const size_t & num_bytes)
+    {
+        for (size_t i = 0; i < num_bytes; i++)
+        {
+            header[pos++] = static_cast<uint8_t>(value >> (i * 8));
+        }
+    };
+    auto putTag = [&header, &pos](const char * tag)
+    {
+        for (size_t i = 0; i < 4; i++)
+        {
+            header[pos++] = static_cast<uint8_t>(tag[i]);
+        }
+    };
+
+    const uint32_t data_size = static_cast<uint32_t>(std::min<uint64_t>(data_bytes, UINT32_MAX - WAV_HEADER_SIZE));
+    const uint16_t block_align = num_channels * sizeof(float);
+
+    putTag("RIFF");
+    put(data_size + WAV_HEADER_SIZE - 8, 4);
+    putTag("WAVE");
+
+    putTag("fmt ");
+    put(18, 4);                             // fmt chunk size
+    put(WAV_FORMAT_IEEE_FLOAT, 2);
+    put(num_channels, 2);
+    put(sample_rate, 4);
+    put(sample_rate * block_align, 4);      // Bytes per second
+    put(block_align, 2);
+    put(sizeof(float) * 8, 2);              // Bits per sample
+    put(0, 2);                              // Extension size, formats other than PCM have to have one
+
+    // Formats other than PCM also have to say how long they are in samples
+    putTag("fact");
+    put(4, 4);
+    put(block_align ? data_size / block_align : 0, 4);
+
+    putTag("data");
+    put(data_size, 4);
+
+    file.write(reinterpret_cast<const char *>(header.data()), header.size());
+}
@@ -0,0 +1,58 @@
+#ifndef WAV_WRITER_H
+#define WAV_WRITER_H
+
+#include <AudioRingBuffer.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define WAV_WRITER_QUEUE_BYTES (1 << 22)        // ~12 seconds of stereo float samples at 44100 Hz
+#define WAV_WRITER_FILE_BUFFER_BYTES (1 << 18)  // Data is written to disk this much at a time
+#define WAV_WRITER_POLL_MS 50                   // How often the writer thread empties the queue
+
+// Records 32 bit float samples to a .wav file without blocking the thread that makes them.
+// write() only copies samples into a lock-free queue, the writer thread empties the queue
+// into a large buffer and does the file I/O. Samples that don't fit in the queue are dropped
+class WavWriter
+{
+public:
+    WavWriter();
+    virtual ~WavWriter();
+
+    bool open(const std::filesystem::path & path, const uint32_t & sample_rate, const uint16_t & num_channels);
+    // Writes everything queued, finishes the header and closes the file
+    void close();
+    bool isOpen() const;
+
+    // 'num_values' is samples * channels, interleaved
+    void write(const float * samples, const size_t & num_values);
+
+    AudioRingBufferStats getQueueStats() const;
+    bool hasFailed() const;
+
+private:
+    void writerThreadLoop();
+    void writeQueuedSamples();
+    void flushFileBuffer();
+    void writeHeader();
+
+    std::ofstream file;
+    std::unique_ptr<AudioRingBuffer> queue;
+    std::vector<uint8_t> file_buffer;
+    std::thread writer_thread;
+    std::mutex writer_mutex;
+    std::condition_variable writer_cv;
+    uint64_t data_bytes;            // Sample bytes written to the file so far
+    uint32_t sample_rate;
+    uint16_t num_channels;
+    bool stop_writer_thread;
+    std::atomic_bool failed;
+};
+
+#endif // WAV_WRITER_H
@@ -0,0 +1,161 @@
+#ifdef _WIN32
+#include "stdafx.h"
+#endif // _WIN32
+
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+namespace
+{
+    // Which pool and queue the current thread works for, so tasks can queue more tasks locally
+    thread_local const WorkStealingPool * worker_pool = nullptr;
+    thread_local size_t worker_index = 0;
+}
+
+WorkStealingPool::WorkStealingPool(const size_t & num_threads)
+    : queued_tasks(0)
+    , unfinished_tasks(0)
+    , stopping(false)
+    , next_queue(0)
+    , steals(0)
+{
+    size_t threads = num_threads;
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (size_t i = 0; i < threads; i++)
+    {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    // Every queue exists before any worker can look for one to steal from
+    for (size_t i = 0; i < threads; i++)
+    {
+        workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lg(state_mutex);
+        stopping = true;
+    }
+    task_available.notify_all();
+
+    for (std::thread & worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void WorkStealingPool::submit(std::function<void()> task)
+{
+    const size_t index = (worker_pool == this) ?
+        worker_index :
+        next_queue++ % queues.size();
+
+    {   // Counted first, a worker can't take it before it's counted
+        std::lock_guard<std::mutex> lg(state_mutex);
+        queued_tasks++;
+        unfinished_tasks++;
+    }
+
+    {
+        std::lock_guard<std::mutex> lg(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    task_available.notify_one();
+}
+
+void WorkStealingPool::wait()
+{
+    std::unique_lock<std::mutex> lock(state_mutex);
+    all_done.wait(lock, [this]()
+    {
+        return unfinished_tasks == 0;
+    });
+}
+
+size_t WorkStealingPool::getNumThreads() const
+{
+    return workers.size();
+}
+
+uint64_t WorkStealingPool::getNumSteals() const
+{
+    return steals;
+}
+
+void WorkStealingPool::workerLoop(const size_t & index)
+{
+    worker_pool = this;
+    worker_index = index;
+
+    std::function<void()> task;
+    while (true)
+    {
+        if (takeTask(index, task))
+        {
+            {
+                std::lock_guard<std::mutex> lg(state_mutex);
+                queued_tasks--;
+            }
+
+            task();
+            task = nullptr;
+
+            std::lock_guard<std::mutex> lg(state_mutex);
+            if (--unfinished_tasks == 0)
+            {
+                all_done.notify_all();
+            }
+            continue;
+        }
+
+        // Nothing to take, sleep until something's submitted
+        std::unique_lock<std::mutex> lock(state_mutex);
+        task_available.wait(lock, [this]()
+        {
+            return stopping || queued_tasks > 0;
+        });
+
+        if (stopping && queued_tasks == 0)
+        {
+            return;
+        }
+    }
+}
+
+// Oldest task from this worker's own queue, otherwise the newest from someone else's,
+// so the owner and a thief work at opposite ends
+bool WorkStealingPool::takeTask(const size_t & index, std::function<void()> & task)
+{
+    {
+        WorkerQueue & own = *queues[index];
+        std::lock_guard<std::mutex> lg(own.mutex);
+        if (!own.tasks.empty())
+        {
+            task = std::move(own.tasks.front());
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < queues.size(); i++)
+    {
+        WorkerQueue & victim = *queues[(index + i) % queues.size()];
+        std::lock_guard<std::mutex> lg(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.back());
+            victim.tasks.pop_back();
+            steals++;
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,57 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Thread pool where every worker has its own queue of tasks.
+// Workers run their own tasks in the order submitted and steal from the back
+// of another worker's queue when they run out, so a worker stuck on a long
+// task doesn't leave the tasks queued behind it waiting while others are idle.
+// Tasks submitted from a worker go on that worker's queue
+class WorkStealingPool
+{
+public:
+    // 0 threads is one per hardware thread
+    WorkStealingPool(const size_t & num_threads = 0);
+    virtual ~WorkStealingPool();
+
+    void submit(std::function<void()> task);
+    // Blocks until every task submitted so far has finished
+    void wait();
+
+    size_t getNumThreads() const;
+    uint64_t getNumSteals() const;
+
+private:
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(const size_t & index);
+    bool takeTask(const size_t & index, std::function<void()> & task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex state_mutex;
+    std::condition_variable task_available;
+    std::condition_variable all_done;
+    size_t queued_tasks;        // Submitted, not taken by a worker yet
+    size_t unfinished_tasks;    // Submitted, not finished yet
+    bool stopping;
+
+    std::atomic<size_t> next_queue;
+    std::atomic<uint64_t> steals;
+};
+
+#endif // WORK_STEALING_POOL_H
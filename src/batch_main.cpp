@@ -0,0 +1,156 @@
+#include <BatchRunner.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+    void printUsage()
+    {
+        std::cerr <<
+            "Usage: gbc-batch <rom directory | manifest> [options]\n"
+            "  --frames <n>       Frames to run each ROM without a frame count of its own (default " << BATCH_DEFAULT_FRAMES << ")\n"
+            "  --movie <file>     Input movie for ROMs without one of their own\n"
+            "  --outputs <list>   Comma separated: hash, png, serial, ram (default hash)\n"
+            "  --out-dir <dir>    Where logs, PNGs and RAM dumps go (default .)\n"
+            "  --report <file>    Report file, CSV if it ends in .csv, otherwise JSON (default report.json)\n"
+            "  --threads <n>      Worker threads (default one per hardware thread)\n"
+            "Manifest lines are '<rom>[\\t<frames>[\\t<movie>]]'.\n"
+            "Movie lines are '<frames> <buttons>', buttons joined by '+' or '-' for none, e.g. '30 A+RIGHT'.\n";
+    }
+
+    bool parseOutputs(const std::string & list, BatchOutputs & outputs)
+    {
+        outputs = {};
+
+        std::istringstream list_stream(list);
+        std::string name;
+        while (std::getline(list_stream, name, ','))
+        {
+            if      (name == "hash")    outputs.frame_hash = true;
+            else if (name == "png")     outputs.png = true;
+            else if (name == "serial")  outputs.serial = true;
+            else if (name == "ram")     outputs.ram = true;
+            else return false;
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        printUsage();
+        return 2;
+    }
+
+    const std::filesystem::path input = argv[1];
+    uint32_t frames = BATCH_DEFAULT_FRAMES;
+    std::filesystem::path movie_path;
+    BatchOutputs outputs = {};
+    outputs.frame_hash = true;
+    std::filesystem::path output_dir = ".";
+    std::filesystem::path report_path = "report.json";
+    size_t num_threads = 0;
+
+    for (int i = 2; i < argc; i++)
+    {
+        const bool has_value = (i + 1 < argc);
+        if (!strcmp(argv[i], "--frames") && has_value)
+        {
+            frames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (!strcmp(argv[i], "--movie") && has_value)
+        {
+            movie_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--outputs") && has_value)
+        {
+            if (!parseOutputs(argv[++i], outputs))
+            {
+                std::cerr << "Unknown output in '" << argv[i] << "'\n";
+                return 2;
+            }
+        }
+        else if (!strcmp(argv[i], "--out-dir") && has_value)
+        {
+            output_dir = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--report") && has_value)
+        {
+            report_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--threads") && has_value)
+        {
+            num_threads = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else
+        {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (frames == 0)
+    {
+        std::cerr << "Frame count has to be at least 1\n";
+        return 2;
+    }
+
+    std::vector<BatchJob> jobs;
+    if (std::filesystem::is_directory(input))
+    {
+        jobs = BatchRunner::findJobs(input, frames);
+    }
+    else
+    {
+        std::string error;
+        if (!BatchRunner::readManifest(input, frames, jobs, error))
+        {
+            std::cerr << error << "\n";
+            return 2;
+        }
+    }
+
+    for (BatchJob & job : jobs)
+    {
+        if (job.movie_path.empty())
+        {
+            job.movie_path = movie_path;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(output_dir, ec);
+
+    BatchRunner runner(outputs, output_dir, num_threads);
+    std::cout << "Running " << jobs.size() << " ROMs on " << runner.getNumThreads() << " threads\n";
+
+    const std::vector<BatchResult> results = runner.run(jobs);
+
+    size_t failed = 0;
+    for (const BatchResult & result : results)
+    {
+        if (!result.ok)
+        {
+            failed++;
+            std::cerr << result.rom_path.string() << ": " << result.error << "\n";
+        }
+    }
+
+    const bool csv = (report_path.extension() == ".csv");
+    const bool written = csv ?
+        BatchRunner::writeCSVReport(report_path, results) :
+        BatchRunner::writeJSONReport(report_path, results);
+    if (!written)
+    {
+        std::cerr << "Could not write report " << report_path.string() << "\n";
+        return 1;
+    }
+
+    std::cout << (results.size() - failed) << " ran, " << failed << " failed, report in " << report_path.string() << "\n";
+    return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+#include <BatchInterpreter.h>
+#include <GBCEnvBatch.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+
+#define BENCH_DEFAULT_INSTANCES 64
+#define BENCH_DEFAULT_FRAMES    60
+
+namespace
+{
+    void printUsage()
+    {
+        std::cerr <<
+            "Usage: gbc-bench <rom> [options]\n"
+            "  --instances <n>    Emulators of the ROM run at once (default " << BENCH_DEFAULT_INSTANCES << ")\n"
+            "  --frames <n>       Frames each emulator runs (default " << BENCH_DEFAULT_FRAMES << ")\n"
+            "  --threads <n>      Worker threads for the thread pool (default one per hardware thread)\n"
+            "Compares frames per second across all emulators for running them one after another,\n"
+            "across a thread pool, and in lockstep on the batch interpreter.\n";
+    }
+
+    // Only the running is timed, not making the emulators
+    double timeMs(const std::function<void()> & run)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        run();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void printResult(const std::string & name, const size_t & instances, const uint32_t & frames, const double & ms)
+    {
+        const double fps = (ms > 0) ? (instances * frames) / (ms / 1000.0) : 0;
+        std::cout << std::left << std::setw(20) << name
+            << std::right << std::setw(12) << std::fixed << std::setprecision(1) << fps << " frames/s"
+            << std::setw(12) << ms << " ms\n";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        printUsage();
+        return 2;
+    }
+
+    const std::string rom_path = argv[1];
+    size_t instances = BENCH_DEFAULT_INSTANCES;
+    uint32_t frames = BENCH_DEFAULT_FRAMES;
+    size_t num_threads = 0;
+
+    for (int i = 2; i < argc; i++)
+    {
+        const bool has_value = (i + 1 < argc);
+        if (!strcmp(argv[i], "--instances") && has_value)
+        {
+            instances = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--frames") && has_value)
+        {
+            frames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (!strcmp(argv[i], "--threads") && has_value)
+        {
+            num_threads = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else
+        {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (instances == 0 || frames == 0)
+    {
+        std::cerr << "Instance and frame counts have to be at least 1\n";
+        return 2;
+    }
+
+    try
+    {
+        std::cout << instances << " x " << rom_path << ", " << frames << " frames each\n";
+
+        {   // One after another on this thread
+            std::vector<std::unique_ptr<GBCEmulator>> emulators;
+            for (size_t i = 0; i < instances; i++)
+            {
+                emulators.push_back(std::make_unique<GBCEmulator>(rom_path,
+                    rom_path + ".bench" + std::to_string(i) + ".log", "", false, false, false));
+                emulators.back()->runWithoutSleep = true;
+                emulators.back()->get_APU()->setSilentMode(true);
+            }
+
+            printResult("scalar", instances, frames, timeMs([&]()
+            {
+                for (std::unique_ptr<GBCEmulator> & emulator : emulators)
+                {
+                    for (uint32_t frame = 0; frame < frames; frame++)
+                    {
+                        emulator->runFrame();
+                    }
+                }
+            }));
+        }
+
+        {
+            GBCEnvBatch envs(rom_path, instances, num_threads);
+            printResult("thread pool x" + std::to_string(envs.getNumThreads()), instances, frames, timeMs([&]()
+            {
+                envs.step(nullptr, frames, nullptr, nullptr);
+            }));
+        }
+
+        {
+            BatchInterpreter batch(rom_path, instances);
+            printResult("batch interpreter", instances, frames, timeMs([&]()
+            {
+                batch.runFrames(frames);
+            }));
+
+            const uint64_t total = batch.getNumGrouped() + batch.getNumScalar();
+            std::cout << "  " << std::setprecision(1) << (total ? 100.0 * batch.getNumGrouped() / total : 0)
+                << "% of instructions ran in groups\n";
+        }
+    }
+    catch (const std::exception & e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
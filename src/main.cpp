@@ -11,18 +11,27 @@ int main(int argc, char **argv)
 {
     SDLWindow window;
     bool start_emu = false;
+    std::string romName;
 
-    if (argc > 1)
+    for (int i = 1; i < argc; i++)
     {
-        std::string romName = argv[1];
-        if (SDLWindow::romIsValid(romName))
+        if (std::string(argv[i]) == "--pipelined-audio")
+        {   // Synthesize audio on its own thread, for machines with a core to spare
+            window.setPipelinedSynthesis(true);
+        }
+        else
         {
-            std::shared_ptr<GBCEmulator> emu = std::make_shared<GBCEmulator>(romName, romName + ".log");
-            window.hookToEmulator(emu);
-            start_emu = true;
+            romName = argv[i];
         }
     }
 
+    if (!romName.empty() && SDLWindow::romIsValid(romName))
+    {
+        std::shared_ptr<GBCEmulator> emu = std::make_shared<GBCEmulator>(romName, romName + ".log");
+        window.hookToEmulator(emu);
+        start_emu = true;
+    }
+
     window.run(start_emu);
 
     return 0;
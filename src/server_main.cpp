@@ -0,0 +1,99 @@
+#include <GBCServer.h>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+
+#define SERVER_DEFAULT_SOCKET "gbc-server.sock"
+#define SERVER_DEFAULT_SHM_NAME "/gbc-server"
+
+namespace
+{
+    GBCServer * running_server = nullptr;
+
+    void printUsage()
+    {
+        std::cerr <<
+            "Usage: gbc-server <rom> [options]\n"
+            "  --socket <path>    Unix domain socket requests come in on (default " SERVER_DEFAULT_SOCKET ")\n"
+            "  --shm <name>       Shared memory name, rings are <name>-frames, -audio and -ram (default " SERVER_DEFAULT_SHM_NAME ")\n"
+            "  --bios <path>      Boot ROM to start from\n"
+            "  --boot-cache <dir> Keeps the state the boot ROM hands over in, so later starts skip it\n"
+            "Requests, one per line: step <frames> [buttons], input <buttons>, ram, snapshot <name>,\n"
+            "restore <name>, reset, ping, quit. Buttons are a joypad state, a cleared bit is a held button.\n";
+    }
+
+    void stopServer(int)
+    {
+        if (running_server)
+        {
+            running_server->stop();
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        printUsage();
+        return 2;
+    }
+
+    const std::string rom_path = argv[1];
+    std::string socket_path = SERVER_DEFAULT_SOCKET;
+    std::string shm_name = SERVER_DEFAULT_SHM_NAME;
+    std::string bios_path;
+
+    for (int i = 2; i < argc; i++)
+    {
+        const bool has_value = (i + 1 < argc);
+        if (!strcmp(argv[i], "--socket") && has_value)
+        {
+            socket_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--shm") && has_value)
+        {
+            shm_name = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--bios") && has_value)
+        {
+            bios_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--boot-cache") && has_value)
+        {
+            BootStateCache::getDefault()->setDirectory(argv[++i]);
+        }
+        else
+        {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (shm_name.empty() || shm_name[0] != '/')
+    {
+        std::cerr << "Shared memory names start with '/'\n";
+        return 2;
+    }
+
+    try
+    {
+        GBCServer server(rom_path, socket_path, shm_name, bios_path);
+
+        running_server = &server;
+        std::signal(SIGINT, stopServer);
+        std::signal(SIGTERM, stopServer);
+
+        std::cout << "Serving " << rom_path << " on " << socket_path << "\n";
+        server.run();
+
+        running_server = nullptr;
+    }
+    catch (const std::exception & e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
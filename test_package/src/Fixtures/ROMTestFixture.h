@@ -2,7 +2,7 @@
 #define TEST_PACKAGE_SRC_ROM_TEST_FIXTURE_H
 
 #include <gtest/gtest.h>
-#include <SDL.h>
+#include <SDLTypes.h>
 #include <UnitTests.h>
 #include <filesystem>
 #include <atomic>
@@ -23,7 +23,7 @@ protected:
     void SetUp(T _unit_test)
     {
         init();
-        unit_test = getUnitTest(_unit_test);
+        unit_test = ::getUnitTest(_unit_test);
         test();
     }
     virtual void TearDown()
@@ -53,27 +53,28 @@ protected:
 
     void init();
     void test();
+    void testSaveState();
+    void testRewind();
+    void testRunAhead();
     void frameUpdatedFunction(std::array<SDL_Color, SCREEN_PIXEL_TOTAL> /* frame */);
-    ROMUnitTest getUnitTest(blargg::cgb_sound test) const;
-    ROMUnitTest getUnitTest(blargg::cpu_instrs test) const;
-    ROMUnitTest getUnitTest(blargg::dmg_sound test) const;
-    ROMUnitTest getUnitTest(blargg::instr_timing test) const;
-    ROMUnitTest getUnitTest(blargg::interrupt_time test) const;
-    ROMUnitTest getUnitTest(blargg::mem_timing test) const;
-    ROMUnitTest getUnitTest(blargg::mem_timing_2 test) const;
-    ROMUnitTest getUnitTest(blargg::oam_bug test) const;
-    ROMUnitTest getUnitTest(blargg::halt_bug test) const;
 
 private:
     void setEmuLogLevels(const TestType& test_type);
     void tryRemoveFile(const std::filesystem::path& file);
-    std::filesystem::path getExecutablePath();
 
     std::unique_ptr<GBCEmulator> emu;
-    std::filesystem::path rom_root;
     ROMUnitTest unit_test;
     uint64_t curr_hash;
     std::atomic_bool hash_passed;
+
+protected:
+    bool use_force_cgb = false;
+    bool use_pipelined_rendering = false;
+    bool use_silent_apu = false;
+    bool use_pipelined_apu = false;
+    bool use_save_state = false;
+    bool use_rewind = false;
+    bool use_run_ahead = false;
 };
 
 #endif // TEST_PACKAGE_SRC_ROM_TEST_FIXTURE_H
\ No newline at end of file
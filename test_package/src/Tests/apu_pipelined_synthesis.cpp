@@ -0,0 +1,27 @@
+#include <Fixtures/ROMTestFixture.h>
+#include <gtest/gtest.h>
+#include <UnitTests.h>
+
+TEST_F(ROMTestFixture, pipelined_apu_dmg_sounds_01_registers)
+{
+    use_pipelined_apu = true;
+    SetUp(blargg::dmg_sound::_01_registers);
+}
+
+TEST_F(ROMTestFixture, pipelined_apu_dmg_sounds_02_len_ctr)
+{
+    use_pipelined_apu = true;
+    SetUp(blargg::dmg_sound::_02_len_ctr);
+}
+
+TEST_F(ROMTestFixture, pipelined_apu_dmg_sounds_11_regs_after_power)
+{
+    use_pipelined_apu = true;
+    SetUp(blargg::dmg_sound::_11_regs_after_power);
+}
+
+TEST_F(ROMTestFixture, pipelined_apu_cgb_sounds_10_wave_trigger_while_on)
+{
+    use_pipelined_apu = true;
+    SetUp(blargg::cgb_sound::_10_wave_trigger_while_on);
+}
@@ -0,0 +1,39 @@
+#include <Fixtures/ROMTestFixture.h>
+#include <gtest/gtest.h>
+#include <UnitTests.h>
+
+TEST_F(ROMTestFixture, silent_apu_dmg_sounds_01_registers)
+{
+    use_silent_apu = true;
+    SetUp(blargg::dmg_sound::_01_registers);
+}
+
+TEST_F(ROMTestFixture, silent_apu_dmg_sounds_02_len_ctr)
+{
+    use_silent_apu = true;
+    SetUp(blargg::dmg_sound::_02_len_ctr);
+}
+
+TEST_F(ROMTestFixture, silent_apu_dmg_sounds_06_overflow_on_trigger)
+{
+    use_silent_apu = true;
+    SetUp(blargg::dmg_sound::_06_overflow_on_trigger);
+}
+
+TEST_F(ROMTestFixture, silent_apu_dmg_sounds_07_len_sweep_period_sync)
+{
+    use_silent_apu = true;
+    SetUp(blargg::dmg_sound::_07_len_sweep_period_sync);
+}
+
+TEST_F(ROMTestFixture, silent_apu_dmg_sounds_11_regs_after_power)
+{
+    use_silent_apu = true;
+    SetUp(blargg::dmg_sound::_11_regs_after_power);
+}
+
+TEST_F(ROMTestFixture, silent_apu_cgb_sounds_10_wave_trigger_while_on)
+{
+    use_silent_apu = true;
+    SetUp(blargg::cgb_sound::_10_wave_trigger_while_on);
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <AudioMixer.h>
+#include <array>
+#include <cmath>
+#include <vector>
+
+#define MIXER_TEST_SAMPLES 1027     // Not a multiple of 4, so the end is mixed a sample at a time
+
+namespace
+{
+    // Loud enough together to need clamping now and then
+    std::array<std::vector<float>, AUDIO_MIXER_NUM_CHANNELS> getChannels()
+    {
+        std::array<std::vector<float>, AUDIO_MIXER_NUM_CHANNELS> channels;
+        for (size_t c = 0; c < AUDIO_MIXER_NUM_CHANNELS; c++)
+        {
+            channels[c].resize(MIXER_TEST_SAMPLES);
+            for (size_t i = 0; i < MIXER_TEST_SAMPLES; i++)
+            {
+                channels[c][i] = static_cast<float>(std::sin(i * (0.013 + c * 0.007)) * (0.5 + c * 0.1));
+            }
+        }
+        return channels;
+    }
+}
+
+// Mixing the whole buffer at once, 4 samples at a time with SSE2, matches mixing it one sample
+// at a time, which always takes the scalar path
+TEST(AudioMixer, VectorMatchesScalar)
+{
+    const std::array<std::vector<float>, AUDIO_MIXER_NUM_CHANNELS> channels = getChannels();
+    const std::array<float, AUDIO_MIXER_NUM_CHANNELS> left_gains = { 1.0f, 0.0f, 0.75f, 0.5f };
+    const std::array<float, AUDIO_MIXER_NUM_CHANNELS> right_gains = { 0.25f, 1.0f, 0.75f, 0.0f };
+
+    std::vector<float> whole(MIXER_TEST_SAMPLES * 2), single(MIXER_TEST_SAMPLES * 2);
+    AudioMixer::mix({ channels[0].data(), channels[1].data(), channels[2].data(), channels[3].data() },
+        left_gains, right_gains, whole.data(), MIXER_TEST_SAMPLES);
+    for (size_t i = 0; i < MIXER_TEST_SAMPLES; i++)
+    {
+        AudioMixer::mix({ &channels[0][i], &channels[1][i], &channels[2][i], &channels[3][i] },
+            left_gains, right_gains, &single[i * 2], 1);
+    }
+
+    size_t num_clamped = 0;
+    for (size_t i = 0; i < whole.size(); i++)
+    {
+        ASSERT_EQ(single[i], whole[i]) << "Value " << i;
+        ASSERT_LE(std::fabs(whole[i]), 1.0f) << "Value " << i;
+        num_clamped += (std::fabs(whole[i]) == 1.0f);
+    }
+    EXPECT_GT(num_clamped, 0u);
+
+    // Left and right interleaved
+    float expected_left = 0.0f, expected_right = 0.0f;
+    for (size_t c = 0; c < AUDIO_MIXER_NUM_CHANNELS; c++)
+    {
+        expected_left += channels[c][1] * left_gains[c];
+        expected_right += channels[c][1] * right_gains[c];
+    }
+    EXPECT_FLOAT_EQ(expected_left, whole[2]);
+    EXPECT_FLOAT_EQ(expected_right, whole[3]);
+}
+
+TEST(AudioMixer, ConvertToS16)
+{
+    std::vector<float> in(MIXER_TEST_SAMPLES);
+    for (size_t i = 0; i < in.size(); i++)
+    {
+        in[i] = static_cast<float>(std::sin(i * 0.021) * 1.25);
+    }
+    in[0] = 1.0f;
+    in[1] = -1.0f;
+    in[2] = 0.0f;
+
+    std::vector<int16_t> whole(in.size()), single(in.size());
+    AudioMixer::convertToS16(in.data(), whole.data(), in.size());
+    for (size_t i = 0; i < in.size(); i++)
+    {
+        AudioMixer::convertToS16(&in[i], &single[i], 1);
+    }
+
+    EXPECT_EQ(32767, whole[0]);
+    EXPECT_EQ(-32767, whole[1]);
+    EXPECT_EQ(0, whole[2]);
+    for (size_t i = 0; i < in.size(); i++)
+    {
+        ASSERT_EQ(single[i], whole[i]) << "Value " << i;
+    }
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <AudioRingBuffer.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#define RING_TEST_CAPACITY 64
+#define RING_TEST_SILENCE 0x80
+#define RING_TEST_STREAM_BYTES (1 << 16)
+
+namespace
+{
+    std::vector<uint8_t> getBytes(const size_t & start, const size_t & count)
+    {
+        std::vector<uint8_t> bytes(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            bytes[i] = static_cast<uint8_t>((start + i) * 7);
+        }
+        return bytes;
+    }
+}
+
+TEST(AudioRingBuffer, RoundsUpCapacity)
+{
+    AudioRingBuffer ring(RING_TEST_CAPACITY - 10);
+    EXPECT_EQ(static_cast<size_t>(RING_TEST_CAPACITY), ring.getCapacity());
+    EXPECT_EQ(0u, ring.getBufferedBytes());
+}
+
+// Writes and reads that run over the end of the buffer carry on from the start
+TEST(AudioRingBuffer, WrapsAround)
+{
+    AudioRingBuffer ring(RING_TEST_CAPACITY);
+    size_t written = 0, read = 0;
+    std::vector<uint8_t> out;
+
+    // Sizes that don't divide the capacity, so every position gets wrapped over
+    for (const size_t & size : { 40, 40, 13, 50, 64, 1, 63, 27 })
+    {
+        const std::vector<uint8_t> bytes = getBytes(written, size);
+        ASSERT_EQ(size, ring.write(bytes.data(), bytes.size()));
+        written += size;
+        EXPECT_EQ(size, ring.getBufferedBytes());
+
+        out.assign(size, 0);
+        ASSERT_EQ(size, ring.read(out.data(), out.size(), RING_TEST_SILENCE));
+        EXPECT_EQ(getBytes(read, size), out);
+        read += size;
+    }
+
+    const AudioRingBufferStats stats = ring.getStats();
+    EXPECT_EQ(0u, stats.overruns);
+    EXPECT_EQ(0u, stats.underruns);
+    EXPECT_EQ(0u, stats.buffered_bytes);
+}
+
+// A full buffer drops what doesn't fit, an empty one reads out silence
+TEST(AudioRingBuffer, OverrunAndUnderrun)
+{
+    AudioRingBuffer ring(RING_TEST_CAPACITY);
+    const std::vector<uint8_t> first = getBytes(0, 20);
+    ASSERT_EQ(first.size(), ring.write(first.data(), first.size()));
+
+    const std::vector<uint8_t> too_many = getBytes(first.size(), RING_TEST_CAPACITY);
+    EXPECT_EQ(RING_TEST_CAPACITY - first.size(), ring.write(too_many.data(), too_many.size()));
+    EXPECT_EQ(0u, ring.write(too_many.data(), 1));
+    EXPECT_EQ(2u, ring.getStats().overruns);
+    EXPECT_EQ(static_cast<size_t>(RING_TEST_CAPACITY), ring.getBufferedBytes());
+
+    // Everything that fit comes out in order, then silence
+    std::vector<uint8_t> out(RING_TEST_CAPACITY + 8);
+    EXPECT_EQ(static_cast<size_t>(RING_TEST_CAPACITY), ring.read(out.data(), out.size(), RING_TEST_SILENCE));
+    EXPECT_EQ(getBytes(0, RING_TEST_CAPACITY), std::vector<uint8_t>(out.begin(), out.begin() + RING_TEST_CAPACITY));
+    EXPECT_EQ(std::vector<uint8_t>(8, RING_TEST_SILENCE), std::vector<uint8_t>(out.begin() + RING_TEST_CAPACITY, out.end()));
+    EXPECT_EQ(1u, ring.getStats().underruns);
+
+    EXPECT_EQ(0u, ring.read(out.data(), 1, RING_TEST_SILENCE));
+    EXPECT_EQ(RING_TEST_SILENCE, out[0]);
+    EXPECT_EQ(2u, ring.getStats().underruns);
+
+    // Clearing skips what's buffered
+    ring.write(first.data(), first.size());
+    ring.clear();
+    EXPECT_EQ(0u, ring.getBufferedBytes());
+}
+
+// A producer and consumer on their own threads, every byte arrives once and in order
+TEST(AudioRingBuffer, ProducerAndConsumerThreads)
+{
+    AudioRingBuffer ring(RING_TEST_CAPACITY);
+    std::thread producer([&ring]()
+    {
+        size_t written = 0;
+        while (written < RING_TEST_STREAM_BYTES)
+        {
+            const std::vector<uint8_t> bytes = getBytes(written, std::min<size_t>(37, RING_TEST_STREAM_BYTES - written));
+            const size_t num_written = ring.write(bytes.data(), bytes.size());
+            if (num_written < bytes.size())
+            {   // Full, let the consumer catch up
+                std::this_thread::yield();
+            }
+            written += num_written;
+        }
+    });
+
+    std::vector<uint8_t> stream;
+    std::vector<uint8_t> out(29);
+    while (stream.size() < RING_TEST_STREAM_BYTES)
+    {
+        const size_t num_read = ring.read(out.data(), std::min(out.size(), RING_TEST_STREAM_BYTES - stream.size()), RING_TEST_SILENCE);
+        stream.insert(stream.end(), out.begin(), out.begin() + num_read);
+        if (num_read < out.size())
+        {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    EXPECT_EQ(getBytes(0, RING_TEST_STREAM_BYTES), stream);
+    EXPECT_EQ(0u, ring.getBufferedBytes());
+}
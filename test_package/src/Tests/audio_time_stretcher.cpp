@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <AudioTimeStretcher.h>
+#include <cmath>
+#include <vector>
+
+#define STRETCH_TEST_SAMPLE_RATE 44100
+#define STRETCH_TEST_FRAME_SAMPLES 735     // A frame's worth at 60 Hz
+#define STRETCH_TEST_FRAMES 180
+#define STRETCH_TEST_TONE_HZ 440.0
+#define STRETCH_TEST_PI 3.14159265358979323846
+
+namespace
+{
+    // Stereo tone fed in a frame at a time. Returns the number of stereo samples put in
+    size_t stretchTone(AudioTimeStretcher & stretcher, std::vector<float> & out)
+    {
+        std::vector<float> in(STRETCH_TEST_FRAME_SAMPLES * 2);
+        size_t num_samples = 0;
+        for (int frame = 0; frame < STRETCH_TEST_FRAMES; frame++)
+        {
+            for (size_t i = 0; i < STRETCH_TEST_FRAME_SAMPLES; i++, num_samples++)
+            {
+                const float value = static_cast<float>(0.5 * std::sin(2.0 * STRETCH_TEST_PI * STRETCH_TEST_TONE_HZ * num_samples / STRETCH_TEST_SAMPLE_RATE));
+                in[(i * 2)] = value;
+                in[(i * 2) + 1] = value;
+            }
+            stretcher.process(in.data(), STRETCH_TEST_FRAME_SAMPLES, out);
+        }
+        return num_samples;
+    }
+}
+
+// Output is the input's length divided by the speed, less what's held back waiting for more input
+TEST(AudioTimeStretcher, OutputLength)
+{
+    const size_t sequence_samples = (STRETCH_TEST_SAMPLE_RATE * TIME_STRETCH_SEQUENCE_MS) / 1000;
+    const size_t overlap_samples = (STRETCH_TEST_SAMPLE_RATE * TIME_STRETCH_OVERLAP_MS) / 1000;
+    const size_t seek_samples = (STRETCH_TEST_SAMPLE_RATE * TIME_STRETCH_SEEK_MS) / 1000;
+
+    for (const double & speed : { 0.5, 1.0, 1.5, 2.0 })
+    {
+        SCOPED_TRACE(speed);
+        AudioTimeStretcher stretcher(STRETCH_TEST_SAMPLE_RATE);
+        stretcher.setSpeed(speed);
+
+        std::vector<float> out;
+        const size_t num_in = stretchTone(stretcher, out);
+        ASSERT_EQ(0u, out.size() % 2);
+        const size_t num_out = out.size() / 2;
+
+        // Written out a piece at a time
+        EXPECT_EQ(0u, num_out % (sequence_samples - overlap_samples));
+
+        // The last piece can run past the end of the input it stands for
+        const double expected = num_in / speed;
+        const double held_back = (sequence_samples + seek_samples) / speed + sequence_samples;
+        EXPECT_LE(num_out, expected + (sequence_samples - overlap_samples));
+        EXPECT_GE(num_out, expected - held_back);
+    }
+}
+
+// Changing the length doesn't change the pitch
+TEST(AudioTimeStretcher, KeepsPitch)
+{
+    for (const double & speed : { 0.5, 2.0 })
+    {
+        SCOPED_TRACE(speed);
+        AudioTimeStretcher stretcher(STRETCH_TEST_SAMPLE_RATE);
+        stretcher.setSpeed(speed);
+
+        std::vector<float> out;
+        stretchTone(stretcher, out);
+
+        // Skip the fade in from silence
+        const size_t start = STRETCH_TEST_SAMPLE_RATE / 10;
+        const size_t num_out = out.size() / 2;
+        ASSERT_GT(num_out, start * 2);
+
+        size_t crossings = 0;
+        for (size_t i = start; i + 1 < num_out; i++)
+        {
+            crossings += ((out[i * 2] < 0.0f) != (out[(i + 1) * 2] < 0.0f));
+        }
+        const double seconds = static_cast<double>(num_out - start) / STRETCH_TEST_SAMPLE_RATE;
+        EXPECT_NEAR(STRETCH_TEST_TONE_HZ, crossings / 2.0 / seconds, STRETCH_TEST_TONE_HZ * 0.02);
+    }
+}
+
+// Clearing starts again from nothing, as if it was just made
+TEST(AudioTimeStretcher, Clear)
+{
+    AudioTimeStretcher stretcher(STRETCH_TEST_SAMPLE_RATE);
+    stretcher.setSpeed(1.5);
+    std::vector<float> first, second;
+    stretchTone(stretcher, first);
+    stretcher.clear();
+    stretchTone(stretcher, second);
+    EXPECT_EQ(first, second);
+}
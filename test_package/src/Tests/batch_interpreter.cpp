@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include <UnitTests.h>
+#include <GBCEmulator.h>
+#include <BatchInterpreter.h>
+#include <GBCEnvBatch.h>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define BATCH_INTERPRETER_TEST_LANES 4
+#define BATCH_INTERPRETER_TEST_FRAMES 30
+#define BATCH_INTERPRETER_TEST_OFFSET 1000  // Instructions lane i runs ahead by, times i
+
+// Lanes run in lockstep have to end up exactly where emulators running on their own do
+TEST(BatchInterpreter, MatchesEmulators)
+{
+    for (const ROMUnitTest & rom : { getUnitTest(blargg::cpu_instrs::_06_ld_r_r), getUnitTest(blargg::cpu_instrs::_09_op_r_r) })
+    {
+        SCOPED_TRACE(rom.rom_path.string());
+        const std::string rom_path = rom.rom_path.string();
+        BatchInterpreter batch(rom_path, BATCH_INTERPRETER_TEST_LANES);
+        ASSERT_EQ(BATCH_INTERPRETER_TEST_LANES, batch.getNumLanes());
+
+        // Lanes a little apart, so some run the same opcodes and some don't
+        std::vector<std::unique_ptr<GBCEmulator>> scalars;
+        for (size_t i = 0; i < BATCH_INTERPRETER_TEST_LANES; i++)
+        {
+            scalars.push_back(std::make_unique<GBCEmulator>(rom_path, rom_path + ".scalar" + std::to_string(i) + ".log", "", false, false, false, false));
+            scalars[i]->runWithoutSleep = true;
+            scalars[i]->get_APU()->setSilentMode(true);
+
+            for (size_t j = 0; j < i * BATCH_INTERPRETER_TEST_OFFSET; j++)
+            {
+                scalars[i]->runNextInstruction();
+                batch.getLane(i)->runNextInstruction();
+            }
+        }
+
+        batch.runFrames(BATCH_INTERPRETER_TEST_FRAMES);
+        EXPECT_GT(batch.getNumGrouped(), 0u);
+        EXPECT_GT(batch.getNumScalar(), 0u);
+
+        std::vector<uint8_t> lane_state, scalar_state;
+        for (size_t i = 0; i < BATCH_INTERPRETER_TEST_LANES; i++)
+        {
+            for (int frame = 0; frame < BATCH_INTERPRETER_TEST_FRAMES; frame++)
+            {
+                scalars[i]->runFrame();
+            }
+
+            batch.getLane(i)->snapshot(lane_state);
+            scalars[i]->snapshot(scalar_state);
+            EXPECT_TRUE(lane_state == scalar_state) << "Lane " << i;
+            EXPECT_EQ(0, std::memcmp(batch.getLane(i)->getFrameRaw(), scalars[i]->getFrameRaw(), ENV_SCREEN_OBSERVATION_SIZE));
+        }
+    }
+}
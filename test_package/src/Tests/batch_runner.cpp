@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include <UnitTests.h>
+#include <GBCEmulator.h>
+#include <BatchRunner.h>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#define BATCH_TEST_FRAMES 120
+
+// Batch jobs have to end up where the emulator does running the same frames itself
+TEST(BatchRunner, MatchesEmulator)
+{
+    for (const ROMUnitTest & rom : { getUnitTest(blargg::cpu_instrs::_02_interrupts), getUnitTest(blargg::cpu_instrs::_04_op_r_imm) })
+    {
+        SCOPED_TRACE(rom.rom_path.string());
+        BatchOutputs outputs = {};
+        outputs.frame_hash = true;
+        outputs.serial = true;
+        BatchRunner runner(outputs, std::filesystem::temp_directory_path(), 2);
+
+        const BatchJob job = { rom.rom_path, BATCH_TEST_FRAMES, {} };
+        const std::vector<BatchResult> results = runner.run({ job, job });
+        ASSERT_EQ(2, results.size());
+        for (const BatchResult & result : results)
+        {
+            ASSERT_TRUE(result.ok) << result.error;
+            EXPECT_EQ(BATCH_TEST_FRAMES, result.frames_run);
+        }
+
+        const std::string rom_path = rom.rom_path.string();
+        GBCEmulator emu(rom_path, rom_path + ".batch.log", "", false, false, false, false);
+        emu.runWithoutSleep = true;
+        for (int i = 0; i < BATCH_TEST_FRAMES; i++)
+        {
+            emu.runFrame();
+        }
+        EXPECT_EQ(GBCEmulator::calculateFrameHash(emu.getFrame()), results[0].frame_hash);
+        EXPECT_EQ(results[0].frame_hash, results[1].frame_hash);
+
+        // cpu_instrs prints its name over the serial port first thing
+        EXPECT_FALSE(results[0].serial_output.empty());
+        EXPECT_EQ(emu.getSerialOutput(), results[0].serial_output);
+    }
+}
+
+// Jobs never leave a .sav behind, though this cartridge has battery backed RAM
+TEST(BatchRunner, NoSaveFiles)
+{
+    const ROMUnitTest rom = getUnitTest(blargg::dmg_sound::_01_registers);
+    std::filesystem::path sav_path = rom.rom_path;
+    sav_path.replace_extension(".sav");
+    std::filesystem::remove(sav_path);
+
+    BatchOutputs outputs = {};
+    outputs.frame_hash = true;
+    BatchRunner runner(outputs, std::filesystem::temp_directory_path(), 1);
+    const std::vector<BatchResult> results = runner.run({ { rom.rom_path, BATCH_TEST_FRAMES, {} } });
+    ASSERT_EQ(1, results.size());
+    EXPECT_TRUE(results[0].ok) << results[0].error;
+    EXPECT_FALSE(std::filesystem::exists(sav_path));
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <BlipBuffer.h>
+#include <algorithm>
+#include <vector>
+
+#define BLIP_TEST_CLOCK_RATE 4194304
+#define BLIP_TEST_SAMPLE_RATE 44100
+#define BLIP_TEST_MAX_SAMPLES 1024
+#define BLIP_TEST_STEP_SAMPLE 100
+#define BLIP_TEST_STEP 1000
+
+namespace
+{
+    // Output of one step of 'delta', 'sample_fraction' of a sample after BLIP_TEST_STEP_SAMPLE
+    std::vector<float> getStepOutput(const int32_t & delta, const double & sample_fraction)
+    {
+        BlipBuffer blip(BLIP_TEST_MAX_SAMPLES);
+        blip.setRates(BLIP_TEST_CLOCK_RATE, BLIP_TEST_SAMPLE_RATE);
+
+        const double clocks_per_sample = static_cast<double>(BLIP_TEST_CLOCK_RATE) / BLIP_TEST_SAMPLE_RATE;
+        blip.addDelta(blip.clocksNeeded(BLIP_TEST_STEP_SAMPLE) + static_cast<uint32_t>(sample_fraction * clocks_per_sample), delta);
+
+        const size_t num_samples = BLIP_TEST_STEP_SAMPLE + (BLIP_KERNEL_SIZE * 2);
+        blip.endFrame(blip.clocksNeeded(num_samples));
+        EXPECT_GE(blip.samplesAvailable(), num_samples);
+
+        std::vector<float> out(num_samples);
+        EXPECT_EQ(num_samples, blip.readSamples(out.data(), out.size()));
+        return out;
+    }
+}
+
+// A step is spread over the kernel, nothing before it and the full step after it, less the slow high pass
+TEST(BlipBuffer, StepOutput)
+{
+    const std::vector<float> out = getStepOutput(BLIP_TEST_STEP, 0.5);
+
+    for (size_t i = 0; i < BLIP_TEST_STEP_SAMPLE; i++)
+    {
+        ASSERT_EQ(0.0f, out[i]) << "Sample " << i;
+    }
+
+    // Half a sample late the step is centered between the kernel's middle taps, so half way up there
+    const float middle = out[BLIP_TEST_STEP_SAMPLE + (BLIP_KERNEL_SIZE / 2) - 1];
+    EXPECT_GT(middle, BLIP_TEST_STEP * 0.4f);
+    EXPECT_LT(middle, BLIP_TEST_STEP * 0.6f);
+
+    // Settled once the kernel has passed, only the high pass leaks it away
+    const size_t settled = BLIP_TEST_STEP_SAMPLE + BLIP_KERNEL_SIZE;
+    EXPECT_NEAR(BLIP_TEST_STEP, out[settled], BLIP_TEST_STEP * BLIP_KERNEL_SIZE * BLIP_HIGH_PASS);
+    for (size_t i = settled + 1; i < out.size(); i++)
+    {
+        ASSERT_LT(out[i], out[i - 1]) << "Sample " << i;
+    }
+
+    // Windowed sinc rings a little, no more
+    EXPECT_LT(*std::max_element(out.begin(), out.end()), BLIP_TEST_STEP * 1.15f);
+    EXPECT_GT(*std::min_element(out.begin(), out.end()), -BLIP_TEST_STEP * 0.15f);
+}
+
+// Steps between output samples land between them, and deltas add up
+TEST(BlipBuffer, SubSampleSteps)
+{
+    const std::vector<float> early = getStepOutput(BLIP_TEST_STEP, 0.0);
+    const std::vector<float> late = getStepOutput(BLIP_TEST_STEP, 0.5);
+    const size_t middle = BLIP_TEST_STEP_SAMPLE + (BLIP_KERNEL_SIZE / 2) - 1;
+    EXPECT_GT(early[middle], BLIP_TEST_STEP * 0.9f);
+    EXPECT_LT(late[middle], BLIP_TEST_STEP * 0.6f);
+
+    const std::vector<float> negative = getStepOutput(-BLIP_TEST_STEP, 0.0);
+    for (size_t i = 0; i < early.size(); i++)
+    {
+        ASSERT_FLOAT_EQ(-early[i], negative[i]) << "Sample " << i;
+    }
+}
+
+// Samples still being built stay in the buffer across reads
+TEST(BlipBuffer, ReadsInPieces)
+{
+    const std::vector<float> whole = getStepOutput(BLIP_TEST_STEP, 0.25);
+
+    BlipBuffer blip(BLIP_TEST_MAX_SAMPLES);
+    blip.setRates(BLIP_TEST_CLOCK_RATE, BLIP_TEST_SAMPLE_RATE);
+    const double clocks_per_sample = static_cast<double>(BLIP_TEST_CLOCK_RATE) / BLIP_TEST_SAMPLE_RATE;
+    blip.addDelta(blip.clocksNeeded(BLIP_TEST_STEP_SAMPLE) + static_cast<uint32_t>(0.25 * clocks_per_sample), BLIP_TEST_STEP);
+
+    std::vector<float> pieces;
+    std::vector<float> out(BLIP_KERNEL_SIZE / 4);
+    blip.endFrame(blip.clocksNeeded(BLIP_TEST_STEP_SAMPLE + 4));
+    while (pieces.size() < whole.size())
+    {
+        const size_t num_read = blip.readSamples(out.data(), std::min(out.size(), whole.size() - pieces.size()));
+        pieces.insert(pieces.end(), out.begin(), out.begin() + num_read);
+        blip.endFrame(blip.clocksNeeded(out.size()));
+    }
+    ASSERT_EQ(whole.size(), pieces.size());
+    for (size_t i = 0; i < whole.size(); i++)
+    {
+        ASSERT_FLOAT_EQ(whole[i], pieces[i]) << "Sample " << i;
+    }
+}
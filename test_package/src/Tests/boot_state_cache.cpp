@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <UnitTests.h>
+#include <GBCEmulator.h>
+#include <BootStateCache.h>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define BOOT_TEST_MAX_INSTRUCTIONS 100000
+
+// Writes to VRAM, counts down a while, then jumps to the cartridge
+static const std::vector<uint8_t> test_bios = {
+    0x31, 0xFE, 0xFF,   // LD SP, 0xFFFE
+    0x3E, 0x42,         // LD A, 0x42
+    0xEA, 0x00, 0x80,   // LD (0x8000), A
+    0x01, 0x00, 0x10,   // LD BC, 0x1000
+    0x0B,               // DEC BC
+    0x78,               // LD A, B
+    0xB1,               // OR C
+    0x20, 0xFB,         // JR NZ, -5
+    0xC3, 0x00, 0x01,   // JP 0x0100
+};
+
+// Another boot ROM, cartridge header or mode is another state. The rest of bank 0 isn't read by boot ROMs
+TEST(BootStateCache, MakeKey)
+{
+    std::vector<unsigned char> rom_bank_0(0x4000);
+    const uint64_t key = BootStateCache::makeKey(test_bios, rom_bank_0, false);
+    EXPECT_EQ(key, BootStateCache::makeKey(test_bios, rom_bank_0, false));
+    EXPECT_NE(key, BootStateCache::makeKey(test_bios, rom_bank_0, true));
+
+    std::vector<unsigned char> other_bios = test_bios;
+    other_bios[4] = 0x43;
+    EXPECT_NE(key, BootStateCache::makeKey(other_bios, rom_bank_0, false));
+
+    rom_bank_0[BOOT_STATE_HEADER_START - 1] = 0xFF;
+    rom_bank_0[BOOT_STATE_HEADER_END] = 0xFF;
+    EXPECT_EQ(key, BootStateCache::makeKey(test_bios, rom_bank_0, false));
+
+    for (const size_t & pos : { BOOT_STATE_HEADER_START, 0x0134, BOOT_STATE_HEADER_END - 1 })
+    {
+        std::vector<unsigned char> changed = rom_bank_0;
+        changed[pos] ^= 0x01;
+        EXPECT_NE(key, BootStateCache::makeKey(test_bios, changed, false)) << "Address " << pos;
+    }
+}
+
+TEST(BootStateCache, FindAndInsert)
+{
+    const std::filesystem::path cache_path = std::filesystem::temp_directory_path() / "gbc-test-bootstates";
+    std::filesystem::remove_all(cache_path);
+
+    BootStateCache cache;
+    const std::vector<uint8_t> state = { 1, 2, 3, 4 };
+    std::vector<uint8_t> found;
+    EXPECT_FALSE(cache.find(1, found));
+    EXPECT_TRUE(cache.insert(1, state));
+    ASSERT_TRUE(cache.find(1, found));
+    EXPECT_TRUE(found == state);
+    EXPECT_EQ(1, cache.size());
+
+    // Memory only until there's a directory, then read back after clearing memory
+    cache.clear();
+    EXPECT_FALSE(cache.find(1, found));
+    cache.setDirectory(cache_path);
+    EXPECT_TRUE(cache.insert(2, state));
+    cache.clear();
+    ASSERT_TRUE(cache.find(2, found));
+    EXPECT_TRUE(found == state);
+
+    cache.setEnabled(false);
+    EXPECT_FALSE(cache.find(2, found));
+    EXPECT_TRUE(cache.insert(3, state));
+    cache.setEnabled(true);
+    EXPECT_FALSE(cache.find(3, found));
+
+    std::filesystem::remove_all(cache_path);
+}
+
+// A second start through the same boot ROM skips straight to where it handed over the first time,
+// out of memory and then out of the cache's directory
+TEST(BootStateCache, SkipsBootROM)
+{
+    for (const ROMUnitTest & rom : { getUnitTest(blargg::dmg_sound::_06_overflow_on_trigger), getUnitTest(blargg::dmg_sound::_07_len_sweep_period_sync) })
+    {
+        SCOPED_TRACE(rom.rom_path.string());
+        auto bios_path = rom.rom_path;
+        bios_path += ".bios.bin";
+        auto cache_path = rom.rom_path;
+        cache_path += ".bootstates";
+        {
+            std::ofstream bios_file(bios_path, std::ios::binary);
+            bios_file.write(reinterpret_cast<const char *>(test_bios.data()), test_bios.size());
+        }
+        std::filesystem::remove_all(cache_path);
+
+        std::shared_ptr<BootStateCache> cache = BootStateCache::getDefault();
+        cache->clear();
+        cache->setDirectory(cache_path);
+
+        const std::string rom_path = rom.rom_path.string();
+        std::vector<uint8_t> boot_state, state;
+        {
+            GBCEmulator cold(rom_path, rom_path + ".boot.log", bios_path.string(), false, false, false, false);
+            cold.runWithoutSleep = true;
+            EXPECT_EQ(0, cold.get_CPU()->get_register_16(CPU::REGISTERS::PC));
+            for (int i = 0; i < BOOT_TEST_MAX_INSTRUCTIONS && cache->size() == 0; i++)
+            {
+                cold.runNextInstruction();
+            }
+            ASSERT_EQ(1, cache->size());
+            EXPECT_EQ(0x42, cold.getVRAM(0).data[0]);
+            cold.snapshot(boot_state);
+
+            // Started before the boot ROM ran, but resets to where it handed over like a new emulator would
+            cold.runFrame();
+            cold.reset();
+            cold.snapshot(state);
+            EXPECT_TRUE(state == boot_state);
+        }
+
+        {
+            GBCEmulator warm(rom_path, rom_path + ".boot.log", bios_path.string(), false, false, false, false);
+            warm.snapshot(state);
+            EXPECT_TRUE(state == boot_state);
+
+            warm.runFrame();
+            warm.reset();
+            warm.snapshot(state);
+            EXPECT_TRUE(state == boot_state);
+        }
+
+        cache->clear();
+        {
+            GBCEmulator from_file(rom_path, rom_path + ".boot.log", bios_path.string(), false, false, false, false);
+            from_file.snapshot(state);
+            EXPECT_TRUE(state == boot_state);
+        }
+        EXPECT_EQ(1, cache->size());
+
+        cache->setDirectory("");
+        cache->clear();
+        std::filesystem::remove_all(cache_path);
+        std::filesystem::remove(bios_path);
+    }
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include <UnitTests.h>
+#include <GBCEmulator.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define CLONE_TEST_INSTRUCTIONS 100000
+
+// A clone has to run exactly like the emulator it came from
+TEST(Clone, RunsLikeItsSource)
+{
+    for (const ROMUnitTest & rom : { getUnitTest(blargg::cpu_instrs::_02_interrupts), getUnitTest(blargg::cgb_sound::_10_wave_trigger_while_on) })
+    {
+        SCOPED_TRACE(rom.rom_path.string());
+        const std::string rom_path = rom.rom_path.string();
+        GBCEmulator emu(rom_path, rom_path + ".clone.log", "", false, false, false, false);
+        emu.runWithoutSleep = true;
+        for (int i = 0; i < CLONE_TEST_INSTRUCTIONS; i++)
+        {
+            emu.runNextInstruction();
+        }
+
+        std::shared_ptr<GBCEmulator> clone = emu.clone();
+        for (int i = 0; i < CLONE_TEST_INSTRUCTIONS; i++)
+        {
+            emu.runNextInstruction();
+            clone->runNextInstruction();
+        }
+
+        std::vector<uint8_t> state, clone_state;
+        emu.snapshot(state);
+        clone->snapshot(clone_state);
+        EXPECT_TRUE(state == clone_state);
+        EXPECT_EQ(GBCEmulator::calculateFrameHash(emu.getFrameRaw()), GBCEmulator::calculateFrameHash(clone->getFrameRaw()));
+    }
+}
+
+// Discarded clones are reused, and clones of clones come from the same pool
+TEST(Clone, ReusesDiscardedClones)
+{
+    const ROMUnitTest rom = getUnitTest(blargg::cpu_instrs::_02_interrupts);
+    const std::string rom_path = rom.rom_path.string();
+    GBCEmulator emu(rom_path, rom_path + ".clone.log", "", false, false, false, false);
+    emu.runWithoutSleep = true;
+    for (int i = 0; i < CLONE_TEST_INSTRUCTIONS; i++)
+    {
+        emu.runNextInstruction();
+    }
+
+    std::vector<uint8_t> state, clone_state;
+    emu.snapshot(state);
+
+    std::shared_ptr<GBCEmulator> clone = emu.clone();
+    EXPECT_EQ(0u, emu.getNumIdleClones());
+    const GBCEmulator * discarded = clone.get();
+    clone.reset();
+    EXPECT_EQ(1u, emu.getNumIdleClones());
+
+    clone = emu.clone();
+    EXPECT_EQ(discarded, clone.get());
+    clone->snapshot(clone_state);
+    EXPECT_TRUE(state == clone_state);
+
+    std::shared_ptr<GBCEmulator> clone_of_clone = clone->clone();
+    clone_of_clone->snapshot(clone_state);
+    EXPECT_TRUE(state == clone_state);
+    clone_of_clone.reset();
+    EXPECT_EQ(1u, emu.getNumIdleClones());
+}
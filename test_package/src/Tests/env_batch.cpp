@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <UnitTests.h>
+#include <GBCEmulator.h>
+#include <GBCEnvBatch.h>
+#include <GBCEnvBatchC.h>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#define ENV_TEST_ENVS 3
+#define ENV_TEST_FRAMES 60
+
+namespace
+{
+    std::vector<uint8_t> getTestActions()
+    {
+        std::vector<uint8_t> actions(ENV_TEST_ENVS, INPUT_NO_BUTTONS);
+        actions[1] = INPUT_NO_BUTTONS & ~Joypad::getButtonBit(Joypad::BUTTON::A);
+        return actions;
+    }
+}
+
+// Every emulator in a batch has to run exactly like one on its own, with its own buttons
+TEST(EnvBatch, MatchesEmulator)
+{
+    for (const ROMUnitTest & rom : { getUnitTest(blargg::cpu_instrs::_04_op_r_imm), getUnitTest(blargg::dmg_sound::_01_registers) })
+    {
+        SCOPED_TRACE(rom.rom_path.string());
+        const std::string rom_path = rom.rom_path.string();
+        const std::vector<uint8_t> actions = getTestActions();
+        std::vector<uint8_t> screens(ENV_TEST_ENVS * ENV_SCREEN_OBSERVATION_SIZE);
+        std::vector<uint8_t> ram(ENV_TEST_ENVS * ENV_RAM_OBSERVATION_SIZE);
+
+        GBCEnvBatch envs(rom_path, ENV_TEST_ENVS, 2);
+        ASSERT_EQ(ENV_TEST_ENVS, envs.getNumEnvs());
+        envs.step(actions.data(), ENV_TEST_FRAMES, screens.data(), ram.data());
+        EXPECT_EQ(actions[1], envs.getEnv(1)->get_Joypad()->getJoypadState());
+
+        GBCEmulator emu(rom_path, rom_path + ".env.log", "", false, false, false, false);
+        emu.runWithoutSleep = true;
+        emu.get_APU()->setSilentMode(true);
+        for (int i = 0; i < ENV_TEST_FRAMES; i++)
+        {
+            emu.runFrame();
+        }
+        const std::vector<uint8_t> memory_map = emu.get_memory_map();
+        for (const size_t env : { 0, 2 })
+        {
+            EXPECT_EQ(0, std::memcmp(&screens[env * ENV_SCREEN_OBSERVATION_SIZE], emu.getFrameRaw(), ENV_SCREEN_OBSERVATION_SIZE));
+            EXPECT_EQ(0, std::memcmp(&ram[env * ENV_RAM_OBSERVATION_SIZE], memory_map.data(), ENV_RAM_OBSERVATION_SIZE));
+        }
+    }
+}
+
+// Same through the C interface, from a reset. Envs never leave a .sav behind,
+// though this cartridge has battery backed RAM
+TEST(EnvBatch, CInterface)
+{
+    const ROMUnitTest rom = getUnitTest(blargg::dmg_sound::_01_registers);
+    const std::string rom_path = rom.rom_path.string();
+    std::filesystem::path sav_path = rom.rom_path;
+    sav_path.replace_extension(".sav");
+    std::filesystem::remove(sav_path);
+
+    const std::vector<uint8_t> actions = getTestActions();
+    std::vector<uint8_t> screens(ENV_TEST_ENVS * ENV_SCREEN_OBSERVATION_SIZE);
+    {
+        GBCEnvBatch envs(rom_path, ENV_TEST_ENVS, 2);
+        envs.step(actions.data(), ENV_TEST_FRAMES, screens.data(), nullptr);
+    }
+
+    gbc_env_batch * c_envs = gbc_env_batch_create(rom_path.c_str(), ENV_TEST_ENVS, 2);
+    ASSERT_NE(nullptr, c_envs);
+    EXPECT_EQ(ENV_TEST_ENVS, gbc_env_batch_num_envs(c_envs));
+    EXPECT_EQ(ENV_SCREEN_OBSERVATION_SIZE, gbc_env_screen_size());
+    EXPECT_EQ(ENV_RAM_OBSERVATION_SIZE, gbc_env_ram_size());
+
+    std::vector<uint8_t> c_screens(screens.size());
+    EXPECT_EQ(0, gbc_env_batch_step(c_envs, actions.data(), ENV_TEST_FRAMES / 2, nullptr, nullptr));
+    EXPECT_EQ(0, gbc_env_batch_reset(c_envs, nullptr, nullptr));
+    EXPECT_EQ(0, gbc_env_batch_step(c_envs, actions.data(), ENV_TEST_FRAMES, c_screens.data(), nullptr));
+    EXPECT_TRUE(screens == c_screens);
+    gbc_env_batch_destroy(c_envs);
+
+    EXPECT_FALSE(std::filesystem::exists(sav_path));
+    EXPECT_EQ(nullptr, gbc_env_batch_create("missing.gb", 1, 1));
+}
@@ -0,0 +1,81 @@
+#include <Fixtures/ROMTestFixture.h>
+#include <gtest/gtest.h>
+#include <UnitTests.h>
+
+TEST_F(ROMTestFixture, force_cgb_cpu_instrs_01_special)
+{
+    use_force_cgb = true;
+    SetUp(blargg::cpu_instrs::_01_special);
+}
+
+TEST_F(ROMTestFixture, force_cgb_cpu_instrs_02_interrupts)
+{
+    use_force_cgb = true;
+    SetUp(blargg::cpu_instrs::_02_interrupts);
+}
+
+TEST_F(ROMTestFixture, force_cgb_cpu_instrs_03_op_sp_hl)
+{
+    use_force_cgb = true;
+    SetUp(blargg::cpu_instrs::_03_op_sp_hl);
+}
+
+TEST_F(ROMTestFixture, force_cgb_cpu_instrs_04_op_r_imm)
+{
+    use_force_cgb = true;
+    SetUp(blargg::cpu_instrs::_04_op_r_imm);
+}
+
+TEST_F(ROMTestFixture, force_cgb_cpu_instrs_05_op_rp)
+{
+    use_force_cgb = true;
+    SetUp(blargg::cpu_instrs::_05_op_rp);
+}
+
+TEST_F(ROMTestFixture, force_cgb_cpu_instrs_06_ld_r_r)
+{
+    use_force_cgb = true;
+    SetUp(blargg::cpu_instrs::_06_ld_r_r);
+}
+
+TEST_F(ROMTestFixture, force_cgb_cpu_instrs_07_jr_jp_call_ret_rst)
+{
+    use_force_cgb = true;
+    SetUp(blargg::cpu_instrs::_07_jr_jp_call_ret_rst);
+}
+
+TEST_F(ROMTestFixture, force_cgb_cpu_instrs_08_misc_instrs)
+{
+    use_force_cgb = true;
+    SetUp(blargg::cpu_instrs::_08_misc_instrs);
+}
+
+TEST_F(ROMTestFixture, force_cgb_cpu_instrs_09_op_r_r)
+{
+    use_force_cgb = true;
+    SetUp(blargg::cpu_instrs::_09_op_r_r);
+}
+
+TEST_F(ROMTestFixture, force_cgb_cpu_instrs_10_bit_ops)
+{
+    use_force_cgb = true;
+    SetUp(blargg::cpu_instrs::_10_bit_ops);
+}
+
+TEST_F(ROMTestFixture, force_cgb_cpu_instrs_11_op_a_hl)
+{
+    use_force_cgb = true;
+    SetUp(blargg::cpu_instrs::_11_op_a_hl);
+}
+
+TEST_F(ROMTestFixture, force_cgb_oam_bug_03_non_causes)
+{
+    use_force_cgb = true;
+    SetUp(blargg::oam_bug::_03_non_causes);
+}
+
+TEST_F(ROMTestFixture, force_cgb_oam_bug_06_timing_no_bug)
+{
+    use_force_cgb = true;
+    SetUp(blargg::oam_bug::_06_timing_no_bug);
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <UnitTests.h>
+#include <GBCEmulator.h>
+#include <array>
+#include <string>
+#include <vector>
+
+#define OBSERVATION_TEST_FRAMES 60
+
+// Observations written line by line have to match what's worked out from the finished frame
+TEST(FrameObservation, MatchesFrame)
+{
+    for (const ROMUnitTest & rom : { getUnitTest(blargg::cpu_instrs::_01_special), getUnitTest(blargg::cgb_sound::_01_registers) })
+    {
+        SCOPED_TRACE(rom.rom_path.string());
+        const std::string rom_path = rom.rom_path.string();
+        GBCEmulator emu(rom_path, rom_path + ".observation.log", "", false, false, false, false);
+        emu.runWithoutSleep = true;
+
+        std::vector<uint8_t> shades(SCREEN_PIXEL_TOTAL), luma(SCREEN_PIXEL_TOTAL);
+        std::vector<uint8_t> half((SCREEN_PIXEL_W / 2) * (SCREEN_PIXEL_H / 2)), small(84 * 84);
+
+        // Exactly half size first, every pixel is the average of a 2x2 block
+        FrameObservation observation = {};
+        observation.shades = shades.data();
+        observation.luma = luma.data();
+        observation.downscaled_luma = half.data();
+        observation.downscaled_w = SCREEN_PIXEL_W / 2;
+        observation.downscaled_h = SCREEN_PIXEL_H / 2;
+        ASSERT_TRUE(emu.get_GPU()->setFrameObservation(observation));
+
+        for (int i = 0; i < OBSERVATION_TEST_FRAMES; i++)
+        {
+            emu.runFrame();
+        }
+
+        const SDL_Color * frame = emu.getFrameRaw();
+        for (int i = 0; i < SCREEN_PIXEL_TOTAL; i++)
+        {
+            ASSERT_EQ((77 * frame[i].r + 150 * frame[i].g + 29 * frame[i].b) >> 8, luma[i]) << "Pixel " << i;
+            ASSERT_LT(shades[i], OBSERVATION_SHADES);
+        }
+
+        if (!emu.isColorGB())
+        {   // Background only, each shade is always the same color
+            std::array<int, OBSERVATION_SHADES> shade_color;
+            shade_color.fill(-1);
+            for (int i = 0; i < SCREEN_PIXEL_TOTAL; i++)
+            {
+                if (shade_color[shades[i]] < 0)
+                {
+                    shade_color[shades[i]] = luma[i];
+                }
+                EXPECT_EQ(shade_color[shades[i]], luma[i]);
+            }
+        }
+
+        for (int y = 0; y < SCREEN_PIXEL_H / 2; y++)
+        {
+            for (int x = 0; x < SCREEN_PIXEL_W / 2; x++)
+            {
+                const int top = (y * 2) * SCREEN_PIXEL_W + x * 2;
+                const int bottom = top + SCREEN_PIXEL_W;
+                const int sum = luma[top] + luma[top + 1] + luma[bottom] + luma[bottom + 1];
+                ASSERT_EQ((sum + 2) / 4, half[y * (SCREEN_PIXEL_W / 2) + x]) << "x " << x << ", y " << y;
+            }
+        }
+
+        // Uneven downscale keeps the frame's overall brightness
+        observation = {};
+        observation.downscaled_luma = small.data();
+        observation.downscaled_w = 84;
+        observation.downscaled_h = 84;
+        ASSERT_TRUE(emu.get_GPU()->setFrameObservation(observation));
+        emu.runFrame();
+
+        double luma_mean = 0, small_mean = 0;
+        for (int i = 0; i < SCREEN_PIXEL_TOTAL; i++)
+        {
+            luma_mean += (77 * frame[i].r + 150 * frame[i].g + 29 * frame[i].b) >> 8;
+        }
+        for (const uint8_t & val : small)
+        {
+            small_mean += val;
+        }
+        EXPECT_NEAR(luma_mean / (SCREEN_PIXEL_TOTAL), small_mean / small.size(), 1.0);
+
+        observation.downscaled_w = SCREEN_PIXEL_W + 1;
+        EXPECT_FALSE(emu.get_GPU()->setFrameObservation(observation));
+        emu.get_GPU()->clearFrameObservation();
+    }
+}
@@ -0,0 +1,21 @@
+#include <Fixtures/ROMTestFixture.h>
+#include <gtest/gtest.h>
+#include <UnitTests.h>
+
+TEST_F(ROMTestFixture, pipelined_rendering_cpu_instrs_01_special)
+{
+    use_pipelined_rendering = true;
+    SetUp(blargg::cpu_instrs::_01_special);
+}
+
+TEST_F(ROMTestFixture, pipelined_rendering_dmg_sounds_01_registers)
+{
+    use_pipelined_rendering = true;
+    SetUp(blargg::dmg_sound::_01_registers);
+}
+
+TEST_F(ROMTestFixture, pipelined_rendering_cgb_sounds_01_registers)
+{
+    use_pipelined_rendering = true;
+    SetUp(blargg::cgb_sound::_01_registers);
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <UnitTests.h>
+#include <GBCEmulator.h>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define PEEK_TEST_FRAMES 30
+
+// Peeking and the memory spans see the same bytes as reading through the memory map
+TEST(MemoryPeek, MatchesMemoryMap)
+{
+    for (const ROMUnitTest & rom : { getUnitTest(blargg::cpu_instrs::_01_special), getUnitTest(blargg::cgb_sound::_01_registers) })
+    {
+        SCOPED_TRACE(rom.rom_path.string());
+        const std::string rom_path = rom.rom_path.string();
+        GBCEmulator emu(rom_path, rom_path + ".peek.log", "", false, false, false, false);
+        emu.runWithoutSleep = true;
+        for (int i = 0; i < PEEK_TEST_FRAMES; i++)
+        {
+            emu.runFrame();
+        }
+
+        // Peek before reading, reading the APU's registers catches it up
+        std::vector<uint8_t> memory_map(0x10000);
+        emu.peek(0x0000, memory_map.size(), memory_map.data());
+        EXPECT_EQ(0xFF, memory_map[0xFEA0]);
+
+        const std::shared_ptr<Memory> memory = emu.get_CPU()->memory;
+        for (uint32_t pos = 0; pos < memory_map.size(); pos++)
+        {
+            if (pos < 0xFF10 || pos >= 0xFF40)
+            {
+                ASSERT_EQ(memory->readByte(static_cast<uint16_t>(pos), false), memory_map[pos]) << "Address " << pos;
+            }
+        }
+
+        const std::vector<uint8_t> full_map = emu.get_memory_map();
+        EXPECT_EQ(0, std::memcmp(full_map.data(), memory_map.data(), full_map.size()));
+
+        // Ranges across region boundaries, and off the end of the memory map
+        std::vector<uint8_t> range(0x40);
+        for (const uint16_t & start : { 0x00F0, 0x3FE0, 0x7FF0, 0x9FF0, 0xBFF0, 0xCFF0, 0xDFF0, 0xFDF0, 0xFE90, 0xFF60, 0xFFE0 })
+        {
+            emu.peek(start, range.size(), range.data());
+            for (size_t i = 0; i < range.size(); i++)
+            {
+                const uint8_t expected = (start + i < 0x10000) ? memory_map[start + i] : 0xFF;
+                ASSERT_EQ(expected, range[i]) << "Address " << start + i;
+            }
+        }
+
+        // Spans are the memory itself, so they see writes straight away
+        const int num_work_ram_banks = emu.isColorGB() ? 8 : 2;
+        ASSERT_EQ(num_work_ram_banks, emu.getNumWorkRAMBanks());
+        EXPECT_EQ(0u, emu.getWorkRAM(num_work_ram_banks).size);
+        EXPECT_EQ(0u, emu.getVRAM(emu.getNumVRAMBanks()).size);
+        EXPECT_EQ(0u, emu.getCartridgeRAM(emu.getNumCartridgeRAMBanks()).size);
+
+        const MemorySpan work_ram = emu.getWorkRAM(0);
+        ASSERT_EQ(static_cast<size_t>(WORK_RAM_SIZE), work_ram.size);
+        EXPECT_EQ(0, std::memcmp(work_ram.data, &memory_map[0xC000], work_ram.size));
+
+        const MemorySpan high_ram = emu.getHighRAM();
+        ASSERT_EQ(0x7Fu, high_ram.size);
+        EXPECT_EQ(0, std::memcmp(high_ram.data, &memory_map[0xFF80], high_ram.size));
+
+        const MemorySpan oam = emu.getOAM();
+        ASSERT_EQ(static_cast<size_t>(OAM_SIZE), oam.size);
+        EXPECT_EQ(0, std::memcmp(oam.data, &memory_map[0xFE00], oam.size));
+
+        const MemorySpan vram = emu.getVRAM(emu.get_GPU()->getCurrentVRAMBank());
+        ASSERT_EQ(static_cast<size_t>(VRAM_SIZE), vram.size);
+        EXPECT_EQ(0, std::memcmp(vram.data, &memory_map[0x8000], vram.size));
+
+        const uint8_t old_val = work_ram.data[0x10];
+        memory->setByte(0xC010, old_val ^ 0xFF);
+        EXPECT_EQ(old_val ^ 0xFF, work_ram.data[0x10]);
+        memory->setByte(0xC010, old_val);
+    }
+}
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <UnitTests.h>
+#include <GBCEmulator.h>
+#include <EmulatorPool.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define RESET_TEST_FRAMES 30
+#define RESET_TEST_THREADS 4
+
+namespace
+{
+    std::vector<ROMUnitTest> getResetROMs()
+    {
+        return { getUnitTest(blargg::cpu_instrs::_03_op_sp_hl), getUnitTest(blargg::dmg_sound::_02_len_ctr) };
+    }
+
+    uint64_t runTestFrames(GBCEmulator & emu)
+    {
+        for (int i = 0; i < RESET_TEST_FRAMES; i++)
+        {
+            emu.runFrame();
+        }
+        return GBCEmulator::calculateFrameHash(emu.getFrameRaw());
+    }
+}
+
+// Reset goes back to power on in place and runs exactly as it did the first time
+TEST(Reset, RunsTheSameAgain)
+{
+    for (const ROMUnitTest & rom : getResetROMs())
+    {
+        SCOPED_TRACE(rom.rom_path.string());
+        const std::string rom_path = rom.rom_path.string();
+        GBCEmulator emu(rom_path, rom_path + ".reset.log", "", false, false, false, false);
+        emu.runWithoutSleep = true;
+
+        std::vector<uint8_t> power_on_state, first_state, state;
+        emu.snapshot(power_on_state);
+        runTestFrames(emu);
+        emu.snapshot(first_state);
+
+        const std::shared_ptr<CPU> cpu = emu.get_CPU();
+        emu.reset();
+        EXPECT_EQ(cpu, emu.get_CPU());
+        EXPECT_TRUE(emu.getSerialOutput().empty());
+        emu.snapshot(state);
+        EXPECT_TRUE(state == power_on_state);
+
+        runTestFrames(emu);
+        emu.snapshot(state);
+        EXPECT_TRUE(state == first_state);
+
+        // Not a state for this ROM, nothing changes
+        EXPECT_FALSE(emu.reset(std::vector<uint8_t>(sizeof(SaveStateHeader))));
+        emu.snapshot(state);
+        EXPECT_TRUE(state == first_state);
+    }
+}
+
+// The pool hands out emulators at power on and gets them back when they're discarded
+TEST(EmulatorPool, HandsOutPowerOnEmulators)
+{
+    for (const ROMUnitTest & rom : getResetROMs())
+    {
+        SCOPED_TRACE(rom.rom_path.string());
+        const std::string rom_path = rom.rom_path.string();
+        GBCEmulator emu(rom_path, rom_path + ".reset.log", "", false, false, false, false);
+        emu.runWithoutSleep = true;
+        const uint64_t first_hash = runTestFrames(emu);
+
+        EmulatorPool pool;
+        EXPECT_EQ(0, pool.getNumIdle(rom_path));
+        pool.warm(rom_path, 2);
+        EXPECT_EQ(2, pool.getNumIdle(rom_path));
+
+        std::shared_ptr<GBCEmulator> pooled = pool.acquire(rom_path);
+        EXPECT_EQ(1, pool.getNumIdle(rom_path));
+        EXPECT_EQ(first_hash, runTestFrames(*pooled));
+
+        // Handed out again, back at power on
+        const GBCEmulator * discarded = pooled.get();
+        pooled.reset();
+        EXPECT_EQ(2, pool.getNumIdle(rom_path));
+        pooled = pool.acquire(rom_path);
+        EXPECT_EQ(discarded, pooled.get());
+        EXPECT_EQ(first_hash, runTestFrames(*pooled));
+    }
+}
+
+// Acquired and run on several threads at once, logging to the same file
+TEST(EmulatorPool, RunsOnManyThreads)
+{
+    const ROMUnitTest rom = getResetROMs()[0];
+    const std::string rom_path = rom.rom_path.string();
+    GBCEmulator emu(rom_path, rom_path + ".reset.log", "", false, false, false, false);
+    emu.runWithoutSleep = true;
+    const uint64_t first_hash = runTestFrames(emu);
+
+    EmulatorPool pool;
+    std::vector<uint64_t> hashes(RESET_TEST_THREADS);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < RESET_TEST_THREADS; i++)
+    {
+        threads.emplace_back([&, i]()
+        {
+            std::shared_ptr<GBCEmulator> emulator = pool.acquire(rom_path);
+            emulator->logger->set_level(spdlog::level::info);
+            for (int frame = 0; frame < RESET_TEST_FRAMES; frame++)
+            {
+                emulator->runFrame();
+                emulator->logger->info("Thread {} ran frame {}", i, frame);
+            }
+            hashes[i] = GBCEmulator::calculateFrameHash(emulator->getFrameRaw());
+        });
+    }
+    for (std::thread & thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(std::vector<uint64_t>(RESET_TEST_THREADS, first_hash), hashes);
+}
@@ -0,0 +1,120 @@
+#include <Fixtures/ROMTestFixture.h>
+#include <gtest/gtest.h>
+#include <UnitTests.h>
+#include <RewindBuffer.h>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+TEST_F(ROMTestFixture, rewind_cpu_instrs_03_op_sp_hl)
+{
+    use_rewind = true;
+    SetUp(blargg::cpu_instrs::_03_op_sp_hl);
+}
+
+TEST_F(ROMTestFixture, rewind_dmg_sounds_06_overflow_on_trigger)
+{
+    use_rewind = true;
+    SetUp(blargg::dmg_sound::_06_overflow_on_trigger);
+}
+
+#define REWIND_TEST_SNAPSHOTS 16
+#define REWIND_TEST_STATE_SIZE 4096
+
+namespace
+{
+    // Waits for a free buffer rather than dropping the snapshot
+    void addState(RewindBuffer & rewind_buffer, const std::vector<uint8_t> & state)
+    {
+        std::vector<uint8_t> * capture = nullptr;
+        while ((capture = rewind_buffer.getCaptureBuffer()) == nullptr)
+        {
+            std::this_thread::yield();
+        }
+        *capture = state;
+        rewind_buffer.submitCapture();
+    }
+
+    // Each state changes a few bytes of the one before it: lone bytes, bytes split by
+    // unchanged runs shorter than REWIND_MIN_ZERO_RUN, and the first and last bytes
+    std::vector<std::vector<uint8_t>> makeStates()
+    {
+        std::vector<std::vector<uint8_t>> states(REWIND_TEST_SNAPSHOTS);
+        std::vector<uint8_t> state(REWIND_TEST_STATE_SIZE);
+        for (size_t i = 0; i < state.size(); i++)
+        {
+            state[i] = static_cast<uint8_t>(i * 7);
+        }
+
+        for (size_t i = 0; i < states.size(); i++)
+        {
+            state[(i * 131) % state.size()]++;
+            state[(i * 257 + 1000) % state.size()] ^= 0x5A;
+            state[(i * 257 + 1000 + REWIND_MIN_ZERO_RUN - 1) % state.size()]--;
+            if (i % 4 == 0)
+            {
+                state.front()++;
+                state.back()++;
+            }
+            states[i] = state;
+        }
+
+        // Nothing changed at all
+        states.back() = states[states.size() - 2];
+        return states;
+    }
+}
+
+// States have to come back out of the history exactly as they went in, newest first
+TEST(RewindBuffer, DeltaRoundTrip)
+{
+    const std::vector<std::vector<uint8_t>> states = makeStates();
+    RewindBuffer rewind_buffer;
+    for (const auto & state : states)
+    {
+        addState(rewind_buffer, state);
+    }
+
+    std::vector<uint8_t> state;
+    for (auto it = states.rbegin(); it != states.rend(); ++it)
+    {
+        ASSERT_TRUE(rewind_buffer.stepBack(state));
+        EXPECT_TRUE(state == *it);
+    }
+    EXPECT_FALSE(rewind_buffer.stepBack(state));
+}
+
+// Older states take far less room than the newest one when little changed
+TEST(RewindBuffer, DeltasAreSmall)
+{
+    const std::vector<std::vector<uint8_t>> states = makeStates();
+    RewindBuffer rewind_buffer;
+    for (const auto & state : states)
+    {
+        addState(rewind_buffer, state);
+    }
+
+    // Stepping back waits for compression to catch up
+    std::vector<uint8_t> state;
+    ASSERT_TRUE(rewind_buffer.stepBack(state));
+
+    const RewindStats stats = rewind_buffer.getStats();
+    EXPECT_EQ(stats.num_snapshots, states.size() - 1);
+    EXPECT_LT(stats.memory_used, 2 * states[0].size());
+}
+
+// Oldest states are dropped to stay in budget, this one only has room for the newest
+TEST(RewindBuffer, TrimsToBudget)
+{
+    const std::vector<std::vector<uint8_t>> states = makeStates();
+    RewindBuffer rewind_buffer(states[0].size());
+    for (const auto & state : states)
+    {
+        addState(rewind_buffer, state);
+    }
+
+    std::vector<uint8_t> state;
+    ASSERT_TRUE(rewind_buffer.stepBack(state));
+    EXPECT_TRUE(state == states.back());
+    EXPECT_FALSE(rewind_buffer.stepBack(state));
+}
@@ -0,0 +1,63 @@
+#include <Fixtures/ROMTestFixture.h>
+#include <gtest/gtest.h>
+#include <UnitTests.h>
+#include <GBCEmulator.h>
+#include <FrameSink.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+TEST_F(ROMTestFixture, run_ahead_cpu_instrs_02_interrupts)
+{
+    use_run_ahead = true;
+    SetUp(blargg::cpu_instrs::_02_interrupts);
+}
+
+TEST_F(ROMTestFixture, run_ahead_cgb_sounds_10_wave_trigger_while_on)
+{
+    use_run_ahead = true;
+    SetUp(blargg::cgb_sound::_10_wave_trigger_while_on);
+}
+
+TEST_F(ROMTestFixture, run_ahead_pipelined_apu_dmg_sounds_02_len_ctr)
+{
+    use_run_ahead = true;
+    use_pipelined_apu = true;
+    SetUp(blargg::dmg_sound::_02_len_ctr);
+}
+
+#define RUN_AHEAD_TEST_FRAMES 2
+#define RUN_AHEAD_TEST_INSTRUCTIONS 100000
+
+// Running ahead can't change where the real frames end up
+TEST(RunAhead, RealFramesUnchanged)
+{
+    for (const ROMUnitTest & rom : { getUnitTest(blargg::cpu_instrs::_02_interrupts), getUnitTest(blargg::cgb_sound::_10_wave_trigger_while_on) })
+    {
+        SCOPED_TRACE(rom.rom_path.string());
+        const std::string rom_path = rom.rom_path.string();
+        GBCEmulator emu(rom_path, rom_path + ".run_ahead.log", "", false, false, false, false);
+        emu.runWithoutSleep = true;
+        emu.setFrameSink(std::make_shared<MemoryFrameSink>());   // Frames are only run ahead when they're shown
+
+        std::vector<uint8_t> start_state, end_state, run_ahead_end_state;
+        emu.snapshot(start_state);
+        for (int i = 0; i < RUN_AHEAD_TEST_INSTRUCTIONS; i++)
+        {
+            emu.runNextInstruction();
+        }
+        emu.snapshot(end_state);
+
+        ASSERT_TRUE(emu.restore(start_state));
+        emu.setRunAheadFrames(RUN_AHEAD_TEST_FRAMES);
+        EXPECT_EQ(static_cast<uint32_t>(RUN_AHEAD_TEST_FRAMES), emu.getRunAheadFrames());
+        for (int i = 0; i < RUN_AHEAD_TEST_INSTRUCTIONS; i++)
+        {
+            emu.runNextInstruction();
+        }
+        emu.snapshot(run_ahead_end_state);
+
+        EXPECT_TRUE(end_state == run_ahead_end_state);
+        EXPECT_GT(emu.runAheadTimeMicro.count(), 0);
+    }
+}
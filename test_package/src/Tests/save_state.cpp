@@ -0,0 +1,147 @@
+#include <Fixtures/ROMTestFixture.h>
+#include <gtest/gtest.h>
+#include <UnitTests.h>
+#include <GBCEmulator.h>
+#include <SaveState.h>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+TEST_F(ROMTestFixture, save_state_cpu_instrs_02_interrupts)
+{
+    use_save_state = true;
+    SetUp(blargg::cpu_instrs::_02_interrupts);
+}
+
+TEST_F(ROMTestFixture, save_state_dmg_sounds_02_len_ctr)
+{
+    use_save_state = true;
+    SetUp(blargg::dmg_sound::_02_len_ctr);
+}
+
+TEST_F(ROMTestFixture, save_state_cgb_sounds_10_wave_trigger_while_on)
+{
+    use_save_state = true;
+    SetUp(blargg::cgb_sound::_10_wave_trigger_while_on);
+}
+
+TEST_F(ROMTestFixture, save_state_pipelined_apu_dmg_sounds_01_registers)
+{
+    use_save_state = true;
+    use_pipelined_apu = true;
+    SetUp(blargg::dmg_sound::_01_registers);
+}
+
+#define SAVE_STATE_TEST_INSTRUCTIONS 100000
+
+namespace
+{
+    // One DMG and one CGB cartridge
+    std::vector<ROMUnitTest> getSaveStateROMs()
+    {
+        return { getUnitTest(blargg::cpu_instrs::_02_interrupts), getUnitTest(blargg::cgb_sound::_10_wave_trigger_while_on) };
+    }
+
+    void runInstructions(GBCEmulator & emu, const int & count)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            emu.runNextInstruction();
+        }
+    }
+}
+
+// Running on from a restored state has to end up in exactly the same state as the first time
+TEST(SaveState, RestoredStateRunsTheSame)
+{
+    for (const ROMUnitTest & rom : getSaveStateROMs())
+    {
+        SCOPED_TRACE(rom.rom_path.string());
+        const std::string rom_path = rom.rom_path.string();
+        GBCEmulator emu(rom_path, rom_path + ".state.log", "", false, false, false, false);
+        std::vector<uint8_t> start_state, end_state;
+
+        runInstructions(emu, SAVE_STATE_TEST_INSTRUCTIONS);
+        emu.snapshot(start_state);
+        runInstructions(emu, SAVE_STATE_TEST_INSTRUCTIONS);
+        emu.snapshot(end_state);
+
+        ASSERT_TRUE(emu.restore(start_state));
+        runInstructions(emu, SAVE_STATE_TEST_INSTRUCTIONS);
+
+        // Start state's memory is reused, not reallocated
+        const uint8_t * state_data = start_state.data();
+        emu.snapshot(start_state);
+        EXPECT_EQ(state_data, start_state.data());
+        EXPECT_TRUE(start_state == end_state);
+    }
+}
+
+TEST(SaveState, CompressedFileRoundTrip)
+{
+    const ROMUnitTest rom = getUnitTest(blargg::cpu_instrs::_02_interrupts);
+    const std::string rom_path = rom.rom_path.string();
+    GBCEmulator emu(rom_path, rom_path + ".state.log", "", false, false, false, false);
+    runInstructions(emu, SAVE_STATE_TEST_INSTRUCTIONS);
+
+    std::vector<uint8_t> state, file_state;
+    emu.snapshot(state);
+
+    auto state_path = rom.rom_path;
+    state_path += ".state";
+    ASSERT_TRUE(writeSaveStateFile(state_path, state));
+    ASSERT_TRUE(readSaveStateFile(state_path, file_state));
+    EXPECT_TRUE(state == file_state);
+    EXPECT_LT(std::filesystem::file_size(state_path), state.size());
+    std::filesystem::remove(state_path);
+}
+
+// States for another ROM or version are refused before anything is loaded
+TEST(SaveState, RefusesOtherROMsAndVersions)
+{
+    const std::vector<ROMUnitTest> roms = getSaveStateROMs();
+    const std::string rom_path = roms[0].rom_path.string(), other_rom_path = roms[1].rom_path.string();
+    GBCEmulator emu(rom_path, rom_path + ".state.log", "", false, false, false, false);
+    GBCEmulator other(other_rom_path, other_rom_path + ".state.log", "", false, false, false, false);
+
+    std::vector<uint8_t> state, other_state, after_state;
+    emu.snapshot(state);
+    other.snapshot(other_state);
+    EXPECT_FALSE(emu.restore(other_state));
+
+    state[offsetof(SaveStateHeader, version)]++;
+    EXPECT_FALSE(emu.restore(state));
+
+    emu.snapshot(after_state);
+    state[offsetof(SaveStateHeader, version)]--;
+    EXPECT_TRUE(state == after_state);
+}
+
+// A state cut short that still claims to be for this ROM is refused with nothing loaded
+TEST(SaveState, CorruptStateIsRolledBack)
+{
+    for (const ROMUnitTest & rom : getSaveStateROMs())
+    {
+        SCOPED_TRACE(rom.rom_path.string());
+        const std::string rom_path = rom.rom_path.string();
+        GBCEmulator emu(rom_path, rom_path + ".state.log", "", false, false, false, false);
+
+        std::vector<uint8_t> state;
+        runInstructions(emu, SAVE_STATE_TEST_INSTRUCTIONS);
+        emu.snapshot(state);
+        runInstructions(emu, SAVE_STATE_TEST_INSTRUCTIONS);
+
+        std::vector<uint8_t> cut_short(state.begin(), state.begin() + state.size() / 2);
+        SaveStateHeader header;
+        std::memcpy(&header, cut_short.data(), sizeof(header));
+        header.size = static_cast<uint32_t>(cut_short.size());
+        std::memcpy(cut_short.data(), &header, sizeof(header));
+
+        std::vector<uint8_t> before_state, after_state;
+        emu.snapshot(before_state);
+        EXPECT_FALSE(emu.restore(cut_short));
+        emu.snapshot(after_state);
+        EXPECT_TRUE(before_state == after_state);
+    }
+}
@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+#include <UnitTests.h>
+
+#ifndef _WIN32
+#include <GBCEmulator.h>
+#include <GBCEnvBatch.h>
+#include <GBCServer.h>
+#include <SharedMemoryRing.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define SERVER_TEST_FRAMES 10
+#define RING_TEST_SLOTS 4
+#define RING_TEST_SLOT_SIZE 256
+#define RING_TEST_ENTRIES 100000
+
+namespace
+{
+    std::string getTestName(const std::string & what)
+    {
+        return "gbc-test-" + what + "-" + std::to_string(getpid());
+    }
+}
+
+// Entries read back as they were written, until the writer laps them
+TEST(SharedMemoryRing, ReadsEntries)
+{
+    const std::string name = "/" + getTestName("ring");
+    SharedMemoryRing ring(name, RING_TEST_SLOTS, RING_TEST_SLOT_SIZE);
+    ring.setInfo(160, 144);
+    SharedMemoryRingReader reader(name);
+    EXPECT_EQ(static_cast<uint32_t>(RING_TEST_SLOTS), reader.getHeader().num_slots);
+    EXPECT_EQ(static_cast<uint32_t>(RING_TEST_SLOT_SIZE), reader.getHeader().slot_size);
+    EXPECT_EQ(160u, reader.getHeader().info[0]);
+    EXPECT_EQ(144u, reader.getHeader().info[1]);
+
+    std::vector<uint8_t> entry;
+    uint64_t tag;
+    EXPECT_EQ(0u, reader.getWriteSequence());
+    EXPECT_FALSE(reader.read(0, entry, tag));
+
+    const std::vector<uint8_t> data = { 1, 2, 3, 4, 5 };
+    EXPECT_EQ(0u, ring.publish(data.data(), data.size(), 42));
+    EXPECT_EQ(1u, reader.getWriteSequence());
+    ASSERT_TRUE(reader.read(0, entry, tag));
+    EXPECT_TRUE(entry == data);
+    EXPECT_EQ(42u, tag);
+
+    // Too big for a slot, cut short
+    const std::vector<uint8_t> big(RING_TEST_SLOT_SIZE * 2, 0xAB);
+    EXPECT_EQ(1u, ring.publish(big.data(), big.size(), 43));
+    ASSERT_TRUE(reader.read(1, entry, tag));
+    EXPECT_EQ(static_cast<size_t>(RING_TEST_SLOT_SIZE), entry.size());
+
+    // Being written, not there yet
+    std::memset(ring.beginEntry(), 0xCD, RING_TEST_SLOT_SIZE);
+    EXPECT_FALSE(reader.read(2, entry, tag));
+    EXPECT_EQ(2u, ring.commitEntry(data.size(), 44));
+    ASSERT_TRUE(reader.read(2, entry, tag));
+    EXPECT_EQ(std::vector<uint8_t>(data.size(), 0xCD), entry);
+
+    // Entry 0's slot is reused by entry RING_TEST_SLOTS
+    for (uint64_t i = 3; i <= RING_TEST_SLOTS; i++)
+    {
+        ring.publish(data.data(), data.size(), i);
+    }
+    EXPECT_FALSE(reader.read(0, entry, tag));
+    ASSERT_TRUE(reader.read(RING_TEST_SLOTS, entry, tag));
+    EXPECT_EQ(static_cast<uint64_t>(RING_TEST_SLOTS), tag);
+    EXPECT_FALSE(reader.read(RING_TEST_SLOTS + 1, entry, tag));
+
+    EXPECT_THROW(SharedMemoryRingReader("/" + getTestName("missing")), std::runtime_error);
+}
+
+// A reader racing the writer gets whole entries or nothing, never one torn between two writes
+TEST(SharedMemoryRing, NoTornReads)
+{
+    const std::string name = "/" + getTestName("race");
+    SharedMemoryRing ring(name, RING_TEST_SLOTS, RING_TEST_SLOT_SIZE);
+    SharedMemoryRingReader reader(name);
+
+    std::atomic_bool writing(true);
+    std::thread writer([&]()
+    {
+        for (uint64_t i = 0; i < RING_TEST_ENTRIES; i++)
+        {   // Every byte of an entry is its number
+            std::memset(ring.beginEntry(), static_cast<uint8_t>(i), RING_TEST_SLOT_SIZE);
+            ring.commitEntry(RING_TEST_SLOT_SIZE, i);
+        }
+        writing = false;
+    });
+
+    std::vector<uint8_t> entry;
+    uint64_t tag;
+    while (writing)
+    {
+        const uint64_t written = reader.getWriteSequence();
+        if (written == 0 || !reader.read(written - 1, entry, tag))
+        {
+            continue;
+        }
+
+        ASSERT_EQ(written - 1, tag);
+        ASSERT_EQ(std::vector<uint8_t>(RING_TEST_SLOT_SIZE, static_cast<uint8_t>(tag)), entry) << "Entry " << tag;
+    }
+    writer.join();
+
+    EXPECT_EQ(static_cast<uint64_t>(RING_TEST_ENTRIES), reader.getWriteSequence());
+    ASSERT_TRUE(reader.read(RING_TEST_ENTRIES - 1, entry, tag));
+    EXPECT_EQ(static_cast<uint64_t>(RING_TEST_ENTRIES - 1), tag);
+}
+
+// Requests sent all at once over the socket, results checked in the rings
+TEST(GBCServer, Protocol)
+{
+    for (const ROMUnitTest & rom : { getUnitTest(blargg::cpu_instrs::_01_special), getUnitTest(blargg::dmg_sound::_01_registers) })
+    {
+        SCOPED_TRACE(rom.rom_path.string());
+        const std::string rom_path = rom.rom_path.string();
+        const std::string name = getTestName("server");
+        const std::string socket_path = (std::filesystem::temp_directory_path() / (name + ".sock")).string();
+        GBCServer server(rom_path, socket_path, "/" + name);
+        std::thread server_thread([&]() { server.run(); });
+
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        ASSERT_EQ(0, connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)));
+
+        const std::string requests =
+            "step " + std::to_string(SERVER_TEST_FRAMES) + "\n"
+            "snapshot start\n"
+            "step 5 0xFE\n"
+            "step\n"
+            "step " + std::to_string(GBC_SERVER_MAX_STEP_FRAMES + 1) + "\n"
+            "restore start\n"
+            "restore missing\n"
+            "ram\n"
+            "quit\n";
+        ASSERT_EQ(static_cast<ssize_t>(requests.size()), send(fd, requests.data(), requests.size(), 0));
+
+        std::string replies;
+        char buffer[0x100];
+        ssize_t received;
+        while (std::count(replies.begin(), replies.end(), '\n') < 9 && (received = recv(fd, buffer, sizeof(buffer), 0)) > 0)
+        {
+            replies.append(buffer, received);
+        }
+        close(fd);
+        server_thread.join();
+
+        std::istringstream reply_lines(replies);
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(reply_lines, line);)
+        {
+            lines.push_back(line);
+        }
+        ASSERT_EQ(9, lines.size());
+        EXPECT_EQ("ok " + std::to_string(SERVER_TEST_FRAMES - 1) + " 0", lines[0]);
+        EXPECT_EQ(0, lines[1].find("ok "));
+        EXPECT_EQ("ok " + std::to_string(SERVER_TEST_FRAMES + 4) + " 1", lines[2]);
+        EXPECT_EQ(0, lines[3].find("error"));
+        EXPECT_EQ(0, lines[4].find("error"));   // Too many frames, none of them run
+        EXPECT_EQ("ok 2", lines[5]);
+        EXPECT_EQ(0, lines[6].find("error"));
+        EXPECT_EQ("ok 3", lines[7]);
+        EXPECT_EQ("ok", lines[8]);
+        EXPECT_EQ(INPUT_NO_BUTTONS, server.getEmulator()->get_Joypad()->getJoypadState());
+
+        SharedMemoryRingReader frames("/" + name + "-frames");
+        SharedMemoryRingReader ram("/" + name + "-ram");
+        SharedMemoryRingReader audio("/" + name + "-audio");
+        EXPECT_EQ(SERVER_TEST_FRAMES + 5, frames.getWriteSequence());
+        EXPECT_EQ(4u, ram.getWriteSequence());
+        EXPECT_GT(audio.getWriteSequence(), 0u);
+        EXPECT_EQ(static_cast<uint32_t>(server.getEmulator()->get_APU()->getSampleRate()), audio.getHeader().info[0]);
+
+        // Same as running the frames here
+        GBCEmulator emu(rom_path, rom_path + ".server.log", "", false, false, false, false);
+        emu.runWithoutSleep = true;
+        for (int i = 0; i < SERVER_TEST_FRAMES; i++)
+        {
+            emu.runFrame();
+        }
+        std::vector<uint8_t> entry, memory_map(GBC_SERVER_RAM_SIZE);
+        uint64_t tag;
+        emu.get_APU()->catchUp();
+        emu.peek(0x0000, memory_map.size(), memory_map.data());
+
+        ASSERT_TRUE(frames.read(SERVER_TEST_FRAMES - 1, entry, tag));
+        EXPECT_EQ(SERVER_TEST_FRAMES - 1, tag);
+        ASSERT_EQ(ENV_SCREEN_OBSERVATION_SIZE, entry.size());
+        EXPECT_EQ(0, std::memcmp(entry.data(), emu.getFrameRaw(), entry.size()));
+
+        // Restoring puts RAM back as it was at the snapshot
+        for (const uint64_t & ram_entry : { 0, 2, 3 })
+        {
+            ASSERT_TRUE(ram.read(ram_entry, entry, tag));
+            EXPECT_TRUE(entry == memory_map) << "RAM entry " << ram_entry;
+        }
+        ASSERT_TRUE(ram.read(1, entry, tag));
+        EXPECT_EQ(SERVER_TEST_FRAMES + 5, tag);
+        EXPECT_FALSE(ram.read(4, entry, tag));
+    }
+}
+#endif // _WIN32
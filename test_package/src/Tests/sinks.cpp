@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include <UnitTests.h>
+#include <GBCEmulator.h>
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define SINK_TEST_FRAMES 30
+
+// Frames, audio and buttons all go through the memory sinks
+TEST(Sinks, MemorySinks)
+{
+    for (const ROMUnitTest & rom : { getUnitTest(blargg::cpu_instrs::_04_op_r_imm), getUnitTest(blargg::dmg_sound::_01_registers) })
+    {
+        SCOPED_TRACE(rom.rom_path.string());
+        const std::string rom_path = rom.rom_path.string();
+        GBCEmulator emu(rom_path, rom_path + ".sinks.log", "", false, false, false, false);
+        emu.runWithoutSleep = true;
+
+        const uint8_t a_held = INPUT_NO_BUTTONS & ~Joypad::getButtonBit(Joypad::BUTTON::A);
+        auto frame_sink = std::make_shared<MemoryFrameSink>();
+        auto audio_sink = std::make_shared<MemoryAudioSink>();
+        auto input = std::make_shared<MemoryInputSource>(std::vector<uint8_t>{ a_held, INPUT_NO_BUTTONS });
+
+        emu.setFrameSink(frame_sink);
+        emu.setAudioSink(audio_sink);
+        emu.setInputSource(input);
+        EXPECT_EQ(audio_sink->getSampleRate(), emu.get_APU()->getSampleRate());
+
+        // First frame's buttons are held while it runs
+        while (frame_sink->getFrameCount() < 1)
+        {
+            emu.runNextInstruction();
+        }
+        EXPECT_EQ(a_held, emu.get_Joypad()->getJoypadState());
+
+        while (frame_sink->getFrameCount() < SINK_TEST_FRAMES)
+        {
+            emu.runNextInstruction();
+        }
+        EXPECT_EQ(INPUT_NO_BUTTONS, emu.get_Joypad()->getJoypadState());
+        EXPECT_EQ(0, input->getNumQueuedStates());
+
+        std::array<SDL_Color, SCREEN_PIXEL_TOTAL> frame;
+        EXPECT_EQ(SINK_TEST_FRAMES, frame_sink->getFrame(frame));
+        EXPECT_EQ(GBCEmulator::calculateFrameHash(emu.getFrame()), GBCEmulator::calculateFrameHash(frame));
+
+        // At least a frame's worth of samples each frame, there's more if the LCD was off for a while
+        std::vector<uint8_t> audio;
+        audio_sink->takeBytes(audio);
+        const double samples_per_frame = audio_sink->getSampleRate() / 59.73;
+        EXPECT_EQ(0, audio.size() % getAudioSampleSize(audio_sink->getFormat()));
+        EXPECT_GE(audio.size() / getAudioSampleSize(audio_sink->getFormat()),
+            (SINK_TEST_FRAMES - 2) * samples_per_frame);
+    }
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <WavWriter.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#define WAV_TEST_SAMPLE_RATE 44100
+#define WAV_TEST_CHANNELS 2
+#define WAV_TEST_FRAMES 1000        // Samples per channel
+
+namespace
+{
+    uint32_t getLE(const std::vector<uint8_t> & bytes, const size_t & pos, const size_t & num_bytes)
+    {
+        uint32_t value = 0;
+        for (size_t i = 0; i < num_bytes; i++)
+        {
+            value |= static_cast<uint32_t>(bytes[pos + i]) << (i * 8);
+        }
+        return value;
+    }
+
+    std::string getTag(const std::vector<uint8_t> & bytes, const size_t & pos)
+    {
+        return std::string(bytes.begin() + pos, bytes.begin() + pos + 4);
+    }
+
+    std::vector<uint8_t> readFile(const std::filesystem::path & path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+}
+
+// 32 bit float WAVE: RIFF, fmt with an empty extension, fact with the length in samples, then the data
+TEST(WavWriter, Header)
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "gbc-test-wav-writer.wav";
+    std::vector<float> samples(WAV_TEST_FRAMES * WAV_TEST_CHANNELS);
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        samples[i] = static_cast<float>(i % 200) / 100.0f - 1.0f;
+    }
+
+    WavWriter wav_writer;
+    ASSERT_TRUE(wav_writer.open(path, WAV_TEST_SAMPLE_RATE, WAV_TEST_CHANNELS));
+    EXPECT_TRUE(wav_writer.isOpen());
+    wav_writer.write(samples.data(), samples.size() / 2);
+    wav_writer.write(samples.data() + samples.size() / 2, samples.size() - samples.size() / 2);
+    wav_writer.close();
+    EXPECT_FALSE(wav_writer.isOpen());
+    EXPECT_FALSE(wav_writer.hasFailed());
+    EXPECT_EQ(0u, wav_writer.getQueueStats().overruns);
+
+    const std::vector<uint8_t> wav = readFile(path);
+    const uint32_t data_size = WAV_TEST_FRAMES * WAV_TEST_CHANNELS * sizeof(float);
+    ASSERT_EQ(58 + data_size, wav.size());
+
+    EXPECT_EQ("RIFF", getTag(wav, 0));
+    EXPECT_EQ(wav.size() - 8, getLE(wav, 4, 4));
+    EXPECT_EQ("WAVE", getTag(wav, 8));
+
+    EXPECT_EQ("fmt ", getTag(wav, 12));
+    EXPECT_EQ(18u, getLE(wav, 16, 4));
+    EXPECT_EQ(3u, getLE(wav, 20, 2));                               // IEEE float
+    EXPECT_EQ(static_cast<uint32_t>(WAV_TEST_CHANNELS), getLE(wav, 22, 2));
+    EXPECT_EQ(static_cast<uint32_t>(WAV_TEST_SAMPLE_RATE), getLE(wav, 24, 4));
+    EXPECT_EQ(WAV_TEST_SAMPLE_RATE * WAV_TEST_CHANNELS * sizeof(float), getLE(wav, 28, 4));
+    EXPECT_EQ(WAV_TEST_CHANNELS * sizeof(float), getLE(wav, 32, 2));
+    EXPECT_EQ(32u, getLE(wav, 34, 2));
+    EXPECT_EQ(0u, getLE(wav, 36, 2));
+
+    EXPECT_EQ("fact", getTag(wav, 38));
+    EXPECT_EQ(4u, getLE(wav, 42, 4));
+    EXPECT_EQ(static_cast<uint32_t>(WAV_TEST_FRAMES), getLE(wav, 46, 4));
+
+    EXPECT_EQ("data", getTag(wav, 50));
+    EXPECT_EQ(data_size, getLE(wav, 54, 4));
+    EXPECT_EQ(0, std::memcmp(&wav[58], samples.data(), data_size));
+
+    std::filesystem::remove(path);
+}
+
+// Closed straight away, still a valid file with no samples
+TEST(WavWriter, Empty)
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "gbc-test-wav-writer-empty.wav";
+    WavWriter wav_writer;
+    ASSERT_TRUE(wav_writer.open(path, WAV_TEST_SAMPLE_RATE, 1));
+    wav_writer.close();
+
+    const std::vector<uint8_t> wav = readFile(path);
+    ASSERT_EQ(58u, wav.size());
+    EXPECT_EQ(50u, getLE(wav, 4, 4));
+    EXPECT_EQ(0u, getLE(wav, 46, 4));
+    EXPECT_EQ(0u, getLE(wav, 54, 4));
+    std::filesystem::remove(path);
+
+    EXPECT_FALSE(wav_writer.open(std::filesystem::temp_directory_path() / "missing-dir" / "x.wav", WAV_TEST_SAMPLE_RATE, 1));
+}
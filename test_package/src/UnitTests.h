@@ -116,4 +116,16 @@ namespace blargg {
     };
 }
 
+// Test ROMs are copied next to the test executable
+std::filesystem::path getROMRoot();
+ROMUnitTest getUnitTest(blargg::cgb_sound test);
+ROMUnitTest getUnitTest(blargg::cpu_instrs test);
+ROMUnitTest getUnitTest(blargg::dmg_sound test);
+ROMUnitTest getUnitTest(blargg::instr_timing test);
+ROMUnitTest getUnitTest(blargg::interrupt_time test);
+ROMUnitTest getUnitTest(blargg::mem_timing test);
+ROMUnitTest getUnitTest(blargg::mem_timing_2 test);
+ROMUnitTest getUnitTest(blargg::oam_bug test);
+ROMUnitTest getUnitTest(blargg::halt_bug test);
+
 #endif // TEST_PACKAGE_SRC_UNIT_TESTS_H
\ No newline at end of file